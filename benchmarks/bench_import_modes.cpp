@@ -0,0 +1,199 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <cstdio>
+#include <zlib.h>
+#include "content_hash.h"
+#include "import_pipeline.h"
+#include "sqlite_text_handler.h"
+#include "zip_archive_reader.h"
+
+// 批量导入模式与普通模式的写入吞吐量：同一个合成ZIP分别
+//   1. 以批量模式导入新归档（DbImportWorker对新归档的做法）
+//   2. 以普通模式导入新归档
+//   3. 增量导入到已有归档（全部条目内容已变化：删除旧行后写入新行）
+// 输出写线程的行数/秒和原始字节MB/s，以及整个导入的墙钟时间
+// 用法：bench_import_modes [文件数，默认64] [每个文件MB，默认4]
+
+namespace {
+
+void AppendLe16(QByteArray& out, quint16 value) {
+    char bytes[2];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, 2);
+}
+
+void AppendLe32(QByteArray& out, quint32 value) {
+    char bytes[4];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, 4);
+}
+
+QByteArray MakeLogFile(QRandomGenerator& rng, qint64 bytes) {
+    static const char* const k_levels[] = { "INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR" };
+    QByteArray content;
+    content.reserve(bytes + 128);
+    qint64 ms = 0;
+    while (content.size() < bytes) {
+        ms += rng.bounded(40);
+        content += QString("[2024-06-01 %1:%2:%3.%4] %5 [motor] speed=%6 target=%7 current=%8mA\n")
+                       .arg(ms / 3600000 % 24, 2, 10, QChar('0'))
+                       .arg(ms / 60000 % 60, 2, 10, QChar('0'))
+                       .arg(ms / 1000 % 60, 2, 10, QChar('0'))
+                       .arg(ms % 1000, 3, 10, QChar('0'))
+                       .arg(k_levels[rng.bounded(6)])
+                       .arg(rng.bounded(10000))
+                       .arg(rng.bounded(10000))
+                       .arg(rng.bounded(5000))
+                       .toLatin1();
+    }
+    return content;
+}
+
+// 写出只含stored条目的ZIP，内容随seed变化（用于模拟同一归档的新版本）
+bool WriteZip(const QString& path, int file_count, qint64 file_bytes, quint32 seed, qint64* content_bytes) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QRandomGenerator rng(seed);
+    QByteArray central;
+    *content_bytes = 0;
+    for (int i = 0; i < file_count; ++i) {
+        const QByteArray name = QString("logs/motor_%1.log").arg(i, 4, 10, QChar('0')).toLatin1();
+        const QByteArray content = MakeLogFile(rng, file_bytes);
+        const quint32 crc = crc32(crc32(0, nullptr, 0), reinterpret_cast<const Bytef*>(content.constData()),
+                                  static_cast<uInt>(content.size()));
+        const quint32 offset = static_cast<quint32>(file.pos());
+
+        QByteArray header;
+        AppendLe32(header, 0x04034b50);
+        AppendLe16(header, 20);          // 解压所需版本
+        AppendLe16(header, 0);           // 标志
+        AppendLe16(header, 0);           // stored
+        AppendLe16(header, 0);           // 修改时间
+        AppendLe16(header, 0x5821);      // 修改日期 2024-01-01
+        AppendLe32(header, crc);
+        AppendLe32(header, static_cast<quint32>(content.size()));
+        AppendLe32(header, static_cast<quint32>(content.size()));
+        AppendLe16(header, static_cast<quint16>(name.size()));
+        AppendLe16(header, 0);
+        header += name;
+        if (file.write(header) != header.size() || file.write(content) != content.size()) {
+            return false;
+        }
+
+        AppendLe32(central, 0x02014b50);
+        AppendLe16(central, 20);         // 创建版本
+        AppendLe16(central, 20);
+        AppendLe16(central, 0);
+        AppendLe16(central, 0);
+        AppendLe16(central, 0);
+        AppendLe16(central, 0x5821);
+        AppendLe32(central, crc);
+        AppendLe32(central, static_cast<quint32>(content.size()));
+        AppendLe32(central, static_cast<quint32>(content.size()));
+        AppendLe16(central, static_cast<quint16>(name.size()));
+        AppendLe16(central, 0);          // 扩展字段长度
+        AppendLe16(central, 0);          // 注释长度
+        AppendLe16(central, 0);          // 磁盘号
+        AppendLe16(central, 0);          // 内部属性
+        AppendLe32(central, 0);          // 外部属性
+        AppendLe32(central, offset);
+        central += name;
+        *content_bytes += content.size();
+    }
+
+    QByteArray end;
+    AppendLe32(end, 0x06054b50);
+    AppendLe16(end, 0);
+    AppendLe16(end, 0);
+    AppendLe16(end, static_cast<quint16>(file_count));
+    AppendLe16(end, static_cast<quint16>(file_count));
+    AppendLe32(end, static_cast<quint32>(central.size()));
+    AppendLe32(end, static_cast<quint32>(file.pos()));
+    AppendLe16(end, 0);
+    return file.write(central) == central.size() && file.write(end) == end.size();
+}
+
+// 按DbImportWorker的流程导入一次；existing为已入库条目，非空时为增量导入
+bool Import(SqliteDbManager& manager, const QString& zip_path, int archive_id, bool bulk_load,
+            const QHash<QString, DbEntryState>& existing, const char* label) {
+    ZipArchiveReader reader(zip_path);
+    if (!reader.Open()) {
+        std::fprintf(stderr, "%s: %s\n", label, qPrintable(reader.ErrorString()));
+        return false;
+    }
+    const DbArchiveInfo archive = manager.GetArchive(archive_id);
+    ImportPipeline pipeline(archive.db_file, reader, "bench.zip");
+    pipeline.SetClassifier([](const QString& file_name) {
+        return file_name.endsWith(".log") ? QStringLiteral("motor") : QString();
+    });
+    pipeline.SetCategoryResolver([](const QString& keyword) { return keyword; });
+    pipeline.SetBulkLoad(bulk_load);
+    pipeline.SetExistingEntries(existing);
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = pipeline.Run();
+    const qint64 wall_ms = qMax<qint64>(1, timer.elapsed());
+    if (!ok) {
+        std::fprintf(stderr, "%s: %s\n", label, qPrintable(pipeline.ErrorString()));
+        return false;
+    }
+    manager.UpdateArchive(archive_id, XxHash64::ToHex(reader.DirectoryHash()), reader.ArchiveSize());
+
+    const double writer_seconds = qMax<qint64>(1, pipeline.WriterMilliseconds()) / 1000.0;
+    const double megabytes = pipeline.RawBytesWritten() / (1024.0 * 1024.0);
+    std::printf("%-34s %10lld rows %10.0f rows/s %8.1f MB/s  finish %6lld ms  wall %7lld ms (%.1f MB/s), removed %d\n",
+                label, static_cast<long long>(pipeline.RowsWritten()), pipeline.RowsWritten() / writer_seconds,
+                megabytes / writer_seconds, static_cast<long long>(pipeline.FinishMilliseconds()),
+                static_cast<long long>(wall_ms), megabytes / (wall_ms / 1000.0), pipeline.RemovedFileCount());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QLoggingCategory::setFilterRules("default.debug=false");
+    const QStringList args = app.arguments();
+    const int file_count = args.size() > 1 ? args[1].toInt() : 64;
+    const qint64 file_bytes = (args.size() > 2 ? args[2].toLongLong() : 4) * 1024 * 1024;
+
+    QTemporaryDir dir;
+    const QString zip_v1 = dir.filePath("bench_v1.zip");
+    const QString zip_v2 = dir.filePath("bench_v2.zip");
+    qint64 content_bytes = 0;
+    if (!dir.isValid() || !WriteZip(zip_v1, file_count, file_bytes, 1, &content_bytes) ||
+        !WriteZip(zip_v2, file_count, file_bytes, 2, &content_bytes)) {
+        std::fprintf(stderr, "cannot write synthetic zip\n");
+        return 1;
+    }
+    std::printf("%d files, %.1f MB per archive (stored)\n\n", file_count, content_bytes / (1024.0 * 1024.0));
+
+    SqliteDbManager manager;
+    if (!manager.InitializeDatabase(dir.filePath("bench.db"))) {
+        std::fprintf(stderr, "cannot initialize database\n");
+        return 1;
+    }
+
+    const int bulk_archive = manager.CreateArchive("bench_bulk.zip");
+    const int normal_archive = manager.CreateArchive("bench_normal.zip");
+    if (bulk_archive <= 0 || normal_archive <= 0 ||
+        !Import(manager, zip_v1, bulk_archive, true, {}, "new archive, bulk load") ||
+        !Import(manager, zip_v1, normal_archive, false, {}, "new archive, normal mode")) {
+        return 1;
+    }
+    const QHash<QString, DbEntryState> existing = manager.GetEntryStates(bulk_archive);
+    if (existing.size() != file_count ||
+        !Import(manager, zip_v2, bulk_archive, false, existing, "existing archive, all entries changed")) {
+        std::fprintf(stderr, "incremental import failed (%lld existing entries)\n", static_cast<long long>(existing.size()));
+        return 1;
+    }
+    return 0;
+}
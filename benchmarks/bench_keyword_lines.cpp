@@ -0,0 +1,249 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <cstdio>
+#include <optional>
+#include "sqlite_text_handler.h"
+#include "utf8_codec.h"
+
+// 关键字合并文本的随机行读取（日志查看器滚动时的典型调用）：
+//   1. 公共接口GetKeywordLines（读连接上缓存预编译语句）
+//   2. 在独立连接上执行同样的两条语句，每次调用重新prepare（引入CachedQuery之前的做法）
+//   3. 同上，但复用预编译语句，只重新绑定参数
+// 用法：bench_keyword_lines [文件数，默认40] [每个文件行数，默认10000] [调用次数，默认20000] [每次行数，默认60]
+
+namespace {
+
+// 与SqliteDbManager::GetKeywordLines/ReadFileLines相同的语句（单个归档，schema为main）
+const char* const k_keyword_files_sql = R"(
+    SELECT file_id, first_line, line_count FROM keyword_files
+    WHERE keyword = ?
+      AND first_line >= (SELECT MAX(first_line) FROM keyword_files WHERE keyword = ? AND first_line <= ?)
+      AND first_line < ?
+    ORDER BY seq
+)";
+const char* const k_file_chunks_sql = R"(
+    SELECT data, codec, first_line FROM file_chunks
+    WHERE file_id = ?
+      AND first_line >= (SELECT MAX(first_line) FROM file_chunks WHERE file_id = ? AND first_line <= ?)
+      AND first_line < ?
+    ORDER BY chunk_no
+)";
+
+class DirectLineReader {
+public:
+    DirectLineReader(const QSqlDatabase& database, bool reuse) : m_database_(database), m_reuse_(reuse) {}
+
+    QStringList Lines(const QString& keyword, qint64 first_line, int line_count) {
+        QStringList lines;
+        QSqlQuery& files = Statement(m_files_, k_keyword_files_sql);
+        Bind(files, { keyword, keyword, first_line, first_line + line_count });
+        if (!files.exec()) {
+            std::fprintf(stderr, "keyword_files: %s\n", qPrintable(files.lastError().text()));
+            return lines;
+        }
+        struct FileSpan { qint64 file_id; qint64 first_line; qint64 line_count; };
+        QList<FileSpan> spans;
+        while (files.next()) {
+            spans.append({ files.value(0).toLongLong(), files.value(1).toLongLong(), files.value(2).toLongLong() });
+        }
+        files.finish();
+
+        for (const FileSpan& span : spans) {
+            const qint64 wanted = first_line + lines.size();
+            if (span.line_count == 0 || wanted >= span.first_line + span.line_count) {
+                continue;
+            }
+            const qint64 offset = wanted - span.first_line;
+            const int count = static_cast<int>(qMin<qint64>(line_count - lines.size(), span.line_count - offset));
+            QStringList file_lines = Utf8Codec::Decode(FileLines(span.file_id, offset, count)).split('\n');
+            while (file_lines.size() > count) {
+                file_lines.removeLast();
+            }
+            lines += file_lines;
+            if (lines.size() >= line_count) {
+                break;
+            }
+        }
+        return lines;
+    }
+
+private:
+    QByteArray FileLines(qint64 file_id, qint64 first_line, int line_count) {
+        QSqlQuery& chunks = Statement(m_chunks_, k_file_chunks_sql);
+        Bind(chunks, { file_id, file_id, first_line, first_line + line_count });
+        if (!chunks.exec()) {
+            std::fprintf(stderr, "file_chunks: %s\n", qPrintable(chunks.lastError().text()));
+            return QByteArray();
+        }
+        QByteArray content;
+        qint64 content_first_line = -1;
+        while (chunks.next()) {
+            if (content_first_line < 0) {
+                content_first_line = chunks.value(2).toLongLong();
+            }
+            content += SqliteDbManager::DecompressChunk(chunks.value(0).toByteArray(), chunks.value(1).toInt());
+        }
+        chunks.finish();
+
+        qint64 start = 0;
+        for (qint64 line = content_first_line; line < first_line && start >= 0; ++line) {
+            start = content.indexOf('\n', start);
+            start = start >= 0 ? start + 1 : -1;
+        }
+        if (content_first_line < 0 || start < 0) {
+            return QByteArray();
+        }
+        qint64 end = start;
+        for (int i = 0; i < line_count && end >= 0; ++i) {
+            end = content.indexOf('\n', end);
+            end = end >= 0 ? end + 1 : -1;
+        }
+        return content.mid(start, (end < 0 ? content.size() : end) - start);
+    }
+
+    // 复用时只在第一次prepare；否则每次都新建语句并prepare
+    QSqlQuery& Statement(std::optional<QSqlQuery>& slot, const char* sql) {
+        if (!m_reuse_ || !slot) {
+            slot.emplace(m_database_);
+            slot->setForwardOnly(true);
+            slot->prepare(sql);
+        }
+        return *slot;
+    }
+
+    static void Bind(QSqlQuery& query, const QVariantList& values) {
+        for (int i = 0; i < values.size(); ++i) {
+            query.bindValue(i, values[i]);
+        }
+    }
+
+    QSqlDatabase m_database_;
+    bool m_reuse_;
+    std::optional<QSqlQuery> m_files_;
+    std::optional<QSqlQuery> m_chunks_;
+};
+
+QList<DbFileRecord> MakeFiles(int file_count, int lines_per_file) {
+    QRandomGenerator rng(7);
+    QList<DbFileRecord> records;
+    for (int f = 0; f < file_count; ++f) {
+        DbFileRecord record;
+        record.file_name = QString("motor_%1.log").arg(f, 4, 10, QChar('0'));
+        record.file_path = "logs/" + record.file_name;
+        record.keyword = "motor";
+        record.category = "motor";
+        record.zip_source = "bench.zip";
+        record.import_time = QDateTime::currentDateTime();
+        QString content;
+        for (int line = 0; line < lines_per_file; ++line) {
+            content += QString("[2024-06-01 12:%1:%2.%3] INFO [motor] speed=%4 target=%5 seq=%6\n")
+                           .arg(line / 60000 % 60, 2, 10, QChar('0'))
+                           .arg(line / 1000 % 60, 2, 10, QChar('0'))
+                           .arg(line % 1000, 3, 10, QChar('0'))
+                           .arg(rng.bounded(10000))
+                           .arg(rng.bounded(10000))
+                           .arg(line);
+        }
+        record.content = content;
+        record.file_size = content.toUtf8().size();
+        record.line_count = lines_per_file;
+        records.append(record);
+    }
+    return records;
+}
+
+// 用同一组随机起始行跑一遍，返回每次调用的平均微秒数
+template <typename Read>
+double Run(const QList<qint64>& starts, int line_count, Read read) {
+    qsizetype total_lines = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 start : starts) {
+        total_lines += read(start, line_count).size();
+    }
+    const double micros = timer.nsecsElapsed() / 1e3 / starts.size();
+    if (total_lines < static_cast<qsizetype>(starts.size()) * line_count / 2) {
+        std::fprintf(stderr, "warning: only %lld lines returned\n", static_cast<long long>(total_lines));
+    }
+    return micros;
+}
+
+void Report(const char* name, double micros, double baseline) {
+    std::printf("%-48s %9.1f us/call  %9.0f calls/s  x%.2f\n", name, micros, 1e6 / micros, baseline / micros);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QLoggingCategory::setFilterRules("default.debug=false");
+    const QStringList args = app.arguments();
+    const int file_count = args.size() > 1 ? args[1].toInt() : 40;
+    const int lines_per_file = args.size() > 2 ? args[2].toInt() : 10000;
+    const int calls = args.size() > 3 ? args[3].toInt() : 20000;
+    const int line_count = args.size() > 4 ? args[4].toInt() : 60;
+
+    QTemporaryDir dir;
+    SqliteDbManager manager;
+    if (!dir.isValid() || !manager.InitializeDatabase(dir.filePath("bench.db"))) {
+        std::fprintf(stderr, "cannot initialize database\n");
+        return 1;
+    }
+    const int archive_id = manager.CreateArchive("bench.zip");
+    if (archive_id <= 0 || !manager.InsertFiles(archive_id, MakeFiles(file_count, lines_per_file)) ||
+        !manager.UpdateArchive(archive_id, "bench", 0)) {
+        std::fprintf(stderr, "cannot import synthetic files\n");
+        return 1;
+    }
+    const QList<int> scope = { archive_id };
+    const qint64 total_lines = manager.GetKeywordLineCount("motor", scope);
+    std::printf("%d files x %d lines (%lld lines), %d calls x %d lines\n\n", file_count, lines_per_file,
+                static_cast<long long>(total_lines), calls, line_count);
+
+    QRandomGenerator rng(11);
+    QList<qint64> starts;
+    for (int i = 0; i < calls; ++i) {
+        starts.append(rng.bounded(qMax<qint64>(1, total_lines - line_count)));
+    }
+
+    // 独立的只读连接，与SqliteDbManager的读连接相同的打开方式
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "bench_direct_reader");
+    database.setDatabaseName(manager.GetArchive(archive_id).db_file);
+    database.setConnectOptions("QSQLITE_OPEN_READONLY");
+    if (!database.open()) {
+        std::fprintf(stderr, "cannot open archive: %s\n", qPrintable(database.lastError().text()));
+        return 1;
+    }
+
+    // 先读一遍，使各组都在页缓存已热的状态下计时
+    Run(starts, line_count, [&](qint64 start, int count) { return manager.GetKeywordLines("motor", start, count, scope); });
+
+    double prepare_each;
+    {
+        DirectLineReader reader(database, false);
+        prepare_each = Run(starts, line_count, [&](qint64 start, int count) { return reader.Lines("motor", start, count); });
+    }
+    double reused;
+    {
+        DirectLineReader reader(database, true);
+        reused = Run(starts, line_count, [&](qint64 start, int count) { return reader.Lines("motor", start, count); });
+    }
+    const double api = Run(starts, line_count, [&](qint64 start, int count) {
+        return manager.GetKeywordLines("motor", start, count, scope);
+    });
+
+    Report("direct, prepare on every call", prepare_each, prepare_each);
+    Report("direct, reused prepared statements", reused, prepare_each);
+    Report("SqliteDbManager::GetKeywordLines (CachedQuery)", api, prepare_each);
+
+    database.close();
+    database = QSqlDatabase();
+    QSqlDatabase::removeDatabase("bench_direct_reader");
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <QCoreApplication>
+#include <QByteArray>
+#include <QByteArrayMatcher>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QStringList>
+#include <cstdio>
+#include <functional>
+#include "text_matcher.h"
+#include "utf8_codec.h"
+
+// 搜索词匹配吞吐量：在合成日志上逐个取命中直到末尾，取多次中最快的一次，输出GB/s，
+// 以及相对于原搜索路径（解码后逐行匹配转义的不区分大小写QRegularExpression）的倍数
+// 用法：bench_text_matcher [数据量MB，默认256] [重复次数，默认5]
+
+namespace {
+
+QByteArray MakeLog(qsizetype bytes) {
+    static const char* const k_modules[] = { "motor", "navigation", "planner", "battery", "lidar", "can_bus" };
+    static const char* const k_levels[] = { "INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR" };
+    static const char* const k_messages[] = {
+        "speed=%1 target=%2 ok",
+        "status update seq=%1 latency=%2ms",
+        "path replanned, cost=%1 nodes=%2",
+        "voltage=%1mV current=%2mA",
+        "frame %1 dropped, queue=%2",
+        "request timeout after %1ms, retry %2",
+    };
+    QRandomGenerator rng(42);
+    QByteArray log;
+    log.reserve(bytes + 256);
+    qint64 ms = 0;
+    while (log.size() < bytes) {
+        ms += rng.bounded(50);
+        const int kind = rng.bounded(6);
+        log += QString("[2024-06-01 12:%1:%2.%3] %4 [%5] ")
+                   .arg(ms / 60000 % 60, 2, 10, QChar('0'))
+                   .arg(ms / 1000 % 60, 2, 10, QChar('0'))
+                   .arg(ms % 1000, 3, 10, QChar('0'))
+                   .arg(k_levels[rng.bounded(6)], k_modules[rng.bounded(6)])
+                   .toLatin1();
+        log += QString(k_messages[kind]).arg(rng.bounded(10000)).arg(rng.bounded(100)).toLatin1();
+        log += '\n';
+    }
+    return log;
+}
+
+// 返回最快一次的耗时（秒），hits为该次命中数
+double Measure(int repeats, const std::function<qsizetype()>& scan, qsizetype* hits) {
+    double best = 0;
+    for (int i = 0; i < repeats; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        *hits = scan();
+        const double seconds = timer.nsecsElapsed() / 1e9;
+        if (i == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+void Report(const char* name, qsizetype bytes, double seconds, qsizetype hits, double baseline_seconds) {
+    std::printf("%-44s %8.2f GB/s  x%7.1f  %10lld hits\n", name, bytes / seconds / 1e9, baseline_seconds / seconds,
+                static_cast<long long>(hits));
+}
+
+qsizetype CountHits(const TextMatcher& matcher, const QByteArray& data) {
+    qsizetype hits = 0;
+    for (TextMatcher::Match match = matcher.Find(data); match.offset >= 0;
+         match = matcher.Find(data, match.offset + qMax<qsizetype>(1, match.length))) {
+        ++hits;
+    }
+    return hits;
+}
+
+// 引入TextMatcher之前的搜索路径：内容解码为QString、按行拆分，每行用转义后的
+// 不区分大小写正则匹配；命中数为命中的行数
+qsizetype CountRegexLines(const QByteArray& data, const QString& search_text) {
+    const QRegularExpression search_regex(QRegularExpression::escape(search_text),
+                                          QRegularExpression::CaseInsensitiveOption);
+    const QStringList lines = Utf8Codec::Decode(data).split('\n');
+    qsizetype hits = 0;
+    for (const QString& line : lines) {
+        if (search_regex.match(line).hasMatch()) {
+            ++hits;
+        }
+    }
+    return hits;
+}
+
+void RunMatcher(const char* name, const QStringList& patterns, const TextMatcher::Options& options,
+                const QByteArray& data, int repeats, double baseline_seconds) {
+    auto matcher = TextMatcher::Create(patterns, options);
+    qsizetype hits = 0;
+    const double seconds = Measure(repeats, [&] { return CountHits(*matcher, data); }, &hits);
+    Report(name, data.size(), seconds, hits, baseline_seconds);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const qsizetype megabytes = args.size() > 1 ? args[1].toLongLong() : 256;
+    const int repeats = args.size() > 2 ? args[2].toInt() : 5;
+
+    const QByteArray data = MakeLog(megabytes * 1024 * 1024);
+    std::printf("data: %.1f MB, best of %d\n\n", data.size() / 1048576.0, repeats);
+
+    // 基线：原搜索路径，较慢，最多跑两次
+    qsizetype baseline_hits = 0;
+    const double baseline_seconds =
+        Measure(qMin(repeats, 2), [&] { return CountRegexLines(data, QStringLiteral("timeout")); }, &baseline_hits);
+    Report("old path: per-line escaped regex \"timeout\"", data.size(), baseline_seconds, baseline_hits,
+           baseline_seconds);
+
+    // 参照：Qt自带的逐字节查找
+    {
+        const QByteArrayMatcher matcher(QByteArrayLiteral("timeout"));
+        qsizetype hits = 0;
+        const double seconds = Measure(repeats, [&] {
+            qsizetype count = 0;
+            for (qsizetype pos = matcher.indexIn(data); pos >= 0; pos = matcher.indexIn(data, pos + 1)) {
+                ++count;
+            }
+            return count;
+        }, &hits);
+        Report("QByteArrayMatcher \"timeout\"", data.size(), seconds, hits, baseline_seconds);
+    }
+
+    TextMatcher::Options options;
+    options.case_sensitive = true;
+    RunMatcher("literal \"timeout\" case-sensitive", { "timeout" }, options, data, repeats, baseline_seconds);
+    RunMatcher("literal \"ERROR\" case-sensitive", { "ERROR" }, options, data, repeats, baseline_seconds);
+    options.case_sensitive = false;
+    RunMatcher("literal \"timeout\" case-insensitive", { "timeout" }, options, data, repeats, baseline_seconds);
+    RunMatcher("literal \"x\" case-insensitive", { "x" }, options, data, repeats, baseline_seconds);
+    options.whole_word = true;
+    RunMatcher("literal \"ok\" whole-word", { "ok" }, options, data, repeats, baseline_seconds);
+    options.whole_word = false;
+    RunMatcher("2 terms (Aho-Corasick)", { "timeout", "dropped" }, options, data, repeats, baseline_seconds);
+    RunMatcher("8 terms (Aho-Corasick)",
+               { "timeout", "dropped", "replanned", "voltage", "ERROR", "lidar", "retry", "queue=99" },
+               options, data, repeats, baseline_seconds);
+    options.whole_word = true;
+    RunMatcher("8 terms whole-word (Aho-Corasick)",
+               { "timeout", "dropped", "replanned", "voltage", "ERROR", "lidar", "retry", "queue" },
+               options, data, repeats, baseline_seconds);
+    options.whole_word = false;
+    options.regex = true;
+    RunMatcher("regex \"retry [0-9]+\"", { "retry [0-9]+" }, options, data, qMin(repeats, 2), baseline_seconds);
+    return 0;
+}
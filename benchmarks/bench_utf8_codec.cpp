@@ -0,0 +1,87 @@
+#include <QCoreApplication>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QStringConverter>
+#include <QTextStream>
+#include <cstdio>
+#include <functional>
+#include "utf8_codec.h"
+
+// UTF-8校验与解码吞吐量：Utf8Codec与原先逐文件使用的QTextStream(UTF-8) readAll对比，
+// 分别在纯ASCII日志和含少量中文行的日志上测量，取多次中最快的一次，输出GB/s
+// 用法：bench_utf8_codec [数据量MB，默认256] [重复次数，默认5]
+
+namespace {
+
+// non_ascii_every为0时为纯ASCII，否则每隔若干行插入一行中文
+QByteArray MakeLog(qsizetype bytes, int non_ascii_every) {
+    QRandomGenerator rng(3);
+    QByteArray log;
+    log.reserve(bytes + 256);
+    for (qint64 line = 0; log.size() < bytes; ++line) {
+        log += QString("[2024-06-01 12:00:%1.%2] INFO [motor] speed=%3 target=%4 status=ok\n")
+                   .arg(line / 1000 % 60, 2, 10, QChar('0'))
+                   .arg(line % 1000, 3, 10, QChar('0'))
+                   .arg(rng.bounded(10000))
+                   .arg(rng.bounded(10000))
+                   .toLatin1();
+        if (non_ascii_every > 0 && line % non_ascii_every == 0) {
+            log += QString::fromUtf8("[2024-06-01 12:00:00.000] WARN [导航] 路径规划超时，重试第%1次\n")
+                       .arg(rng.bounded(5))
+                       .toUtf8();
+        }
+    }
+    return log;
+}
+
+double Measure(int repeats, const std::function<qsizetype()>& run, qsizetype* result) {
+    double best = 0;
+    for (int i = 0; i < repeats; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        *result = run();
+        const double seconds = timer.nsecsElapsed() / 1e9;
+        if (i == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+void Run(const char* name, const QByteArray& data, int repeats, const std::function<qsizetype()>& run) {
+    qsizetype result = 0;
+    const double seconds = Measure(repeats, run, &result);
+    std::printf("  %-36s %8.2f GB/s  (%lld)\n", name, data.size() / seconds / 1e9, static_cast<long long>(result));
+}
+
+void RunAll(const char* title, const QByteArray& data, int repeats) {
+    std::printf("%s: %.1f MB\n", title, data.size() / 1048576.0);
+    Run("Utf8Codec::AsciiPrefixLength", data, repeats,
+        [&] { return Utf8Codec::AsciiPrefixLength(data.constData(), data.size()); });
+    Run("Utf8Codec::IsValid", data, repeats, [&] { return qsizetype(Utf8Codec::IsValid(data)); });
+    Run("Utf8Codec::Decode", data, repeats, [&] { return Utf8Codec::Decode(data).size(); });
+    Run("QString::fromUtf8", data, repeats, [&] { return QString::fromUtf8(data).size(); });
+    Run("QTextStream(UTF-8) readAll", data, repeats, [&] {
+        QBuffer buffer;
+        buffer.setData(data);
+        buffer.open(QIODevice::ReadOnly);
+        QTextStream stream(&buffer);
+        stream.setEncoding(QStringConverter::Utf8);
+        return stream.readAll().size();
+    });
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const qsizetype bytes = (args.size() > 1 ? args[1].toLongLong() : 256) * 1024 * 1024;
+    const int repeats = args.size() > 2 ? args[2].toInt() : 5;
+
+    RunAll("ASCII log", MakeLog(bytes, 0), repeats);
+    RunAll("log with one Chinese line per 50", MakeLog(bytes, 50), repeats);
+    return 0;
+}
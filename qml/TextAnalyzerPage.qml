@@ -8,15 +8,20 @@ Page {
     id: textAnalyzerPageRoot
 
     property string searchText: ""
-    property string fileContent: ""
     property bool isSearching: false
     property bool searchResultsReady: false // 标记搜索结果是否准备好
 
-    // 性能优化：缓存搜索结果
-    property var cachedSearchResults: []
+    // 搜索结果由C++模型在搜索过程中分批追加
+    readonly property var resultsModel: sqliteTextHandler.searchResultModel
     property string lastSearchText: ""
-    property string cachedHighlightedContent: "" // 缓存高亮的文本内容
-    property string formattedFileContent: "" // 新增：缓存格式化后的文件内容
+    // 搜索选项：区分大小写、整词匹配、正则表达式、多词（以;分隔，一次扫描查找全部）
+    property bool searchCaseSensitive: false
+    property bool searchWholeWord: false
+    property bool searchRegex: false
+    property bool searchMultiTerm: false
+    // 文本按行放在C++模型中，只为可见行创建委托，命中区间也只按可见行计算
+    readonly property var lineModel: sqliteTextHandler.textLineModel
+    property int textPixelSize: 14
     property string startTime: "" // 文本开始时间
     property string endTime: "" // 文本结束时间
 
@@ -332,14 +337,10 @@ Page {
                                 searchResultsReady = false
                             } else {
                                 searchTimer.stop()
-                                if (textDisplay.text !== formattedFileContent) {
-                                    textDisplay.text = formattedFileContent
-                                }
+                                lineModel.clearHighlight()
                                 resultsModel.clear()
                                 searchResultsReady = false
-                                cachedSearchResults = []
                                 lastSearchText = ""
-                                cachedHighlightedContent = ""
                                 extractTimeRange()
                             }
                         }
@@ -350,6 +351,32 @@ Page {
                         }
                     }
 
+                    // 搜索选项，切换后重新搜索
+                    Repeater {
+                        model: [
+                            { label: "Aa", tip: "区分大小写", option: "searchCaseSensitive" },
+                            { label: "ab", tip: "整词匹配", option: "searchWholeWord" },
+                            { label: ".*", tip: "正则表达式", option: "searchRegex" },
+                            { label: ";", tip: "多词搜索（以;分隔）", option: "searchMultiTerm" }
+                        ]
+                        delegate: ToolButton {
+                            text: modelData.label
+                            checkable: true
+                            checked: textAnalyzerPageRoot[modelData.option]
+                            font.pixelSize: 12
+                            Layout.preferredWidth: 28
+                            ToolTip.visible: hovered
+                            ToolTip.text: modelData.tip
+                            onToggled: {
+                                textAnalyzerPageRoot[modelData.option] = checked
+                                lastSearchText = ""
+                                if (searchText.length > 0) {
+                                    searchTimer.restart()
+                                }
+                            }
+                        }
+                    }
+
                     // 清除按钮
                     Button {
                         text: "✕"
@@ -441,9 +468,7 @@ Page {
 
                     ListView {
                         id: searchResults
-                        model: ListModel {
-                            id: resultsModel
-                        }
+                        model: resultsModel
 
                         // 启用缓存以提高性能
                         cacheBuffer: 1000
@@ -493,7 +518,7 @@ Page {
                                 anchors.margins: 10
 
                                 Text {
-                                    text: "第 " + (model.lineNumber || 0) + " 行"
+                                    text: "第 " + (model.lineNumber || 0) + " 行" + (model.term && searchMultiTerm ? "  ·  " + model.term : "")
                                     font.pixelSize: 12
                                     color: "#2563EB"
                                     font.bold: resultMouseArea.containsMouse
@@ -542,119 +567,95 @@ Page {
             anchors.bottom: parent.bottom
             color: "#FFFFFF"
 
-            // 鼠标滚轮缩放区域
+            // 鼠标滚轮缩放区域，放在列表之上，不按Ctrl时滚轮交给列表
             MouseArea {
                 anchors.fill: parent
+                z: 1
                 acceptedButtons: Qt.NoButton // 只处理滚轮事件
                 onWheel: (wheel) => {
                     if (wheel.modifiers & Qt.ControlModifier) {
                         var newSize;
                         if (wheel.angleDelta.y > 0) {
                             // 放大, 上限 40px
-                            newSize = Math.min(40, textDisplay.font.pixelSize + 1);
+                            newSize = Math.min(40, textPixelSize + 1);
                         } else {
                             // 缩小, 下限 8px
-                            newSize = Math.max(8, textDisplay.font.pixelSize - 1);
+                            newSize = Math.max(8, textPixelSize - 1);
                         }
 
-                        // 同步更新文本和行号的字体大小
-                        textDisplay.font.pixelSize = newSize;
-                        lineNumberArea.font.pixelSize = newSize;
+                        // 文本和行号共用同一字体大小
+                        textPixelSize = newSize;
 
                         wheel.accepted = true; // 消费事件，防止页面滚动
+                    } else {
+                        wheel.accepted = false;
                     }
                 }
             }
 
-            RowLayout {
+            // 文本内容显示区域：每行一个委托，行号与内容在同一行内，滚动天然同步
+            ListView {
+                id: textListView
                 anchors.fill: parent
                 anchors.margins: 20
-                spacing: 0
+                clip: true
+                model: lineModel
+                boundsBehavior: Flickable.StopAtBounds
+                flickableDirection: Flickable.HorizontalAndVerticalFlick
+                // 不换行，宽度取当前已创建委托中最宽的一行
+                contentWidth: Math.max(width, contentItem.childrenRect.width)
+                highlightMoveDuration: 0
+
+                ScrollBar.vertical: ScrollBar {
+                    id: mainScrollBar
+                    interactive: true
+                }
+                ScrollBar.horizontal: ScrollBar {
+                    policy: ScrollBar.AsNeeded
+                }
 
-                // 行号显示区域
-                ScrollView {
-                    id: lineNumberScrollView
-                    Layout.preferredWidth: 80
-                    Layout.fillHeight: true
-                    clip: true
-
-                    // 隐藏滚动条，只显示内容
-                    ScrollBar.vertical.policy: ScrollBar.AlwaysOff
-                    ScrollBar.horizontal.policy: ScrollBar.AlwaysOff
-
-                    // 添加拦截滚轮事件的 MouseArea
-                    MouseArea {
-                        anchors.fill: parent
-                        acceptedButtons: Qt.NoButton
-
-                        // 完全拦截滚轮事件
-                        onWheel: (wheel) => {
-                            wheel.accepted = true // 标记事件已处理，阻止传播
-                        }
-                    }
+                delegate: Rectangle {
+                    width: Math.max(textListView.width, lineRow.implicitWidth)
+                    height: lineRow.implicitHeight
+                    color: ListView.isCurrentItem && highlightTimer.targetLine === model.lineNumber
+                           ? "#FEF9C3" : "transparent"
 
-                    TextArea {
-                        id: lineNumberArea
-                        readOnly: true
-                        color: "#888888"
-                        font.pixelSize: 14
-                        font.family: "Consolas, Monaco, monospace"
-                        background: Rectangle { color: "#F8FAFC" }
-                        selectByMouse: false
-                        textFormat: Text.RichText // 使用富文本格式
-
-                        // 禁止鼠标交互
-                        // mouseSelectionMode: TextInput.NoSelection
-                        activeFocusOnPress: false
-
-                        // 禁用输入和编辑
-                        inputMethodHints: Qt.ImhNoPredictiveText
-
-                        MouseArea {
-                            anchors.fill: parent
-                            acceptedButtons: Qt.NoButton
-                            propagateComposedEvents: false
-                        }
-                    }
-                }
+                    Row {
+                        id: lineRow
+                        spacing: 0
 
-                // 文本内容显示区域
-                ScrollView {
-                    id: textScrollView
-                    Layout.fillWidth: true
-                    Layout.fillHeight: true
-                    clip: true
-
-                    // 明确指定滚动条在右侧
-                    ScrollBar.vertical: ScrollBar {
-                        id: mainScrollBar
-                        interactive: true
-                        anchors.right: parent.right // 将滚动条锚定在右侧
-                        anchors.top: parent.top
-                        anchors.bottom: parent.bottom
+                        // 行号
+                        Text {
+                            width: 80
+                            rightPadding: 12
+                            topPadding: 4
+                            bottomPadding: 4
+                            horizontalAlignment: Text.AlignRight
+                            text: model.lineNumber
+                            color: "#888888"
+                            font.pixelSize: textPixelSize
+                            font.family: "Consolas, Monaco, monospace"
+                        }
 
-                        // 当滚动条位置改变时，同步行号区域
-                        onPositionChanged: {
-                            lineNumberScrollView.ScrollBar.vertical.position = position
+                        // 内容，命中区间由视图在绘制该行时套用
+                        Text {
+                            topPadding: 4
+                            bottomPadding: 4
+                            textFormat: Text.StyledText
+                            text: textAnalyzerPageRoot.highlightLine(model.lineText, model.spans)
+                            color: "#1E293B"
+                            font.pixelSize: textPixelSize
+                            font.family: "Consolas, Monaco, monospace"
                         }
                     }
-                    ScrollBar.horizontal.policy: ScrollBar.AsNeeded
-
-                    TextArea {
-                        id: textDisplay
-                        readOnly: true
-                        selectByMouse: true
-                        wrapMode: TextArea.NoWrap
-                        font.family: "Consolas, Monaco, monospace"
-                        font.pixelSize: 14
-                        color: "#1E293B"
-                        textFormat: Text.RichText
-                        background: Rectangle { color: "transparent" }
 
-                        // 当文本变化时，更新行号
-                        onTextChanged: updateLineNumbers()
-
-                        property var searchResults: []
+                    Rectangle {
+                        anchors.left: parent.left
+                        anchors.right: parent.right
+                        anchors.bottom: parent.bottom
+                        anchors.leftMargin: 80
+                        height: 1
+                        color: "#F3F4F6"
                     }
                 }
             }
@@ -663,7 +664,7 @@ Page {
             Column {
                 anchors.centerIn: parent
                 spacing: 20
-                visible: fileContent.length === 0
+                visible: lineModel.count === 0
 
                 Text {
                     text: hasFileList ? "📂" : "📄"
@@ -710,9 +711,9 @@ Page {
                 text: {
                     if (hasFileList && currentFilePath.length > 0) {
                         var fileName = currentFilePath.split('/').pop()
-                        return "当前文件: " + fileName + " | 字符数: " + fileContent.length
-                    } else if (fileContent.length > 0) {
-                        return "文件已加载 | 字符数: " + fileContent.length
+                        return "当前文件: " + fileName + " | 行数: " + lineModel.count
+                    } else if (lineModel.count > 0) {
+                        return "文件已加载 | 行数: " + lineModel.count
                     } else {
                         return "就绪"
                     }
@@ -748,6 +749,14 @@ Page {
                 to: 100
                 value: 0
             }
+
+            // 取消后台导入
+            Button {
+                text: "取消"
+                Layout.alignment: Qt.AlignVCenter
+                visible: loadingIndicator.visible
+                onClicked: sqliteTextHandler.cancelFileLoading()
+            }
         }
     }
 
@@ -775,21 +784,19 @@ Page {
 
     // 高性能多线程搜索功能
     function performSearch() {
-        console.log("performSearch 被调用，搜索词:", searchText, "文件内容长度:", fileContent.length)
+        console.log("performSearch 被调用，搜索词:", searchText, "行数:", lineModel.count)
 
-        if (searchText.length === 0 || fileContent.length === 0) {
-            textDisplay.text = textAnalyzerPageRoot.formatForRichText(fileContent)
+        if (searchText.length === 0 || lineModel.count === 0) {
+            lineModel.clearHighlight()
             resultsModel.clear()
             searchResultsReady = false
-            updateLineNumbers()
             return
         }
 
-        // 检查缓存
-        if (searchText === lastSearchText && cachedSearchResults.length > 0) {
+        // 同一搜索词的结果和高亮仍在模型中，不必重新搜索
+        if (searchText === lastSearchText && resultsModel.count > 0) {
             console.log("使用缓存结果")
-            // 使用缓存结果
-            displayCachedResults()
+            searchResultsReady = true
             return
         }
 
@@ -809,136 +816,53 @@ Page {
         // 启动多线程搜索
         console.log("调用 fileHandler.startAsyncSearch")
         // fileHandler.startAsyncSearch(fileContent, searchText, 100) // 保留此行
-        sqliteTextHandler.startAsyncSearch("", searchText, 100)
-    }
-
-    // 显示缓存结果
-    function displayCachedResults() {
-        resultsModel.clear()
-
-        // 创建高亮正则表达式
-        var highlightRegex = new RegExp(searchText, 'gi');
-
-        for (var i = 0; i < cachedSearchResults.length; i++) {
-            var result = cachedSearchResults[i]
-
-            // 为预览文本添加高亮
-            var highlightedPreview = result.preview.replace(
-                        highlightRegex,
-                        '<span style="background-color: #DBEAFE; color: #1D4ED8; font-weight: bold;">$&</span>'
-                        );
-
-            resultsModel.append({
-                                    lineNumber: result.lineNumber,
-                                    preview: highlightedPreview
-                                })
+        var searchOptions = {
+            caseSensitive: searchCaseSensitive,
+            wholeWord: searchWholeWord,
+            regex: searchRegex
         }
-
-        // 使用缓存的高亮内容更新文本显示
-        if (cachedHighlightedContent.length > 0) {
-            textDisplay.text = cachedHighlightedContent
+        if (searchMultiTerm) {
+            var terms = searchText.split(";").map(function(term) { return term.trim() })
+                                             .filter(function(term) { return term.length > 0 })
+            sqliteTextHandler.startAsyncMultiSearch(terms, 100, searchOptions)
         } else {
-            // 如果没有缓存的高亮内容，重新生成高亮
-            var highlightRegex = new RegExp(searchText, 'gi');
-            var highlightedContent = textAnalyzerPageRoot.formatForRichText(fileContent, false);
-            highlightedContent = highlightedContent.replace(
-                        highlightRegex,
-                        '<span style="background-color: #DBEAFE; color: #1D4ED8; font-weight: bold;">$&</span>'
-                        );
-            textDisplay.text = highlightedContent;
+            sqliteTextHandler.startAsyncSearch("", searchText, 100, searchOptions)
         }
-
-        updateLineNumbers()
-        searchResultsReady = true
     }
 
+    // 跳转到指定行（从1开始），只需定位列表，目标行的委托按需创建
     function jumpToLine(lineNumber) {
-        if (lineNumber <= 0) {
-            return;
-        }
-
-        // 获取原始文件的行数
-        var originalLines = fileContent.split('\n');
-        var totalOriginalLines = originalLines.length;
-
-        if (lineNumber > totalOriginalLines) {
+        if (lineNumber <= 0 || lineNumber > lineModel.count) {
             return;
         }
 
-        console.log("跳转到行:", lineNumber, "总行数:", totalOriginalLines);
+        console.log("跳转到行:", lineNumber, "总行数:", lineModel.count);
+        textListView.currentIndex = lineNumber - 1;
+        textListView.positionViewAtIndex(lineNumber - 1, ListView.Center);
 
-        // 方法1：直接使用TextArea的positionAt方法（如果可用）
-        // 首先尝试使用更精确的方法
-        try {
-            // 计算目标行在显示文本中的大致位置
-            var displayLines = textDisplay.text.split('<br>');
-            var targetDisplayLine = Math.min(lineNumber - 1, displayLines.length - 1);
-
-            // 计算到目标行的字符数（在显示文本中）
-            var displayPosition = 0;
-            for (var i = 0; i < targetDisplayLine; i++) {
-                displayPosition += displayLines[i].length + 4; // +4 for '<br>'
-            }
-
-            console.log("显示文本中的位置:", displayPosition);
-
-            // 设置光标位置
-            textDisplay.cursorPosition = displayPosition;
-            textDisplay.forceActiveFocus();
-
-        } catch (e) {
-            console.log("使用备用方法:", e);
-            // 备用方法：使用原始文件内容计算
-            var targetPosition = 0;
-            for (var i = 0; i < lineNumber - 1 && i < originalLines.length; i++) {
-                targetPosition += originalLines[i].length + 1; // +1 for newline
-            }
-
-            // 由于显示文本可能包含HTML标签，我们需要调整位置
-            // 简单的调整：假设每行平均增加了一些HTML字符
-            var adjustedPosition = targetPosition * 1.1; // 增加10%的缓冲
-
-            textDisplay.cursorPosition = Math.min(adjustedPosition, textDisplay.text.length);
-            textDisplay.forceActiveFocus();
-        }
-
-        // 方法2：使用更精确的滚动条位置计算
-        var scrollRatio = totalOriginalLines > 1 ? (lineNumber - 1) / (totalOriginalLines - 1) : 0;
-
-        // 应用到滚动条
-        mainScrollBar.position = scrollRatio;
-        lineNumberScrollView.ScrollBar.vertical.position = scrollRatio;
-
-        console.log("滚动比例:", scrollRatio);
-
-        // 方法3：使用QML的内置方法确保文本可见
-        Qt.callLater(function() {
-            // 确保光标位置可见
-            textDisplay.ensureVisible(textDisplay.cursorPosition);
-
-            // 触发当前行高亮
-            highlightTimer.targetLine = lineNumber;
-            highlightTimer.restart();
+        // 触发当前行高亮
+        highlightTimer.targetLine = lineNumber;
+        highlightTimer.restart();
+    }
 
-            console.log("最终光标位置:", textDisplay.cursorPosition);
-        });
+    // 对单行套用命中区间（UTF-16下标，与JS字符串下标一致），生成该行的样式文本
+    function htmlEscape(text) {
+        return text.replace(/&/g, "&amp;").replace(/</g, "&lt;").replace(/>/g, "&gt;");
     }
 
-    function formatForRichText(plainText) {
-        if (!plainText) return "";
-        var lines = plainText.split('\n');
-        var richText = lines.map(function(line) {
-            var escapedLine = line.replace(/&/g, "&amp;")
-            .replace(/</g, "&lt;")
-            .replace(/>/g, "&gt;");
-            // 使用 &nbsp; 保证空行高度和边框可见
-            if (escapedLine.trim() === "") {
-                escapedLine = "&nbsp;";
-            }
-            // 使用 <p> 标签来设置行间距和底部分隔线
-            return '<p style="margin: 0; padding: 4px 0; line-height: 1.5; border-bottom: 1px solid #F3F4F6;">' + escapedLine + '</p>';
-        }).join('');
-        return richText;
+    function highlightLine(text, spans) {
+        if (!text) return "&nbsp;";
+        if (!spans || spans.length === 0) return htmlEscape(text);
+        var result = "";
+        var pos = 0;
+        for (var i = 0; i < spans.length; i++) {
+            var span = spans[i];
+            result += htmlEscape(text.substring(pos, span.start));
+            result += '<span style="background-color: #DBEAFE; color: #1D4ED8; font-weight: bold;">'
+                    + htmlEscape(text.substr(span.start, span.length)) + '</span>';
+            pos = span.start + span.length;
+        }
+        return result + htmlEscape(text.substring(pos));
     }
 
     // 错误对话框
@@ -1006,41 +930,32 @@ Page {
             errorDialog.open()
         }
 
+        // 后台导入完成/取消
+        function onImportFinished(fileCount, elapsedMs, failedEntries) {
+            loadingIndicator.visible = false
+            console.log("导入完成，文件数:", fileCount, "耗时:", elapsedMs, "ms", "解压失败条目:", failedEntries)
+            if (failedEntries > 0) {
+                errorDialog.errorText = "有 " + failedEntries + " 个条目解压失败，只导入了部分内容；重新导入该归档时会再次读取这些条目"
+                errorDialog.open()
+            }
+        }
+
+        function onImportCancelled() {
+            loadingIndicator.visible = false
+            console.log("导入已取消")
+        }
+
         // 多线程搜索信号处理
         function onSearchProgress(progress) {
             // 可以在这里显示搜索进度
             console.log("搜索进度:", progress + "%")
         }
 
-        function onSearchResultReady(results, highlightedContent) {
-            // 清空现有结果
-            resultsModel.clear()
-
-            // 添加新结果
-            for (var i = 0; i < results.length; i++) {
-                var result = results[i]
-                resultsModel.append({
-                lineNumber: result.lineNumber,
-                preview: result.preview
-                })
-            }
-
-            // 更新显示内容（搜索结果使用富文本）
-            textDisplay.textFormat = Text.RichText
-            textDisplay.text = highlightedContent
-            textDisplay.searchResults = results
-
-            // 缓存结果和高亮内容
-            cachedSearchResults = results
-            lastSearchText = searchText
-            cachedHighlightedContent = highlightedContent // 缓存高亮内容
-
-            updateLineNumbers()
-            searchResultsReady = true
-        }
-
+        // 结果列表已在搜索过程中逐批填入resultsModel，高亮由lineModel按可见行计算
         function onSearchFinished() {
             isSearching = false
+            lastSearchText = searchText
+            searchResultsReady = true
             console.log("搜索完成")
         }
 
@@ -1050,7 +965,7 @@ Page {
             console.log("搜索已取消")
             // 如果取消时搜索框为空，恢复原始内容
             if (searchInput.text.length === 0) {
-                textDisplay.text = formattedFileContent
+                lineModel.clearHighlight()
                 extractTimeRange() // 确保时间范围正确显示
             }
         }
@@ -1075,82 +990,25 @@ Page {
             }
         }
 
-        // function onFileContentReady(content, filePath) {
-        //     console.log("文件内容就绪:", filePath)
-        //     isLoadingFile = false
-        //     loadingIndicator.visible = false
-
-        //     if (content.length > 0) {
-        //         fileContent = content
-
-        //         // 先用纯文本快速显示，避免大文本富文本同步格式化卡主UI
-        //         // textDisplay.textFormat = Text.PlainText
-        //         // textDisplay.text = fileContent
-        //         // updateLineNumbers()
-        //         // extractTimeRange()
-
-        //         // 异步切换到富文本格式（不阻塞当前帧）
-        //         Qt.callLater(function() {
-        //             formattedFileContent = textAnalyzerPageRoot.formatForRichText(fileContent)
-        //             textDisplay.textFormat = Text.RichText
-        //             textDisplay.text = formattedFileContent
-        //             updateLineNumbers()
-        //             extractTimeRange()
-        //         })
-        //     } else {
-        //         fileContent = ""
-        //         formattedFileContent = ""
-        //         textDisplay.textFormat = Text.PlainText
-        //         textDisplay.text = "文件内容为空"
-        //         startTime = ""
-        //         endTime = ""
-        //     }
-        // }
-    }
-
-    // 更新行号的函数
-    function updateLineNumbers() {
-        var lineCount = textDisplay.lineCount
-        var numbers = ""
-        for (var i = 1; i <= lineCount; i++) {
-            // 使用与文本显示区域相同的样式格式
-            numbers += '<p style="margin: 0; padding: 4px 0; line-height: 1.5; border-bottom: 1px solid transparent; text-align: right;">' + i + '</p>'
+        // 内容已由C++填入lineModel，这里只更新页面状态，不把全文复制到QML
+        function onFileContentReady(filePath) {
+            console.log("文件内容就绪:", filePath)
+            isLoadingFile = false
+            loadingIndicator.visible = false
         }
-        lineNumberArea.text = numbers
     }
 
-    // 提取时间范围的函数
+    // 提取时间范围的函数（来自导入时建立的时间索引，不再拆分全文）
     function extractTimeRange() {
-        if (fileContent.length === 0) {
+        var range = currentFilePath.length > 0 ? sqliteTextHandler.getTimeRange(currentFilePath) : null
+        if (!range || !range.valid) {
             startTime = ""
             endTime = ""
             return
         }
 
-        var lines = fileContent.split('\n')
-        var timeRegex = /(\d{2}\/\d{2}\/\d{2}\s+\d{2}:\d{2}:\d{2}\.\d{3})/
-
-                // 提取开始时间（第一行）
-                for (var i = 0; i < lines.length; i++) {
-            var match = timeRegex.exec(lines[i])
-            if (match) {
-                startTime = match[1]
-                break
-            }
-        }
-
-        // 提取结束时间（最后一行，排除空行）
-        for (var j = lines.length - 1; j >= 0; j--) {
-            var line = lines[j].trim()
-            if (line.length > 0) {
-                var match = timeRegex.exec(line)
-                if (match) {
-                    endTime = match[1]
-                    break
-                }
-            }
-        }
-
+        startTime = range.start
+        endTime = range.end
         console.log("时间范围:", startTime, "至", endTime)
     }
 
@@ -1170,13 +1028,14 @@ Page {
         searchInput.text = ""
         resultsModel.clear()
         searchResultsReady = false
-        cachedSearchResults = []
         lastSearchText = ""
-        cachedHighlightedContent = ""
+        highlightTimer.targetLine = 0
 
         // 请求文件内容
         // fileHandler.requestFileContent(filePath) // 保留此行
         sqliteTextHandler.requestFileContent(filePath)
+        // 时间范围直接查索引，不依赖内容加载
+        extractTimeRange()
     }
 
     // 获取类别颜色
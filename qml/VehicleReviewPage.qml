@@ -281,7 +281,7 @@ VehicleReviewPage {
         target: typeof sqliteTextHandler !== 'undefined' ? sqliteTextHandler : null
         enabled: typeof sqliteTextHandler !== 'undefined'
         
-        function onFileLoaded(content) {
+        function onFileLoaded() {
             console.log("文件加载完成，开始加载地图")
             isFileLoading = true
             // 文件加载完成后，延迟加载地图以确保数据已写入数据库
@@ -298,6 +298,10 @@ VehicleReviewPage {
             errorDialog.errorText = errorMessage
             errorDialog.open()
         }
+        
+        function onImportCancelled() {
+            isFileLoading = false
+        }
     }
 
     Connections {
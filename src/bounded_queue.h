@@ -0,0 +1,92 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <deque>
+#include <utility>
+
+// 有界阻塞队列，用于导入流水线各阶段之间传递数据
+// 容量以"代价"计量（条目数或字节数均可），队列满时生产者阻塞，实现背压
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(qint64 capacity)
+        : m_capacity_(capacity > 0 ? capacity : 1), m_used_(0), m_closed_(false) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // 放入一项，队列已满时阻塞；队列已关闭时返回false
+    // 单项代价超过总容量时，在队列为空的情况下仍允许放入，避免死锁
+    bool Push(T item, qint64 cost = 1) {
+        QMutexLocker locker(&m_mutex_);
+        while (!m_closed_ && m_used_ > 0 && m_used_ + cost > m_capacity_) {
+            m_not_full_.wait(&m_mutex_);
+        }
+        if (m_closed_) {
+            return false;
+        }
+        m_items_.emplace_back(std::move(item), cost);
+        m_used_ += cost;
+        m_not_empty_.wakeOne();
+        return true;
+    }
+
+    // 取出一项，队列为空时阻塞；队列已关闭且取空时返回false
+    bool Pop(T& item) {
+        QMutexLocker locker(&m_mutex_);
+        while (m_items_.empty() && !m_closed_) {
+            m_not_empty_.wait(&m_mutex_);
+        }
+        if (m_items_.empty()) {
+            return false;
+        }
+        item = std::move(m_items_.front().first);
+        m_used_ -= m_items_.front().second;
+        m_items_.pop_front();
+        m_not_full_.wakeAll();
+        return true;
+    }
+
+    // 不再接受新数据，已有数据仍可被取出
+    void Close() {
+        QMutexLocker locker(&m_mutex_);
+        m_closed_ = true;
+        m_not_empty_.wakeAll();
+        m_not_full_.wakeAll();
+    }
+
+    // 关闭并丢弃所有未处理的数据（出错或取消时使用）
+    void Abort() {
+        QMutexLocker locker(&m_mutex_);
+        m_closed_ = true;
+        m_items_.clear();
+        m_used_ = 0;
+        m_not_empty_.wakeAll();
+        m_not_full_.wakeAll();
+    }
+
+    // 调整容量（通常在生产者启动前调用）
+    void SetCapacity(qint64 capacity) {
+        QMutexLocker locker(&m_mutex_);
+        m_capacity_ = capacity > 0 ? capacity : 1;
+        m_not_full_.wakeAll();
+    }
+
+    qint64 UsedCapacity() const {
+        QMutexLocker locker(&m_mutex_);
+        return m_used_;
+    }
+
+private:
+    mutable QMutex m_mutex_;
+    QWaitCondition m_not_full_;
+    QWaitCondition m_not_empty_;
+    std::deque<std::pair<T, qint64>> m_items_;
+    qint64 m_capacity_;
+    qint64 m_used_;
+    bool m_closed_;
+};
+
+#endif // BOUNDED_QUEUE_H
@@ -0,0 +1,146 @@
+#include "content_hash.h"
+#include <cstring>
+
+namespace {
+
+constexpr quint64 k_prime1 = 0x9E3779B185EBCA87ULL;
+constexpr quint64 k_prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr quint64 k_prime3 = 0x165667B19E3779F9ULL;
+constexpr quint64 k_prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr quint64 k_prime5 = 0x27D4EB2F165667C5ULL;
+
+inline quint64 RotateLeft(quint64 value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// 按小端读取，与参考实现在所有平台上结果一致
+inline quint64 ReadU64(const unsigned char* p) {
+    quint64 value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+inline quint32 ReadU32(const unsigned char* p) {
+    return static_cast<quint32>(p[0]) | (static_cast<quint32>(p[1]) << 8) |
+           (static_cast<quint32>(p[2]) << 16) | (static_cast<quint32>(p[3]) << 24);
+}
+
+inline quint64 Round(quint64 acc, quint64 input) {
+    acc += input * k_prime2;
+    acc = RotateLeft(acc, 31);
+    return acc * k_prime1;
+}
+
+inline quint64 MergeRound(quint64 acc, quint64 value) {
+    acc ^= Round(0, value);
+    return acc * k_prime1 + k_prime4;
+}
+
+} // namespace
+
+XxHash64::XxHash64(quint64 seed) {
+    Reset(seed);
+}
+
+void XxHash64::Reset(quint64 seed) {
+    m_seed_ = seed;
+    m_acc_[0] = seed + k_prime1 + k_prime2;
+    m_acc_[1] = seed + k_prime2;
+    m_acc_[2] = seed;
+    m_acc_[3] = seed - k_prime1;
+    m_total_length_ = 0;
+    m_buffer_size_ = 0;
+}
+
+void XxHash64::Update(const void* data, qint64 size) {
+    if (!data || size <= 0) {
+        return;
+    }
+
+    const auto* p = static_cast<const unsigned char*>(data);
+    const auto* end = p + size;
+    m_total_length_ += static_cast<quint64>(size);
+
+    // 先补齐上次剩余的不完整条带
+    if (m_buffer_size_ + size < 32) {
+        std::memcpy(m_buffer_ + m_buffer_size_, p, static_cast<size_t>(size));
+        m_buffer_size_ += static_cast<int>(size);
+        return;
+    }
+    if (m_buffer_size_ > 0) {
+        int fill = 32 - m_buffer_size_;
+        std::memcpy(m_buffer_ + m_buffer_size_, p, static_cast<size_t>(fill));
+        for (int i = 0; i < 4; ++i) {
+            m_acc_[i] = Round(m_acc_[i], ReadU64(m_buffer_ + i * 8));
+        }
+        p += fill;
+        m_buffer_size_ = 0;
+    }
+
+    // 每次处理32字节条带
+    while (end - p >= 32) {
+        m_acc_[0] = Round(m_acc_[0], ReadU64(p));
+        m_acc_[1] = Round(m_acc_[1], ReadU64(p + 8));
+        m_acc_[2] = Round(m_acc_[2], ReadU64(p + 16));
+        m_acc_[3] = Round(m_acc_[3], ReadU64(p + 24));
+        p += 32;
+    }
+
+    if (p < end) {
+        m_buffer_size_ = static_cast<int>(end - p);
+        std::memcpy(m_buffer_, p, static_cast<size_t>(m_buffer_size_));
+    }
+}
+
+quint64 XxHash64::Digest() const {
+    quint64 hash;
+    if (m_total_length_ >= 32) {
+        hash = RotateLeft(m_acc_[0], 1) + RotateLeft(m_acc_[1], 7) +
+               RotateLeft(m_acc_[2], 12) + RotateLeft(m_acc_[3], 18);
+        for (int i = 0; i < 4; ++i) {
+            hash = MergeRound(hash, m_acc_[i]);
+        }
+    } else {
+        hash = m_seed_ + k_prime5;
+    }
+    hash += m_total_length_;
+
+    // 处理剩余不足32字节的数据
+    const unsigned char* p = m_buffer_;
+    const unsigned char* end = m_buffer_ + m_buffer_size_;
+    while (end - p >= 8) {
+        hash ^= Round(0, ReadU64(p));
+        hash = RotateLeft(hash, 27) * k_prime1 + k_prime4;
+        p += 8;
+    }
+    if (end - p >= 4) {
+        hash ^= static_cast<quint64>(ReadU32(p)) * k_prime1;
+        hash = RotateLeft(hash, 23) * k_prime2 + k_prime3;
+        p += 4;
+    }
+    while (p < end) {
+        hash ^= (*p) * k_prime5;
+        hash = RotateLeft(hash, 11) * k_prime1;
+        ++p;
+    }
+
+    // 雪崩
+    hash ^= hash >> 33;
+    hash *= k_prime2;
+    hash ^= hash >> 29;
+    hash *= k_prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+quint64 XxHash64::Hash(const void* data, qint64 size, quint64 seed) {
+    XxHash64 hasher(seed);
+    hasher.Update(data, size);
+    return hasher.Digest();
+}
+
+QString XxHash64::ToHex(quint64 hash) {
+    return QString("%1").arg(hash, 16, 16, QChar('0'));
+}
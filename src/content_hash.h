@@ -0,0 +1,33 @@
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+
+// xxHash64（XXH64）实现，用于归档/条目指纹计算
+// 支持一次性计算和流式增量计算，结果与参考实现一致
+class XxHash64 {
+public:
+    explicit XxHash64(quint64 seed = 0);
+
+    void Reset(quint64 seed = 0);
+    void Update(const void* data, qint64 size);
+    void Update(const QByteArray& data) { Update(data.constData(), data.size()); }
+    quint64 Digest() const;
+
+    static quint64 Hash(const void* data, qint64 size, quint64 seed = 0);
+    static quint64 Hash(const QByteArray& data, quint64 seed = 0) { return Hash(data.constData(), data.size(), seed); }
+
+    // 16位十六进制字符串，便于存入数据库
+    static QString ToHex(quint64 hash);
+
+private:
+    quint64 m_seed_;
+    quint64 m_acc_[4];
+    quint64 m_total_length_;
+    unsigned char m_buffer_[32];
+    int m_buffer_size_;
+};
+
+#endif // CONTENT_HASH_H
@@ -0,0 +1,281 @@
+#include "file_classifier.h"
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+QMutex FileClassifier::s_current_mutex_;
+std::shared_ptr<const FileClassifier> FileClassifier::s_current_;
+
+namespace {
+
+bool AllDigits(const QString& text, qsizetype from) {
+    if (from >= text.size()) {
+        return false;
+    }
+    for (qsizetype i = from; i < text.size(); ++i) {
+        if (!text[i].isDigit()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FileClassifier::Rule MakeRule(const QString& keyword, const QString& category, FileClassifier::MatchKind match,
+                              const QStringList& patterns = QStringList(), bool enabled = true) {
+    FileClassifier::Rule rule;
+    rule.keyword = keyword;
+    rule.category = category;
+    rule.match = match;
+    rule.patterns = patterns.isEmpty() ? QStringList{keyword} : patterns;
+    rule.enabled = enabled;
+    return rule;
+}
+
+} // namespace
+
+FileClassifier::FileClassifier(const QList<Rule>& rules, const QString& default_category)
+    : m_rules_(rules)
+    , m_default_category_(default_category) {
+    m_name_trie_.append(Node());
+    m_contains_trie_.append(Node());
+
+    for (int i = 0; i < m_rules_.size(); ++i) {
+        const Rule& rule = m_rules_[i];
+        // 停用的规则不参与匹配，但类别仍然保留，已入库的文件能正常显示
+        if (!m_categories_.contains(rule.keyword)) {
+            m_categories_.insert(rule.keyword, rule.category);
+        }
+        if (!rule.enabled) {
+            continue;
+        }
+
+        for (const QString& raw_pattern : rule.patterns) {
+            const QString pattern = raw_pattern.toLower();
+            if (pattern.isEmpty()) {
+                continue;
+            }
+            switch (rule.match) {
+            case MatchKind::Name: {
+                Node& node = m_name_trie_[Insert(m_name_trie_, pattern)];
+                node.name_rule = KeepFirst(node.name_rule, i);
+                break;
+            }
+            case MatchKind::Numbered: {
+                Node& node = m_name_trie_[Insert(m_name_trie_, pattern)];
+                node.numbered_rule = KeepFirst(node.numbered_rule, i);
+                break;
+            }
+            case MatchKind::Extension:
+                if (!m_extension_rules_.contains(pattern)) {
+                    m_extension_rules_.insert(pattern, i);
+                }
+                break;
+            case MatchKind::Contains: {
+                Node& node = m_contains_trie_[Insert(m_contains_trie_, pattern)];
+                node.contains_rule = KeepFirst(node.contains_rule, i);
+                break;
+            }
+            }
+        }
+    }
+}
+
+int FileClassifier::Insert(QList<Node>& trie, const QString& pattern) {
+    int node = 0;
+    for (QChar ch : pattern) {
+        const char16_t c = ch.unicode();
+        QList<QPair<char16_t, int>>& edges = trie[node].edges;
+        auto it = std::lower_bound(edges.begin(), edges.end(), c,
+                                   [](const QPair<char16_t, int>& edge, char16_t value) { return edge.first < value; });
+        if (it != edges.end() && it->first == c) {
+            node = it->second;
+            continue;
+        }
+        int child = trie.size();
+        edges.insert(it, qMakePair(c, child));
+        trie.append(Node());
+        node = child;
+    }
+    return node;
+}
+
+int FileClassifier::Child(const QList<Node>& trie, int node, char16_t ch) {
+    // 每个节点的分支很少，线性查找比二分更快
+    for (const auto& edge : trie[node].edges) {
+        if (edge.first == ch) {
+            return edge.second;
+        }
+        if (edge.first > ch) {
+            break;
+        }
+    }
+    return -1;
+}
+
+int FileClassifier::KeepFirst(int current, int candidate) {
+    if (candidate < 0) {
+        return current;
+    }
+    return current < 0 ? candidate : qMin(current, candidate);
+}
+
+QString FileClassifier::Classify(const QString& file_name) const {
+    const QString name = file_name.toLower();
+    const qsizetype len = name.size();
+    int best = -1;
+
+    // 名称前缀：沿trie走一遍，在名称结尾或'.'处检查是否有规则结束
+    int node = 0;
+    for (qsizetype i = 0;; ++i) {
+        const Node& current = m_name_trie_[node];
+        if (current.name_rule >= 0 || current.numbered_rule >= 0) {
+            if (i == len) {
+                best = KeepFirst(best, current.name_rule);
+                best = KeepFirst(best, current.numbered_rule);
+            } else if (name[i] == QLatin1Char('.')) {
+                best = KeepFirst(best, current.name_rule);
+                if (current.numbered_rule >= 0 && AllDigits(name, i + 1)) {
+                    best = KeepFirst(best, current.numbered_rule);
+                }
+            }
+        }
+        if (i == len) {
+            break;
+        }
+        node = Child(m_name_trie_, node, name[i].unicode());
+        if (node < 0) {
+            break;
+        }
+    }
+
+    // 扩展名
+    if (!m_extension_rules_.isEmpty()) {
+        qsizetype dot = name.lastIndexOf(QLatin1Char('.'));
+        if (dot >= 0 && dot + 1 < len) {
+            auto it = m_extension_rules_.constFind(name.mid(dot + 1));
+            if (it != m_extension_rules_.constEnd()) {
+                best = KeepFirst(best, it.value());
+            }
+        }
+    }
+
+    // 包含：从每个位置出发沿trie匹配
+    if (m_contains_trie_.first().edges.size() > 0) {
+        for (qsizetype start = 0; start < len && best != 0; ++start) {
+            int cursor = 0;
+            for (qsizetype i = start; i < len; ++i) {
+                cursor = Child(m_contains_trie_, cursor, name[i].unicode());
+                if (cursor < 0) {
+                    break;
+                }
+                best = KeepFirst(best, m_contains_trie_[cursor].contains_rule);
+            }
+        }
+    }
+
+    return best >= 0 ? m_rules_[best].keyword : QString();
+}
+
+QString FileClassifier::Category(const QString& keyword) const {
+    return m_categories_.value(keyword, m_default_category_);
+}
+
+QList<FileClassifier::Rule> FileClassifier::DefaultRules() {
+    // 默认只启用当前导入的vehicle/map/version，其余规则保留在表中，可在配置中启用
+    QList<Rule> rules = {
+        MakeRule("master", "主控文件", MatchKind::Numbered, {}, false),
+        MakeRule("chassis", "底盘文件", MatchKind::Name, {}, false),
+        MakeRule("guidance", "引导文件", MatchKind::Name, {}, false),
+        MakeRule("sc2000a", "SC2000A文件", MatchKind::Name, {}, false),
+        MakeRule("vehicle", "车辆文件", MatchKind::Name),
+        MakeRule("vehicle_navigator", "车辆文件", MatchKind::Name, {}, false),
+        MakeRule("map", "其他文件", MatchKind::Name),
+        MakeRule("version", "版本文件", MatchKind::Name),
+    };
+
+    const QStringList text_extensions = {
+        "txt", "md", "csv", "json",
+        "xml", "ini", "cfg", "yml", "yaml",
+        "out", "err", "trace", "debug", "info"
+    };
+    for (const QString& extension : text_extensions) {
+        rules.append(MakeRule("extension_" + extension, "通用文本文件", MatchKind::Extension, {extension}, false));
+    }
+
+    const QStringList log_keywords = {
+        "trace", "debug", "error", "err", "out",
+        "audit", "access", "system", "application"
+    };
+    for (const QString& keyword : log_keywords) {
+        rules.append(MakeRule("log_" + keyword, "日志文件", MatchKind::Contains, {keyword}, false));
+    }
+    return rules;
+}
+
+std::shared_ptr<const FileClassifier> FileClassifier::FromJson(const QJsonObject& config) {
+    const QString default_category = config.value("default_category").toString(QStringLiteral("其他文件"));
+    if (!config.value("rules").isArray()) {
+        return std::make_shared<const FileClassifier>(DefaultRules(), default_category);
+    }
+
+    QList<Rule> rules;
+    for (const QJsonValue& value : config.value("rules").toArray()) {
+        const QJsonObject object = value.toObject();
+        Rule rule;
+        rule.keyword = object.value("keyword").toString().trimmed();
+        if (rule.keyword.isEmpty()) {
+            qWarning() << "文件分类规则缺少keyword，已忽略:" << object;
+            continue;
+        }
+        rule.category = object.value("category").toString(default_category);
+        rule.enabled = object.value("enabled").toBool(true);
+
+        const QString match = object.value("match").toString("name");
+        if (match == "name") {
+            rule.match = MatchKind::Name;
+        } else if (match == "numbered") {
+            rule.match = MatchKind::Numbered;
+        } else if (match == "extension") {
+            rule.match = MatchKind::Extension;
+        } else if (match == "contains") {
+            rule.match = MatchKind::Contains;
+        } else {
+            qWarning() << "未知的文件分类匹配方式，已忽略:" << rule.keyword << match;
+            continue;
+        }
+
+        for (const QJsonValue& pattern : object.value("patterns").toArray()) {
+            if (!pattern.toString().isEmpty()) {
+                rule.patterns.append(pattern.toString());
+            }
+        }
+        if (rule.patterns.isEmpty()) {
+            rule.patterns.append(rule.keyword);
+        }
+        rules.append(rule);
+    }
+    return std::make_shared<const FileClassifier>(rules, default_category);
+}
+
+std::shared_ptr<const FileClassifier> FileClassifier::Current() {
+    QMutexLocker locker(&s_current_mutex_);
+    if (!s_current_) {
+        s_current_ = std::make_shared<const FileClassifier>(DefaultRules());
+    }
+    return s_current_;
+}
+
+void FileClassifier::SetCurrent(std::shared_ptr<const FileClassifier> classifier) {
+    if (!classifier) {
+        return;
+    }
+    int enabled = 0;
+    for (const Rule& rule : classifier->Rules()) {
+        enabled += rule.enabled ? 1 : 0;
+    }
+
+    QMutexLocker locker(&s_current_mutex_);
+    s_current_ = std::move(classifier);
+    qDebug() << "文件分类规则已更新，启用规则数:" << enabled;
+}
@@ -0,0 +1,92 @@
+#ifndef FILE_CLASSIFIER_H
+#define FILE_CLASSIFIER_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <memory>
+
+// 文件分类规则引擎：按文件名确定关键字和类别
+// 规则表来自子进程配置的"file_classifier"节点（缺省时使用内置规则），加载时一次性编译：
+// 文件名前缀规则和包含规则各编译为一棵字典树，扩展名规则编译为哈希表，
+// 分类时按字符遍历一次文件名即可得到结果，不再为每个文件构造正则表达式。
+// 多条规则同时命中时取规则表中靠前的一条，与原先按列表顺序匹配的语义一致。
+//
+// 配置格式：
+// "file_classifier": {
+//     "default_category": "其他文件",
+//     "rules": [
+//         {"keyword": "master", "category": "主控文件", "match": "numbered"},
+//         {"keyword": "vehicle", "category": "车辆文件"},
+//         {"keyword": "extension_txt", "category": "通用文本文件", "match": "extension", "patterns": ["txt"]},
+//         {"keyword": "log_error", "category": "日志文件", "match": "contains", "patterns": ["error"], "enabled": false}
+//     ]
+// }
+// match取值：
+//   name      名称为pattern，或以"pattern."开头（轮转日志如vehicle.1），缺省值
+//   numbered  名称为pattern，或为"pattern.数字"
+//   extension 扩展名（最后一个'.'之后）等于pattern
+//   contains  名称包含pattern
+// patterns缺省为[keyword]；匹配不区分大小写。
+class FileClassifier {
+public:
+    enum class MatchKind {
+        Name,
+        Numbered,
+        Extension,
+        Contains
+    };
+
+    struct Rule {
+        QString keyword;
+        QString category;
+        MatchKind match = MatchKind::Name;
+        QStringList patterns;
+        bool enabled = true;
+    };
+
+    explicit FileClassifier(const QList<Rule>& rules, const QString& default_category = QStringLiteral("其他文件"));
+
+    // 返回关键字，未匹配时返回空字符串
+    QString Classify(const QString& file_name) const;
+    // 关键字对应的类别
+    QString Category(const QString& keyword) const;
+    const QList<Rule>& Rules() const { return m_rules_; }
+
+    // 内置规则表（与配置缺省时的行为一致）
+    static QList<Rule> DefaultRules();
+    // 从配置节点构造，格式错误的规则会被忽略
+    static std::shared_ptr<const FileClassifier> FromJson(const QJsonObject& config);
+
+    // 全局当前规则：导入线程取一份快照使用，配置热更新时整体替换，不影响进行中的导入
+    static std::shared_ptr<const FileClassifier> Current();
+    static void SetCurrent(std::shared_ptr<const FileClassifier> classifier);
+
+private:
+    struct Node {
+        QList<QPair<char16_t, int>> edges;   // 子节点（字符 -> 节点下标），按字符有序
+        int name_rule = -1;                  // 以该节点结尾的name规则
+        int numbered_rule = -1;              // 以该节点结尾的numbered规则
+        int contains_rule = -1;              // 以该节点结尾的contains规则
+    };
+
+    // 在trie中插入pattern，返回末端节点下标
+    static int Insert(QList<Node>& trie, const QString& pattern);
+    static int Child(const QList<Node>& trie, int node, char16_t ch);
+    static int KeepFirst(int current, int candidate);
+
+    QList<Rule> m_rules_;
+    QString m_default_category_;
+    QList<Node> m_name_trie_;
+    QList<Node> m_contains_trie_;
+    QHash<QString, int> m_extension_rules_;   // 扩展名 -> 规则下标
+    QHash<QString, QString> m_categories_;    // 关键字 -> 类别
+
+    static QMutex s_current_mutex_;
+    static std::shared_ptr<const FileClassifier> s_current_;
+};
+
+#endif // FILE_CLASSIFIER_H
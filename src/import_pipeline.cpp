@@ -0,0 +1,729 @@
+#include "import_pipeline.h"
+#include "content_hash.h"
+#include "utf8_codec.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QHash>
+#include <QDebug>
+#include <memory>
+
+namespace {
+
+int PipelineWorkerCount() {
+    return qMax(1, QThread::idealThreadCount());
+}
+
+QString BaseName(const QString& path) {
+    return path.mid(path.lastIndexOf('/') + 1);
+}
+
+} // namespace
+
+ImportPipeline::ImportPipeline(const QString& db_file, const ZipArchiveReader& reader, const QString& zip_source)
+    : m_db_file_(db_file)
+    , m_reader_(reader)
+    , m_zip_source_(zip_source)
+    , m_cancel_flag_(nullptr)
+    , m_unchanged_files_(0)
+    , m_prepared_(false)
+    , m_next_entry_(0)
+    , m_raw_queue_(1)
+    , m_decoded_queue_(1)
+    , m_memory_budget_(0)
+    , m_active_decompressors_(0)
+    , m_active_decoders_(0)
+    , m_worker_count_(PipelineWorkerCount())
+    , m_failed_(false)
+    , m_cancelled_(false)
+    , m_total_bytes_(0)
+    , m_imported_files_(0)
+    , m_failed_entries_(0)
+    , m_peak_queued_bytes_(0)
+    , m_bulk_load_(false)
+    , m_rows_written_(0)
+    , m_raw_bytes_written_(0)
+    , m_writer_ms_(0)
+    , m_finish_ms_(0) {
+    SetMemoryBudget(k_default_memory_budget_);
+}
+
+ImportPipeline::~ImportPipeline() {
+    m_raw_queue_.Abort();
+    m_decoded_queue_.Abort();
+    m_pool_.waitForDone();
+}
+
+void ImportPipeline::SetMemoryBudget(qint64 bytes) {
+    const qint64 chunk = SqliteDbManager::k_chunk_size_;
+
+    // 每个工作线程手上最多同时持有约两个块（待切分缓冲+正在处理的块及其副本），
+    // 写线程另持有一块；预算不足时减少工作线程，剩余部分平分给两个队列
+    int workers = PipelineWorkerCount();
+    auto in_flight = [chunk](int n) { return n * 2 * (2 * chunk) + 2 * chunk; };
+    while (workers > 1 && in_flight(workers) > bytes / 2) {
+        --workers;
+    }
+
+    m_memory_budget_ = bytes;
+    m_worker_count_ = workers;
+    qint64 queue_capacity = qMax(chunk, (bytes - in_flight(workers)) / 2);
+    m_raw_queue_.SetCapacity(queue_capacity);
+    m_decoded_queue_.SetCapacity(queue_capacity);
+
+    // 解压与解码工作线程各占一半，阻塞在队列上的线程不会饿死其他阶段
+    m_pool_.setMaxThreadCount(m_worker_count_ * 2);
+}
+
+QString ImportPipeline::ErrorString() const {
+    QMutexLocker locker(&m_error_mutex_);
+    return m_error_string_;
+}
+
+void ImportPipeline::Fail(const QString& error) {
+    {
+        QMutexLocker locker(&m_error_mutex_);
+        if (m_error_string_.isEmpty()) {
+            m_error_string_ = error;
+        }
+    }
+    m_failed_ = true;
+    m_raw_queue_.Abort();
+    m_decoded_queue_.Abort();
+}
+
+bool ImportPipeline::CheckCancelled() {
+    if (m_cancel_flag_ && m_cancel_flag_->load()) {
+        if (!m_cancelled_.exchange(true)) {
+            Fail("导入已取消");
+        }
+        return true;
+    }
+    return false;
+}
+
+void ImportPipeline::Prepare() {
+    m_work_items_.clear();
+    m_stale_file_ids_.clear();
+    m_unchanged_files_ = 0;
+    m_total_bytes_ = 0;
+
+    // 先按文件名筛选，只处理可识别的条目；指纹未变化的条目无需解压
+    QHash<QString, DbEntryState> remaining = m_existing_entries_;
+    for (const ZipEntryInfo& entry : m_reader_.Entries()) {
+        if (entry.is_directory) {
+            continue;
+        }
+
+        WorkItem item;
+        item.entry = &entry;
+        item.kind = NestedArchive::DetectKind(entry.name);
+        item.path = entry.name;
+        item.fingerprint = entry.Fingerprint();
+
+        if (item.kind == NestedArchive::Kind::None || item.kind == NestedArchive::Kind::Gzip) {
+            // 单个文件：解压前即可按（去掉.gz后的）文件名分类
+            if (item.kind == NestedArchive::Kind::Gzip) {
+                item.path = NestedArchive::GzipInnerName(entry.name);
+            }
+            item.keyword = m_classifier_(BaseName(item.path));
+            if (item.keyword.isEmpty()) {
+                continue;
+            }
+
+            auto existing = remaining.find(item.path);
+            if (existing != remaining.end()) {
+                bool unchanged = existing.value().entry_fingerprint == item.fingerprint;
+                if (!unchanged) {
+                    m_stale_file_ids_.append(existing.value().file_id);
+                }
+                remaining.erase(existing);
+                if (unchanged) {
+                    ++m_unchanged_files_;
+                    continue;
+                }
+            }
+        } else {
+            // 容器的成员只有展开后才知道，按容器整体比对：容器条目未变化则其成员都未变化
+            const QString prefix = entry.name + "/";
+            QList<qint64> member_ids;
+            bool unchanged = true;
+            for (auto it = remaining.begin(); it != remaining.end();) {
+                if (it.key().startsWith(prefix)) {
+                    member_ids.append(it.value().file_id);
+                    unchanged = unchanged && it.value().entry_fingerprint == item.fingerprint;
+                    it = remaining.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            if (!member_ids.isEmpty() && unchanged) {
+                m_unchanged_files_ += member_ids.size();
+                continue;
+            }
+            m_stale_file_ids_ += member_ids;
+        }
+
+        m_work_items_.append(item);
+        m_total_bytes_ += static_cast<qint64>(entry.uncompressed_size);
+    }
+
+    // 新归档中已不存在（或不再被识别）的旧条目
+    for (const DbEntryState& state : remaining) {
+        m_stale_file_ids_.append(state.file_id);
+    }
+    m_prepared_ = true;
+
+    qDebug() << "增量比对完成，待导入:" << m_work_items_.size() << "未变化:" << m_unchanged_files_
+             << "待删除:" << m_stale_file_ids_.size();
+}
+
+bool ImportPipeline::Run() {
+    if (!m_prepared_) {
+        Prepare();
+    }
+
+    qDebug() << "导入流水线启动，条目数:" << m_work_items_.size() << "工作线程:" << m_worker_count_
+             << "内存上限(MB):" << m_memory_budget_ / (1024 * 1024);
+    QElapsedTimer wall_timer;
+    wall_timer.start();
+
+    // 唯一的写线程
+    std::unique_ptr<QThread> writer(QThread::create([this]() { WriterLoop(); }));
+    writer->start();
+
+    int decompressors = qMin(m_worker_count_, static_cast<int>(m_work_items_.size()));
+    m_active_decompressors_ = decompressors;
+    if (decompressors == 0) {
+        // 只有删除或归档记录需要更新
+        m_raw_queue_.Close();
+    }
+    m_active_decoders_ = m_worker_count_;
+    for (int i = 0; i < decompressors; ++i) {
+        m_pool_.start([this]() { DecompressWorker(); });
+    }
+    for (int i = 0; i < m_worker_count_; ++i) {
+        m_pool_.start([this]() { DecodeWorker(); });
+    }
+
+    m_pool_.waitForDone();
+    writer->wait();
+
+    LogStageSummary(wall_timer.elapsed());
+    return !m_failed_;
+}
+
+void ImportPipeline::DecompressWorker() {
+    while (!m_failed_ && !CheckCancelled()) {
+        int index = m_next_entry_.fetch_add(1);
+        if (index >= m_work_items_.size()) {
+            break;
+        }
+
+        QString error;
+        if (!StreamEntry(index, &error) && !error.isEmpty()) {
+            // 单个条目损坏不影响其他条目。已写入的部分内容保留，
+            // 但写线程会清空这些文件的条目指纹，下次导入时按已变化的条目重新读取
+            MarkEntryFailed(index);
+            qWarning() << "解压条目失败:" << m_work_items_[index].entry->name << error;
+        }
+    }
+
+    if (m_active_decompressors_.fetch_sub(1) == 1) {
+        m_raw_queue_.Close();
+    }
+}
+
+// 一个入库文件的切块器：边接收解压数据边按换行边界切块、统计行数并计算内容哈希
+class ImportPipeline::FileEmitter : public ByteSink {
+public:
+    FileEmitter(ImportPipeline* pipeline, int file_slot, qint64* excluded_ns)
+        : m_pipeline_(pipeline), m_file_slot_(file_slot), m_excluded_ns_(excluded_ns)
+        , m_chunk_no_(0), m_next_line_(0), m_total_bytes_(0), m_finished_(false) {}
+
+    // 外层容器损坏导致成员未正常结束时补发最后一块，让写线程结束该文件
+    ~FileEmitter() override {
+        if (!m_finished_ && !m_pipeline_->m_failed_) {
+            Finish();
+        }
+    }
+
+    bool Write(const char* data, qint64 size) override {
+        const qint64 chunk_size = SqliteDbManager::k_chunk_size_;
+        m_hasher_.Update(data, size);
+        m_pending_.append(data, size);
+        m_total_bytes_ += size;
+        while (m_pending_.size() >= chunk_size) {
+            if (!EmitChunk(SqliteDbManager::FindChunkCut(m_pending_, chunk_size), false)) {
+                return Fail("导入已中止");
+            }
+        }
+        if (m_pipeline_->m_failed_ || m_pipeline_->CheckCancelled()) {
+            return Fail("导入已中止");
+        }
+        return true;
+    }
+
+    bool Finish() override {
+        if (m_finished_) {
+            return true;
+        }
+        m_finished_ = true;
+        return EmitChunk(m_pending_.size(), true) ? true : Fail("导入已中止");
+    }
+
+private:
+    // 从pending头部切出一块并送入下游，同时统计行数
+    bool EmitChunk(qint64 cut, bool last) {
+        QElapsedTimer index_timer;
+        index_timer.start();
+
+        ContentChunk chunk;
+        chunk.file_slot = m_file_slot_;
+        chunk.chunk_no = m_chunk_no_++;
+        chunk.first_line = m_next_line_;
+        chunk.data = m_pending_.left(cut);
+        m_pending_.remove(0, cut);
+
+        // 末尾无换行的最后一行也计入
+        int lines = chunk.data.count('\n');
+        if (last && !chunk.data.isEmpty() && !chunk.data.endsWith('\n')) {
+            ++lines;
+        }
+        chunk.line_count = lines;
+        m_next_line_ += lines;
+        chunk.is_last = last;
+        chunk.total_lines = m_next_line_;
+        if (last) {
+            chunk.content_hash = XxHash64::ToHex(m_hasher_.Digest());
+            chunk.total_bytes = m_total_bytes_;
+        }
+
+        qint64 index_ns = index_timer.nsecsElapsed();
+        m_pipeline_->m_index_counter_.Add(chunk.data.size(), index_ns);
+
+        bool pushed = m_pipeline_->PushChunk(std::move(chunk));
+        *m_excluded_ns_ += index_timer.nsecsElapsed();
+        return pushed;
+    }
+
+    ImportPipeline* m_pipeline_;
+    int m_file_slot_;
+    qint64* m_excluded_ns_;
+    QByteArray m_pending_;
+    int m_chunk_no_;
+    qint64 m_next_line_;
+    qint64 m_total_bytes_;
+    XxHash64 m_hasher_;
+    bool m_finished_;
+};
+
+// 容器成员的分类与登记：可识别的文件交给FileEmitter，嵌套容器继续展开
+class ImportPipeline::MemberFactory : public ArchiveMemberFactory {
+public:
+    MemberFactory(ImportPipeline* pipeline, int item_index, const QString& fingerprint, qint64* excluded_ns)
+        : m_pipeline_(pipeline), m_item_index_(item_index), m_fingerprint_(fingerprint), m_excluded_ns_(excluded_ns) {}
+
+    std::unique_ptr<ByteSink> OpenMember(const QString& path, qint64 size, int depth) override {
+        NestedArchive::Kind kind = NestedArchive::DetectKind(path);
+        if (kind != NestedArchive::Kind::None) {
+            return NestedArchive::CreateExpander(kind, path, this, depth + 1, m_pipeline_->NestedZipMemoryLimit());
+        }
+
+        FileSlot slot;
+        slot.keyword = m_pipeline_->m_classifier_(BaseName(path));
+        if (slot.keyword.isEmpty()) {
+            return nullptr;
+        }
+        slot.path = path;
+        slot.fingerprint = m_fingerprint_;
+        slot.item_index = m_item_index_;
+        slot.size = size;
+        return std::make_unique<FileEmitter>(m_pipeline_, m_pipeline_->RegisterFile(slot), m_excluded_ns_);
+    }
+
+private:
+    ImportPipeline* m_pipeline_;
+    int m_item_index_;
+    QString m_fingerprint_;
+    qint64* m_excluded_ns_;
+};
+
+int ImportPipeline::RegisterFile(const FileSlot& slot) {
+    QMutexLocker locker(&m_slot_mutex_);
+    m_file_slots_.append(slot);
+    return m_file_slots_.size() - 1;
+}
+
+void ImportPipeline::MarkEntryFailed(int item_index) {
+    QMutexLocker locker(&m_slot_mutex_);
+    m_failed_items_.insert(item_index);
+    m_failed_entries_ = m_failed_items_.size();
+}
+
+bool ImportPipeline::IsEntryFailed(int item_index) const {
+    QMutexLocker locker(&m_slot_mutex_);
+    return m_failed_items_.contains(item_index);
+}
+
+ImportPipeline::FileSlot ImportPipeline::FileSlotAt(int index) const {
+    QMutexLocker locker(&m_slot_mutex_);
+    return m_file_slots_.value(index);
+}
+
+int ImportPipeline::FileSlotCount() const {
+    QMutexLocker locker(&m_slot_mutex_);
+    return m_file_slots_.size();
+}
+
+bool ImportPipeline::StreamEntry(int item_index, QString* error) {
+    const WorkItem& item = m_work_items_[item_index];
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 excluded_ns = 0;   // 行索引与队列等待时间，不计入解压耗时
+
+    MemberFactory factory(this, item_index, item.fingerprint, &excluded_ns);
+    std::unique_ptr<ByteSink> sink;
+    if (item.kind == NestedArchive::Kind::None || item.kind == NestedArchive::Kind::Gzip) {
+        FileSlot slot;
+        slot.path = item.path;
+        slot.keyword = item.keyword;
+        slot.fingerprint = item.fingerprint;
+        slot.item_index = item_index;
+        slot.size = item.kind == NestedArchive::Kind::None ? static_cast<qint64>(item.entry->uncompressed_size) : -1;
+        sink = std::make_unique<FileEmitter>(this, RegisterFile(slot), &excluded_ns);
+        if (item.kind == NestedArchive::Kind::Gzip) {
+            sink = std::make_unique<GzipDecodeSink>(std::move(sink));
+        }
+    } else {
+        sink = NestedArchive::CreateExpander(item.kind, item.path, &factory, 1, NestedZipMemoryLimit());
+        if (!sink) {
+            return true;
+        }
+    }
+
+    bool ok = m_reader_.ReadEntry(*item.entry, [&](const char* data, qint64 size) {
+        return sink->Write(data, size);
+    }, error);
+
+    if (m_failed_) {
+        return false;
+    }
+    if (!ok && error && !sink->ErrorString().isEmpty()) {
+        *error = sink->ErrorString();
+    }
+
+    m_decompress_counter_.Add(static_cast<qint64>(item.entry->uncompressed_size),
+                              qMax<qint64>(0, timer.nsecsElapsed() - excluded_ns));
+
+    // 出错时也要结束已开始的文件，让写线程完成这些文件的记录
+    bool finished = sink->Finish();
+    if (!finished && ok && error) {
+        *error = sink->ErrorString();
+    }
+    sink.reset();
+    return ok && finished;
+}
+
+bool ImportPipeline::PushChunk(ContentChunk&& chunk) {
+    qint64 cost = qMax<qint64>(1, chunk.data.size());
+    if (!m_raw_queue_.Push(std::move(chunk), cost)) {
+        return false;
+    }
+
+    // 记录队列占用峰值，用于验证内存上限
+    qint64 queued = m_raw_queue_.UsedCapacity() + m_decoded_queue_.UsedCapacity();
+    qint64 peak = m_peak_queued_bytes_.load();
+    while (queued > peak && !m_peak_queued_bytes_.compare_exchange_weak(peak, queued)) {
+    }
+    return true;
+}
+
+void ImportPipeline::DecodeWorker() {
+    ContentChunk chunk;
+    while (!m_failed_ && !CheckCancelled() && m_raw_queue_.Pop(chunk)) {
+        QElapsedTimer timer;
+        timer.start();
+
+        // 与原先文本模式读取保持一致：统一换行符（没有\r时跳过替换）
+        if (chunk.data.contains('\r')) {
+            chunk.data.replace("\r\n", "\n");
+        }
+
+        // 数据以UTF-8字节入库；非法序列在导入时一次性替换为U+FFFD，读取端可直接解码
+        chunk.data = Utf8Codec::Sanitize(chunk.data);
+
+        // 行时间戳、级别统计与压缩一样在工作线程上完成
+        chunk.times = LineTimeIndex::Build(chunk.data);
+        chunk.severity = LogSeverity::Count(chunk.data);
+
+        // 压缩与解码一起在工作线程上并行完成，写线程只负责写入
+        chunk.raw_size = chunk.data.size();
+        chunk.text = chunk.data;
+        chunk.data = SqliteDbManager::CompressChunk(chunk.data, &chunk.codec);
+        m_decode_counter_.Add(chunk.raw_size, timer.nsecsElapsed());
+
+        // 写入前同时持有原文和压缩数据，两者都计入内存上限
+        qint64 cost = qMax<qint64>(1, chunk.data.size() + chunk.text.size());
+        if (!m_decoded_queue_.Push(std::move(chunk), cost)) {
+            break;
+        }
+    }
+
+    if (m_active_decoders_.fetch_sub(1) == 1) {
+        m_decoded_queue_.Close();
+    }
+}
+
+void ImportPipeline::WriterLoop() {
+    QElapsedTimer writer_timer;
+    writer_timer.start();
+    {
+        QSqlDatabase db = SqliteDbManager::OpenArchiveConnection(m_db_file_, k_writer_connection_name_);
+        if (!db.isOpen()) {
+            Fail("无法打开导入写连接");
+        } else if (!db.transaction()) {
+            Fail(QString("开始导入事务失败：%1").arg(db.lastError().text()));
+        } else if (!SqliteDbManager::DeleteFilesByIds(db, m_stale_file_ids_)) {
+            Fail("删除已变化的旧条目失败");
+            db.rollback();
+        } else {
+            const bool index_lines = SqliteDbManager::HasLineFts(db);
+            if (m_bulk_load_ && !BeginBulkLoad(db, index_lines)) {
+                Fail("进入批量导入模式失败");
+            }
+            QSqlQuery file_query(db);
+            file_query.prepare(QString(SqliteDbManager::k_insert_file_sql_).arg("main"));
+            QSqlQuery chunk_query(db);
+            chunk_query.prepare(QString(SqliteDbManager::k_insert_chunk_sql_).arg("main"));
+            QSqlQuery times_query(db);
+            times_query.prepare(QString(SqliteDbManager::k_insert_line_times_sql_).arg("main"));
+            QSqlQuery fts_query(db);
+            if (index_lines) {
+                fts_query.prepare(QString(SqliteDbManager::k_insert_line_fts_sql_).arg("main"));
+            }
+            QSqlQuery finish_query(db);
+            finish_query.prepare("UPDATE files SET line_count = ?, content_hash = ?, file_size = ? WHERE id = ?");
+
+            // 写入中的文件：文件槽下标 -> files.id与路径
+            struct WritingFile {
+                qint64 file_id = 0;
+                QString path;
+                QString keyword;
+                LogSeverity::Counts severity;   // 各块乱序到达，在此累加，全部写完后更新
+            };
+            qint64 bytes_written = 0;
+            QHash<int, WritingFile> files;
+            ContentChunk chunk;
+            while (!m_failed_ && m_decoded_queue_.Pop(chunk)) {
+                if (CheckCancelled()) {
+                    break;
+                }
+
+                QElapsedTimer timer;
+                timer.start();
+
+                auto it = files.find(chunk.file_slot);
+                if (it == files.end()) {
+                    // 该文件的第一块：先写入文件元数据，行数和大小在最后一块到达时更新
+                    const FileSlot slot = FileSlotAt(chunk.file_slot);
+                    DbFileRecord record;
+                    record.file_path = slot.path;
+                    record.file_name = BaseName(slot.path);
+                    record.keyword = slot.keyword;
+                    record.category = m_category_resolver_(record.keyword);
+                    record.file_size = qMax<qint64>(0, slot.size);
+                    record.zip_source = m_zip_source_;
+                    record.import_time = QDateTime::currentDateTime();
+                    record.entry_fingerprint = slot.fingerprint;
+
+                    if (!SqliteDbManager::BindAndInsertFile(file_query, record)) {
+                        Fail(QString("写入文件记录失败：%1").arg(file_query.lastError().text()));
+                        break;
+                    }
+                    WritingFile writing;
+                    writing.file_id = file_query.lastInsertId().toLongLong();
+                    writing.path = slot.path;
+                    writing.keyword = slot.keyword;
+                    it = files.insert(chunk.file_slot, writing);
+                    ++m_rows_written_;
+                }
+
+                if (chunk.raw_size > 0 &&
+                    !SqliteDbManager::BindAndInsertChunk(chunk_query, it->file_id, chunk.chunk_no, chunk.first_line,
+                                                         chunk.line_count, chunk.data, chunk.codec, chunk.raw_size)) {
+                    Fail(QString("写入内容块失败：%1").arg(chunk_query.lastError().text()));
+                    break;
+                }
+                if (!SqliteDbManager::BindAndInsertLineTimes(times_query, it->file_id, chunk.chunk_no, chunk.first_line,
+                                                             chunk.times)) {
+                    Fail(QString("写入时间索引失败：%1").arg(times_query.lastError().text()));
+                    break;
+                }
+                if (index_lines && !SqliteDbManager::IndexChunkLines(fts_query, it->file_id, chunk.first_line, chunk.text)) {
+                    Fail(QString("写入全文索引失败：%1").arg(fts_query.lastError().text()));
+                    break;
+                }
+
+                m_rows_written_ += (chunk.raw_size > 0 ? 1 : 0) + (chunk.times.count > 0 ? 1 : 0) +
+                                   (index_lines ? chunk.line_count : 0);
+                it->severity += chunk.severity;
+
+                if (chunk.is_last) {
+                    finish_query.addBindValue(chunk.total_lines);
+                    finish_query.addBindValue(chunk.content_hash);
+                    finish_query.addBindValue(chunk.total_bytes);
+                    finish_query.addBindValue(it->file_id);
+                    if (!finish_query.exec()) {
+                        Fail(QString("更新文件行数失败：%1").arg(finish_query.lastError().text()));
+                        break;
+                    }
+                }
+
+                // 写入计数按落盘（压缩后）字节统计，进度按原始字节计算
+                m_write_counter_.Add(chunk.data.size(), timer.nsecsElapsed());
+                bytes_written += chunk.raw_size;
+                m_raw_bytes_written_ = bytes_written;
+
+                int done = chunk.is_last ? m_imported_files_.fetch_add(1) + 1 : m_imported_files_.load();
+                if (m_progress_handler_) {
+                    // 容器展开出的文件数在解压前未知，总数随登记的文件增长
+                    int total = qMax(static_cast<int>(m_work_items_.size()), FileSlotCount());
+                    m_progress_handler_(it->path, done, total, bytes_written, m_total_bytes_);
+                }
+                if (chunk.is_last) {
+                    qDebug() << "添加文件记录:" << it->path << "关键字:" << it->keyword << "行数:" << chunk.total_lines;
+                }
+                chunk.data.clear();
+                chunk.text.clear();
+            }
+
+            // 级别统计在所有块写完后更新，keyword_stats随后由RebuildKeywordIndex汇总
+            QSqlQuery severity_query(db);
+            severity_query.prepare("UPDATE files SET error_count = ?, warning_count = ? WHERE id = ?");
+            for (auto file = files.cbegin(); !m_failed_ && file != files.cend(); ++file) {
+                severity_query.addBindValue(file->severity.errors);
+                severity_query.addBindValue(file->severity.warnings);
+                severity_query.addBindValue(file->file_id);
+                if (!severity_query.exec()) {
+                    Fail(QString("更新级别统计失败：%1").arg(severity_query.lastError().text()));
+                }
+            }
+
+            // 解压出错的条目只写入了部分内容：清空其文件的条目指纹，下次导入时不会被当作未变化而跳过。
+            // 写队列关闭时所有解压线程都已结束，失败的条目已全部登记
+            QSqlQuery failed_query(db);
+            failed_query.prepare("UPDATE files SET entry_fingerprint = '' WHERE id = ?");
+            for (auto file = files.cbegin(); !m_failed_ && file != files.cend(); ++file) {
+                if (!IsEntryFailed(FileSlotAt(file.key()).item_index)) {
+                    continue;
+                }
+                failed_query.addBindValue(file->file_id);
+                if (!failed_query.exec()) {
+                    Fail(QString("标记不完整条目失败：%1").arg(failed_query.lastError().text()));
+                }
+            }
+
+            file_query.finish();
+            chunk_query.finish();
+            finish_query.finish();
+            severity_query.finish();
+            failed_query.finish();
+            QElapsedTimer finish_timer;
+            finish_timer.start();
+            if (!m_failed_ && !SqliteDbManager::RebuildKeywordIndex(db)) {
+                Fail("重建关键字行索引失败");
+            }
+            // keyword_files在重建之后再建索引，避免逐行维护
+            if (!m_failed_ && m_bulk_load_ && !FinishBulkLoad(db, index_lines)) {
+                Fail("批量导入重建索引失败");
+            }
+            if (m_failed_) {
+                db.rollback();
+            } else if (!db.commit()) {
+                Fail(QString("提交导入事务失败：%1").arg(db.lastError().text()));
+                db.rollback();
+            } else if (m_bulk_load_) {
+                // 整个归档都在WAL中，提交后立即写回主文件并截断，避免大WAL拖慢之后的读取
+                QSqlQuery checkpoint(db);
+                if (!checkpoint.exec("PRAGMA wal_checkpoint(TRUNCATE)")) {
+                    qWarning() << "WAL检查点失败：" << checkpoint.lastError().text();
+                }
+            }
+            m_finish_ms_ = finish_timer.elapsed();
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(k_writer_connection_name_);
+    m_writer_ms_ = writer_timer.elapsed();
+}
+
+bool ImportPipeline::BeginBulkLoad(QSqlDatabase& db, bool index_lines) {
+    QSqlQuery query(db);
+    // 页缓存放大到内存上限的1/4（负数单位为KiB），事务内的页尽量留在内存中，
+    // 末尾建索引的排序也少落临时文件
+    query.exec(QString("PRAGMA cache_size = %1").arg(-qMax<qint64>(8 * 1024, m_memory_budget_ / 4 / 1024)));
+    if (!SqliteDbManager::DropSecondaryIndexes(db)) {
+        return false;
+    }
+    // 暂停增量合并，写入期间只追加段，结束时一次性合并
+    if (index_lines && !query.exec("INSERT INTO line_fts (line_fts, rank) VALUES ('automerge', 0)")) {
+        qCritical() << "暂停全文索引合并失败：" << query.lastError().text();
+        return false;
+    }
+    qDebug() << "批量导入模式：已删除二级索引，全文索引合并延后";
+    return true;
+}
+
+bool ImportPipeline::FinishBulkLoad(QSqlDatabase& db, bool index_lines) {
+    if (!SqliteDbManager::CreateSecondaryIndexes(db)) {
+        return false;
+    }
+    if (index_lines) {
+        QElapsedTimer timer;
+        timer.start();
+        QSqlQuery query(db);
+        // automerge为FTS5的持久配置，合并后恢复默认值4，之后的增量导入照常合并
+        if (!query.exec("INSERT INTO line_fts (line_fts) VALUES ('optimize')") ||
+            !query.exec("INSERT INTO line_fts (line_fts, rank) VALUES ('automerge', 4)")) {
+            qCritical() << "合并全文索引失败：" << query.lastError().text();
+            return false;
+        }
+        qDebug() << "合并全文索引耗时" << timer.elapsed() << "ms";
+    }
+    return true;
+}
+
+void ImportPipeline::LogStageSummary(qint64 wall_ms) const {
+    auto log_stage = [](const char* name, const ImportStageCounter& counter) {
+        qDebug().noquote() << QString("  %1: %2 项, %3 MB, 单线程 %4 MB/s")
+                                  .arg(QString::fromUtf8(name))
+                                  .arg(counter.items.load())
+                                  .arg(counter.bytes.load() / (1024.0 * 1024.0), 0, 'f', 1)
+                                  .arg(counter.MegabytesPerSecond(), 0, 'f', 1);
+    };
+
+    qDebug() << "导入流水线结束，耗时" << wall_ms << "ms，写入文件数:" << m_imported_files_.load()
+             << "解压失败条目数:" << m_failed_entries_.load()
+             << "队列峰值(MB):" << m_peak_queued_bytes_.load() / (1024.0 * 1024.0);
+    log_stage("解压", m_decompress_counter_);
+    log_stage("解码", m_decode_counter_);
+    log_stage("索引", m_index_counter_);
+    log_stage("写入", m_write_counter_);
+    // 写线程整体吞吐（含提交前的索引重建），用于比较批量与逐行两种写入模式
+    double writer_seconds = qMax<qint64>(1, m_writer_ms_) / 1000.0;
+    qDebug().noquote() << QString("  写入模式: %1, %2 行, %3 行/s, 原始数据 %4 MB/s, 收尾 %5 ms")
+                              .arg(m_bulk_load_ ? QStringLiteral("批量") : QStringLiteral("逐行"))
+                              .arg(m_rows_written_)
+                              .arg(m_rows_written_ / writer_seconds, 0, 'f', 0)
+                              .arg(m_raw_bytes_written_ / (1024.0 * 1024.0) / writer_seconds, 0, 'f', 1)
+                              .arg(m_finish_ms_);
+    qint64 stored_bytes = m_write_counter_.bytes.load();
+    if (stored_bytes > 0) {
+        qDebug().noquote() << QString("  内容块压缩比: %1").arg(m_decode_counter_.bytes.load() / double(stored_bytes), 0, 'f', 2);
+    }
+}
@@ -0,0 +1,227 @@
+#ifndef IMPORT_PIPELINE_H
+#define IMPORT_PIPELINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+#include "bounded_queue.h"
+#include "sqlite_text_handler.h"
+#include "zip_archive_reader.h"
+#include "nested_archive.h"
+#include "log_severity.h"
+
+// 单个流水线阶段的吞吐计数（线程安全）
+struct ImportStageCounter {
+    std::atomic<qint64> items{0};     // 处理的条目数
+    std::atomic<qint64> bytes{0};     // 处理的字节数
+    std::atomic<qint64> busy_ns{0};   // 各线程累计耗时（纳秒）
+
+    void Add(qint64 item_bytes, qint64 elapsed_ns) {
+        items.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(item_bytes, std::memory_order_relaxed);
+        busy_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);
+    }
+
+    // 单线程视角下的吞吐量（MB/s）
+    double MegabytesPerSecond() const {
+        qint64 ns = busy_ns.load(std::memory_order_relaxed);
+        return ns > 0 ? (bytes.load(std::memory_order_relaxed) / (1024.0 * 1024.0)) / (ns / 1e9) : 0.0;
+    }
+};
+
+// ZIP导入流水线
+// 解压/切块/行索引 -> UTF-8校验、换行规整与块压缩 -> 数据库写入
+// 每个条目边解压边按换行边界切成固定大小的块，块在阶段间通过按字节计量的
+// 有界队列传递，由唯一的写线程使用独立连接在单个事务中写入file_chunks，
+// 因此峰值内存只取决于内存上限，与归档大小无关
+// 条目本身是gzip/tar/tar.gz/zip时在解压线程中流式展开，内部文件按同样的规则分类和切块
+class ImportPipeline {
+public:
+    // 文件分类回调：根据文件名返回关键字，空字符串表示跳过
+    using Classifier = std::function<QString(const QString& file_name)>;
+    // 关键字到类别的映射
+    using CategoryResolver = std::function<QString(const QString& keyword)>;
+    // 进度回调：每写入一个内容块调用一次（在写线程中调用）
+    // done/total为已完成/总文件数，bytes_done/bytes_total为已写入/总未压缩字节数
+    using ProgressHandler = std::function<void(const QString& entry_name, int done, int total,
+                                               qint64 bytes_done, qint64 bytes_total)>;
+
+    // db_file为目标归档的独立数据库文件，写线程在其上打开专用连接
+    ImportPipeline(const QString& db_file, const ZipArchiveReader& reader, const QString& zip_source);
+    ~ImportPipeline();
+
+    void SetClassifier(const Classifier& classifier) { m_classifier_ = classifier; }
+    void SetCategoryResolver(const CategoryResolver& resolver) { m_category_resolver_ = resolver; }
+    void SetProgressHandler(const ProgressHandler& handler) { m_progress_handler_ = handler; }
+
+    // 取消标志：置位后各阶段尽快退出，写线程回滚事务
+    void SetCancelFlag(const std::atomic<bool>* cancel_flag) { m_cancel_flag_ = cancel_flag; }
+    // 增量导入：已入库条目（file_path -> 状态）。指纹相同的条目跳过，
+    // 不在新归档中或已变化的条目在写入事务内删除，取消或失败时旧数据保持不变
+    void SetExistingEntries(const QHash<QString, DbEntryState>& existing) { m_existing_entries_ = existing; }
+
+    // 分类并与已入库条目比对，确定需要导入/删除的条目（Run()会自动调用）
+    void Prepare();
+    bool HasChanges() const { return !m_work_items_.isEmpty() || !m_stale_file_ids_.isEmpty(); }
+    int PendingEntryCount() const { return m_work_items_.size(); }
+    int UnchangedFileCount() const { return m_unchanged_files_; }
+    int RemovedFileCount() const { return m_stale_file_ids_.size(); }
+
+    // 批量导入模式（用于新建的空归档）：写入前删除二级索引并暂停line_fts的自动合并，
+    // 全部内容写完后在同一事务中一次性重建索引、合并全文索引段，提交后截断WAL。
+    // 新归档在提交并记录指纹前不会被激活，查询期间照常使用之前的归档；
+    // 增量导入不使用此模式，读连接在提交前看到的是WAL中的旧快照
+    void SetBulkLoad(bool enabled) { m_bulk_load_ = enabled; }
+    bool IsBulkLoad() const { return m_bulk_load_; }
+
+    // 导入过程中缓冲数据的内存上限（字节），需在Run()之前设置
+    void SetMemoryBudget(qint64 bytes);
+    qint64 MemoryBudget() const { return m_memory_budget_; }
+
+    // 执行导入，阻塞直到所有阶段结束
+    bool Run();
+
+    static constexpr qint64 k_default_memory_budget_ = 256ll * 1024 * 1024;
+
+    QString ErrorString() const;
+    bool WasCancelled() const { return m_cancelled_.load(); }
+    int ImportedFileCount() const { return m_imported_files_.load(); }
+    // 解压中途出错的条目数：已写入的部分内容保留，但不记录条目指纹，下次导入时重新读取
+    int FailedEntryCount() const { return m_failed_entries_.load(); }
+
+    // 各阶段计数
+    const ImportStageCounter& DecompressCounter() const { return m_decompress_counter_; }
+    const ImportStageCounter& DecodeCounter() const { return m_decode_counter_; }
+    const ImportStageCounter& IndexCounter() const { return m_index_counter_; }
+    const ImportStageCounter& WriteCounter() const { return m_write_counter_; }
+
+    // 写线程统计，Run()返回后有效
+    qint64 RowsWritten() const { return m_rows_written_; }
+    qint64 RawBytesWritten() const { return m_raw_bytes_written_; }
+    qint64 WriterMilliseconds() const { return m_writer_ms_; }
+    qint64 FinishMilliseconds() const { return m_finish_ms_; }
+
+private:
+    // 一个文件的内容块，同一文件的块可能被不同解码线程乱序送达写线程
+    struct ContentChunk {
+        int file_slot = -1;        // m_file_slots_中的下标
+        int chunk_no = 0;
+        qint64 first_line = 0;     // 块首行在文件中的行号（从0开始）
+        int line_count = 0;
+        bool is_last = false;
+        qint64 total_lines = 0;    // 仅最后一块有效：整个文件的行数
+        QString content_hash;      // 仅最后一块有效：整个文件的xxHash64
+        qint64 total_bytes = 0;    // 仅最后一块有效：整个文件解压后的字节数
+        int codec = SqliteDbManager::k_codec_raw_;   // 解码阶段压缩后设置
+        qint64 raw_size = 0;       // 压缩前的字节数
+        LineTimeIndex::ChunkTimes times;   // 解码阶段解析的行时间戳
+        LogSeverity::Counts severity;      // 解码阶段统计的错误/警告行数
+        QByteArray text;           // 压缩前的内容，写线程据此建立行级全文索引
+        QByteArray data;
+    };
+
+    // 一个待解压的ZIP条目：普通文件、单文件gzip或需要展开的容器
+    struct WorkItem {
+        const ZipEntryInfo* entry = nullptr;
+        NestedArchive::Kind kind = NestedArchive::Kind::None;
+        QString path;              // 普通文件/单文件gzip入库时的路径
+        QString keyword;           // 容器为空，成员在展开时分类
+        QString fingerprint;       // 容器内的成员沿用容器条目的指纹
+    };
+
+    // 一个入库文件（普通条目或容器展开出的成员），由解压线程登记
+    struct FileSlot {
+        QString path;
+        QString keyword;
+        QString fingerprint;
+        int item_index = -1;       // 所属的m_work_items_下标
+        qint64 size = -1;          // 未知时为-1，写入最后一块时以实际字节数为准
+    };
+
+    class FileEmitter;
+    class MemberFactory;
+
+    void DecompressWorker();
+    void DecodeWorker();
+    void WriterLoop();
+
+    bool StreamEntry(int item_index, QString* error);
+    int RegisterFile(const FileSlot& slot);
+    void MarkEntryFailed(int item_index);
+    bool IsEntryFailed(int item_index) const;
+    FileSlot FileSlotAt(int index) const;
+    int FileSlotCount() const;
+    qint64 NestedZipMemoryLimit() const { return m_memory_budget_ / 4; }
+    bool PushChunk(ContentChunk&& chunk);
+    bool CheckCancelled();
+    void Fail(const QString& error);
+    bool BeginBulkLoad(QSqlDatabase& db, bool index_lines);
+    bool FinishBulkLoad(QSqlDatabase& db, bool index_lines);
+    void LogStageSummary(qint64 wall_ms) const;
+
+private:
+    QString m_db_file_;
+    const ZipArchiveReader& m_reader_;
+    QString m_zip_source_;
+
+    Classifier m_classifier_;
+    CategoryResolver m_category_resolver_;
+    ProgressHandler m_progress_handler_;
+    const std::atomic<bool>* m_cancel_flag_;
+    QHash<QString, DbEntryState> m_existing_entries_;
+
+    // 待处理条目（按文件名预筛选）
+    QList<WorkItem> m_work_items_;
+    QList<FileSlot> m_file_slots_;
+    QSet<int> m_failed_items_;     // 解压出错的条目下标，与文件槽共用m_slot_mutex_
+    mutable QMutex m_slot_mutex_;
+    QList<qint64> m_stale_file_ids_;
+    int m_unchanged_files_;
+    bool m_prepared_;
+    std::atomic<int> m_next_entry_;
+
+    // 阶段间的有界队列（按字节计量）
+    BoundedQueue<ContentChunk> m_raw_queue_;
+    BoundedQueue<ContentChunk> m_decoded_queue_;
+    qint64 m_memory_budget_;
+
+    // 用于在最后一个生产者结束时关闭下游队列
+    std::atomic<int> m_active_decompressors_;
+    std::atomic<int> m_active_decoders_;
+
+    QThreadPool m_pool_;
+    int m_worker_count_;
+
+    std::atomic<bool> m_failed_;
+    std::atomic<bool> m_cancelled_;
+    qint64 m_total_bytes_;
+    std::atomic<int> m_imported_files_;
+    std::atomic<int> m_failed_entries_;
+    std::atomic<qint64> m_peak_queued_bytes_;
+    mutable QMutex m_error_mutex_;
+    QString m_error_string_;
+
+    ImportStageCounter m_decompress_counter_;
+    ImportStageCounter m_decode_counter_;
+    ImportStageCounter m_index_counter_;
+    ImportStageCounter m_write_counter_;
+
+    // 写线程统计（写线程结束后读取）：写入的行数（files/file_chunks/line_times/line_fts）、
+    // 原始字节数、写线程总耗时以及提交前收尾（关键字索引、二级索引、全文索引合并）的耗时
+    bool m_bulk_load_;
+    qint64 m_rows_written_;
+    qint64 m_raw_bytes_written_;
+    qint64 m_writer_ms_;
+    qint64 m_finish_ms_;
+
+    static constexpr const char* k_writer_connection_name_ = "ImportWriterConnection";
+};
+
+#endif // IMPORT_PIPELINE_H
@@ -0,0 +1,250 @@
+#include "line_time_index.h"
+#include <QDate>
+#include <QTime>
+#include <QDateTime>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// 同一天的时间戳共用当天0点的本地时间换算结果，避免逐行构造QDateTime
+struct DayCache {
+    int key = -1;
+    qint64 day_start = 0;
+};
+
+inline bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline int TwoDigits(const char* p) {
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+// 读取1~3位小数部分，换算为毫秒；p指向'.'之后
+int ReadMillis(const char* p, const char* end) {
+    int millis = 0;
+    int digits = 0;
+    while (p < end && IsDigit(*p) && digits < 3) {
+        millis = millis * 10 + (*p - '0');
+        ++p;
+        ++digits;
+    }
+    while (digits > 0 && digits < 3) {
+        millis *= 10;
+        ++digits;
+    }
+    return millis;
+}
+
+// dd/mm/yy hh:mm:ss[.zzz]
+bool MatchDate(const char* p, const char* end, DayCache& cache, qint64* time) {
+    if (end - p < 17) {
+        return false;
+    }
+    for (int i : {0, 1, 3, 4, 6, 7}) {
+        if (!IsDigit(p[i])) {
+            return false;
+        }
+    }
+    if (p[2] != '/' || p[5] != '/') {
+        return false;
+    }
+
+    const char* q = p + 8;
+    if (q >= end || (*q != ' ' && *q != '\t')) {
+        return false;
+    }
+    while (q < end && (*q == ' ' || *q == '\t')) {
+        ++q;
+    }
+    if (end - q < 8 || q[2] != ':' || q[5] != ':') {
+        return false;
+    }
+    for (int i : {0, 1, 3, 4, 6, 7}) {
+        if (!IsDigit(q[i])) {
+            return false;
+        }
+    }
+
+    int day = TwoDigits(p);
+    int month = TwoDigits(p + 3);
+    int year = 2000 + TwoDigits(p + 6);
+    int hour = TwoDigits(q);
+    int minute = TwoDigits(q + 3);
+    int second = TwoDigits(q + 6);
+    if (hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    int millis = 0;
+    if (q + 8 < end && q[8] == '.') {
+        millis = ReadMillis(q + 9, end);
+    }
+
+    int key = (year * 100 + month) * 100 + day;
+    if (key != cache.key) {
+        QDate date(year, month, day);
+        if (!date.isValid()) {
+            return false;
+        }
+        cache.key = key;
+        cache.day_start = QDateTime(date, QTime(0, 0)).toMSecsSinceEpoch();
+    }
+    *time = cache.day_start + ((hour * 60 + minute) * 60 + second) * 1000LL + millis;
+    return true;
+}
+
+// 10位Unix秒，可带小数
+bool MatchEpoch(const char* p, const char* end, qint64* time) {
+    constexpr qint64 k_min_seconds = 946684800;    // 2000-01-01
+    constexpr qint64 k_max_seconds = 4102444800;   // 2100-01-01
+
+    qint64 seconds = 0;
+    int digits = 0;
+    const char* q = p;
+    while (q < end && IsDigit(*q)) {
+        if (++digits > 10) {
+            return false;
+        }
+        seconds = seconds * 10 + (*q - '0');
+        ++q;
+    }
+    if (digits != 10 || seconds < k_min_seconds || seconds >= k_max_seconds) {
+        return false;
+    }
+
+    int millis = 0;
+    if (q + 1 < end && *q == '.' && IsDigit(q[1])) {
+        millis = ReadMillis(q + 1, end);
+    }
+    *time = seconds * 1000 + millis;
+    return true;
+}
+
+bool ParseWithCache(const char* line, qint64 size, DayCache& cache, qint64* time) {
+    const char* end = line + size;
+    const char* scan_end = line + qMin<qint64>(size, LineTimeIndex::k_scan_limit_);
+
+    for (const char* p = line; p < scan_end; ++p) {
+        if (!IsDigit(*p)) {
+            continue;
+        }
+        // 只从数字串的开头匹配，小数部分或长数字的中间不算
+        if (p == line || (!IsDigit(p[-1]) && p[-1] != '.')) {
+            if (MatchDate(p, end, cache, time) || MatchEpoch(p, end, time)) {
+                return true;
+            }
+        }
+        while (p + 1 < scan_end && IsDigit(p[1])) {
+            ++p;
+        }
+    }
+    return false;
+}
+
+void AppendVarint(QByteArray& out, quint64 value) {
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+bool ReadVarint(const char*& p, const char* end, quint64* value) {
+    quint64 result = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        quint8 byte = static_cast<quint8>(*p++);
+        result |= static_cast<quint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline quint64 ZigZag(qint64 value) {
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+inline qint64 UnZigZag(quint64 value) {
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+} // namespace
+
+LineTimeIndex::ChunkTimes LineTimeIndex::Build(const QByteArray& data) {
+    ChunkTimes result;
+    std::vector<Entry> entries;
+    DayCache cache;
+
+    const char* p = data.constData();
+    const char* end = p + data.size();
+    qint64 line = 0;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line_end = newline ? newline : end;
+
+        qint64 time = 0;
+        if (ParseWithCache(p, line_end - p, cache, &time)) {
+            if (entries.empty() || time < result.min_time) {
+                result.min_time = time;
+            }
+            if (entries.empty() || time > result.max_time) {
+                result.max_time = time;
+            }
+            entries.push_back({ line, time });
+        }
+
+        ++line;
+        p = newline ? newline + 1 : end;
+    }
+
+    result.count = static_cast<int>(entries.size());
+    qint64 prev_line = 0;
+    qint64 prev_time = result.min_time;
+    for (const Entry& entry : entries) {
+        AppendVarint(result.entries, static_cast<quint64>(entry.line - prev_line));
+        AppendVarint(result.entries, ZigZag(entry.time - prev_time));
+        prev_line = entry.line;
+        prev_time = entry.time;
+    }
+    return result;
+}
+
+QList<LineTimeIndex::Entry> LineTimeIndex::Decode(const QByteArray& entries, qint64 first_line, qint64 min_time) {
+    QList<Entry> result;
+    const char* p = entries.constData();
+    const char* end = p + entries.size();
+
+    Entry entry;
+    entry.line = first_line;
+    entry.time = min_time;
+    while (p < end) {
+        quint64 line_delta = 0;
+        quint64 time_delta = 0;
+        if (!ReadVarint(p, end, &line_delta) || !ReadVarint(p, end, &time_delta)) {
+            break;
+        }
+        entry.line += static_cast<qint64>(line_delta);
+        entry.time += UnZigZag(time_delta);
+        result.append(entry);
+    }
+    return result;
+}
+
+bool LineTimeIndex::ParseLine(const char* line, qint64 size, qint64* time) {
+    DayCache cache;
+    return ParseWithCache(line, size, cache, time);
+}
+
+qint64 LineTimeIndex::ParseText(const QString& text) {
+    QByteArray utf8 = text.trimmed().toUtf8();
+    qint64 time = 0;
+    return ParseLine(utf8.constData(), utf8.size(), &time) ? time : -1;
+}
+
+QString LineTimeIndex::Format(qint64 time) {
+    return QDateTime::fromMSecsSinceEpoch(time).toString("dd/MM/yy hh:mm:ss.zzz");
+}
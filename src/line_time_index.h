@@ -0,0 +1,47 @@
+#ifndef LINE_TIME_INDEX_H
+#define LINE_TIME_INDEX_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+
+// 日志行时间戳索引
+// 导入时逐行解析时间戳，支持两种格式：
+//   dd/mm/yy hh:mm:ss[.zzz]    普通日志（按本地时间解释）
+//   1753195393.192              vehicle等数据中的Unix秒（可带小数）
+// 每个内容块的时间戳编码为一条紧凑记录：块内最小/最大时间 + 变长编码的(行号差, 时间差)序列，
+// 存入line_times表，按(file_id, max_ts)索引，时间范围/跳转/时间窗口查询只需定位少量块再解码。
+// 时间统一为自1970-01-01 UTC起的毫秒数。
+class LineTimeIndex {
+public:
+    struct Entry {
+        qint64 line = 0;   // 文件内行号（从0开始）
+        qint64 time = 0;   // 毫秒时间戳
+    };
+
+    // 一个内容块的时间索引
+    struct ChunkTimes {
+        int count = 0;         // 带时间戳的行数
+        qint64 min_time = 0;
+        qint64 max_time = 0;
+        QByteArray entries;    // 编码后的(行号差, 时间差)序列
+    };
+
+    // 为一个内容块建立时间索引（行号相对于块首行）
+    static ChunkTimes Build(const QByteArray& data);
+    // 解码，first_line为块首行在文件中的行号，min_time为该块的min_time
+    static QList<Entry> Decode(const QByteArray& entries, qint64 first_line, qint64 min_time);
+
+    // 解析一行中的第一个时间戳
+    static bool ParseLine(const char* line, qint64 size, qint64* time);
+    // 解析用户输入的时间（两种格式均可），失败返回-1
+    static qint64 ParseText(const QString& text);
+    // 格式化为dd/MM/yy hh:mm:ss.zzz（本地时间），与日志中的格式一致
+    static QString Format(qint64 time);
+
+    // 每行只在开头这么多字节内查找时间戳
+    static constexpr int k_scan_limit_ = 256;
+};
+
+#endif // LINE_TIME_INDEX_H
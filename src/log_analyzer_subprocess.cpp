@@ -12,6 +12,7 @@
 #include <QMutexLocker>
 #include <QCoreApplication>
 #include "sub_process_config_manager.h"
+#include "file_classifier.h"
 
 LogAnalyzerSubProcess::LogAnalyzerSubProcess(QObject* parent)
     : BaseSubProcess(parent)   
@@ -38,6 +39,8 @@ bool LogAnalyzerSubProcess::OnInitialize()
         qCritical() << "[LogAnalyzerSubProcess] Failed to initialize IPC communication.";
         return false;
     }
+
+    ApplyFileClassifierConfig();
     return true;
 }
 
@@ -99,9 +102,20 @@ void LogAnalyzerSubProcess::HandleConfigUpdateMessage(const IpcMessage& message)
     {
         emit workDirectoryUpdated(workDir);
     }
+    ApplyFileClassifierConfig();
     qDebug() << "Configuration updated successfully";
 }
 
+void LogAnalyzerSubProcess::ApplyFileClassifierConfig()
+{
+    // 未配置时保留当前规则（首次为内置规则）
+    QJsonValue classifier_config = GetConfigManager()->GetValue("file_classifier");
+    if (!classifier_config.isObject()) {
+        return;
+    }
+    FileClassifier::SetCurrent(FileClassifier::FromJson(classifier_config.toObject()));
+}
+
 void LogAnalyzerSubProcess::HandleCommandMessage(const IpcMessage& message)
 {
     QString command = message.body.value("command").toString();
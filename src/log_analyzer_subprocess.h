@@ -40,6 +40,8 @@ private:
     void HandleConfigUpdateMessage(const IpcMessage& message);
     void HandleCommandMessage(const IpcMessage& message);
     void HandleShutdownMessage(const IpcMessage& message);
+    // 从配置加载文件分类规则
+    void ApplyFileClassifierConfig();
     
     void SendErrorReport(const QString& error_message, const QString& context = QString());
 
@@ -0,0 +1,96 @@
+#include "log_severity.h"
+#include <cstring>
+
+namespace {
+
+inline bool IsLetter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline bool IsWordChar(char c) {
+    return IsLetter(c) || (c >= '0' && c <= '9') || c == '_';
+}
+
+// word为小写，text不区分大小写
+bool EqualsWord(const char* text, qint64 size, const char* word) {
+    if (static_cast<qint64>(std::strlen(word)) != size) {
+        return false;
+    }
+    for (qint64 i = 0; i < size; ++i) {
+        if ((text[i] | 0x20) != word[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+LogSeverity::Level MatchWord(const char* text, qint64 size) {
+    static const char* const k_errors[] = { "error", "err", "fatal", "critical", "crit" };
+    static const char* const k_warnings[] = { "warning", "warn" };
+
+    // 最短的err/crit为3/4个字母，最长的critical为8个字母
+    if (size < 3 || size > 8) {
+        return LogSeverity::Level::None;
+    }
+    for (const char* word : k_errors) {
+        if (EqualsWord(text, size, word)) {
+            return LogSeverity::Level::Error;
+        }
+    }
+    for (const char* word : k_warnings) {
+        if (EqualsWord(text, size, word)) {
+            return LogSeverity::Level::Warning;
+        }
+    }
+    return LogSeverity::Level::None;
+}
+
+} // namespace
+
+LogSeverity::Level LogSeverity::ParseLine(const char* line, qint64 size) {
+    const char* end = line + qMin<qint64>(size, k_scan_limit_);
+    const char* p = line;
+    while (p < end) {
+        if (!IsLetter(*p)) {
+            ++p;
+            continue;
+        }
+        // 单词需以非单词字符分隔，避免匹配到terror、warning_count之类
+        const char* word_end = p;
+        while (word_end < end && IsWordChar(*word_end)) {
+            ++word_end;
+        }
+        if (p == line || !IsWordChar(p[-1])) {
+            Level level = MatchWord(p, word_end - p);
+            if (level != Level::None) {
+                return level;
+            }
+        }
+        p = word_end;
+    }
+    return Level::None;
+}
+
+LogSeverity::Counts LogSeverity::Count(const QByteArray& data) {
+    Counts counts;
+    const char* p = data.constData();
+    const char* end = p + data.size();
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line_end = newline ? newline : end;
+
+        switch (ParseLine(p, line_end - p)) {
+        case Level::Error:
+            ++counts.errors;
+            break;
+        case Level::Warning:
+            ++counts.warnings;
+            break;
+        case Level::None:
+            break;
+        }
+
+        p = newline ? newline + 1 : end;
+    }
+    return counts;
+}
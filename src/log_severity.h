@@ -0,0 +1,39 @@
+#ifndef LOG_SEVERITY_H
+#define LOG_SEVERITY_H
+
+#include <QtGlobal>
+#include <QByteArray>
+
+// 日志级别统计
+// 导入时逐行判断级别，每个文件的错误/警告行数存入files表，再汇总到keyword_stats。
+// 只在行首k_scan_limit_字节内按单词匹配（不区分大小写）：
+//   error / err / fatal / critical / crit   错误
+//   warning / warn                          警告
+// 每行取第一个匹配的单词，一行只计一次。
+class LogSeverity {
+public:
+    enum class Level {
+        None,
+        Warning,
+        Error
+    };
+
+    struct Counts {
+        int errors = 0;
+        int warnings = 0;
+
+        Counts& operator+=(const Counts& other) {
+            errors += other.errors;
+            warnings += other.warnings;
+            return *this;
+        }
+    };
+
+    static Level ParseLine(const char* line, qint64 size);
+    // 统计一个内容块中各级别的行数
+    static Counts Count(const QByteArray& data);
+
+    static constexpr int k_scan_limit_ = 256;
+};
+
+#endif // LOG_SEVERITY_H
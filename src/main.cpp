@@ -93,6 +93,10 @@ int main(int argc, char *argv[])
     // 注册 FileListModel 到 QML 和元类型系统
     qmlRegisterType<FileListModel>("Log_analyzer", 1, 0, "FileListModel");
     qRegisterMetaType<FileListModel*>("FileListModel*");
+    qmlRegisterType<SearchResultModel>("Log_analyzer", 1, 0, "SearchResultModel");
+    qRegisterMetaType<SearchResultModel*>("SearchResultModel*");
+    qmlRegisterType<TextLineModel>("Log_analyzer", 1, 0, "TextLineModel");
+    qRegisterMetaType<TextLineModel*>("TextLineModel*");
 
     qmlRegisterType<SshFileListModel>("Log_analyzer", 1, 0, "SshFileListModel");
     qRegisterMetaType<SshFileListModel*>("SshFileListModel*");
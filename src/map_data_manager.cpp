@@ -28,15 +28,30 @@ bool MapDataManager::loadMapData()
         return false;
     }
     
-    QString xmlContent = getXmlContentFromDatabase();
-    if (xmlContent.isEmpty()) {
-        emit loadError("无法从数据库获取地图XML数据");
-        return false;
-    }
-    
-    qDebug() << "开始解析地图XML数据，内容长度：" << xmlContent.length();
-    
-    return m_mapParser->parseXmlContent(xmlContent);
+    // 在数据库线程上读取，读完后回到GUI线程解析；重复调用时取消上一次读取
+    m_mapFuture.cancel();
+    SqliteDbManager* dbManager = m_dbManager;
+    m_mapFuture = m_dbManager->RunAsync<MapSource>([dbManager](QPromise<MapSource>& promise) {
+        MapSource source = getMapSourceFromDatabase(dbManager, [&promise]() { return promise.isCanceled(); });
+        if (!promise.isCanceled()) {
+            promise.addResult(source);
+        }
+    });
+    m_mapFuture.then(this, [this](const MapSource& source) {
+        if (!source.version.isEmpty() && source.version != m_version) {
+            m_version = source.version;
+            emit versionChanged();
+        }
+        if (source.xmlContent.isEmpty()) {
+            emit loadError("无法从数据库获取地图XML数据");
+            return;
+        }
+        
+        qDebug() << "开始解析地图XML数据，内容长度：" << source.xmlContent.length();
+        
+        m_mapParser->parseXmlContent(source.xmlContent);
+    });
+    return true;
 }
 
 bool MapDataManager::loadVehicleTrack()
@@ -46,26 +61,36 @@ bool MapDataManager::loadVehicleTrack()
         return false;
     }
     
-    QString vehicleData = getVehicleDataFromDatabase();
-    if (vehicleData.isEmpty()) {
-        emit loadError("无法从数据库获取vehicle轨迹数据");
-        return false;
-    }
-    
-    qDebug() << "开始解析车辆轨迹数据，内容长度：" << vehicleData.length();
-    
-    bool success = m_mapParser->parseVehicleData(vehicleData);
-    if (success) {
-        m_vehicleTrackLoaded = true;
-        emit vehicleTrackCountChanged();
-        emit vehicleTrackLoaded();
-    }
-    
-    return success;
+    // vehicle数据可能很大，读取放在数据库线程上，避免切换到vehicle时界面卡住
+    m_trackFuture.cancel();
+    SqliteDbManager* dbManager = m_dbManager;
+    m_trackFuture = m_dbManager->RunAsync<QString>([dbManager](QPromise<QString>& promise) {
+        QString vehicleData = getVehicleDataFromDatabase(dbManager, [&promise]() { return promise.isCanceled(); });
+        if (!promise.isCanceled()) {
+            promise.addResult(vehicleData);
+        }
+    });
+    m_trackFuture.then(this, [this](const QString& vehicleData) {
+        if (vehicleData.isEmpty()) {
+            emit loadError("无法从数据库获取vehicle轨迹数据");
+            return;
+        }
+        
+        qDebug() << "开始解析车辆轨迹数据，内容长度：" << vehicleData.length();
+        
+        if (m_mapParser->parseVehicleData(vehicleData)) {
+            m_vehicleTrackLoaded = true;
+            emit vehicleTrackCountChanged();
+            emit vehicleTrackLoaded();
+        }
+    });
+    return true;
 }
 
 void MapDataManager::clearMapData()
 {
+    m_mapFuture.cancel();
+    m_trackFuture.cancel();
     m_isLoaded = false;
     m_vehicleTrackLoaded = false;
     emit isLoadedChanged();
@@ -76,15 +101,14 @@ void MapDataManager::clearMapData()
     emit vehicleTrackCountChanged();
 }
 
-QString MapDataManager::getXmlContentFromDatabase()
+MapDataManager::MapSource MapDataManager::getMapSourceFromDatabase(SqliteDbManager* dbManager,
+                                                                  const std::function<bool()>& isCancelled)
 {
-    if (!m_dbManager) {
-        return QString();
-    }
+    MapSource source;
     
     // 通过关键字"map"获取文件内容
-    QString content = m_dbManager->GetMergedContentByKeyword("map");
-    QString version_str = m_dbManager->GetMergedContentByKeyword("version");
+    QString content = dbManager->GetMergedContentByKeyword("map", QList<int>(), isCancelled);
+    QString version_str = dbManager->GetMergedContentByKeyword("version", QList<int>(), isCancelled);
     
     // 从version字符串中提取版本号
     if (!version_str.isEmpty()) {
@@ -92,46 +116,39 @@ QString MapDataManager::getXmlContentFromDatabase()
         for (const QString& line : lines) {
             QString trimmed_line = line.trimmed();
             if (trimmed_line.startsWith("VERSION=")) {
-                QString version = trimmed_line.mid(8).trimmed(); // 跳过 "VERSION="
-                if (version != m_version) {
-                    m_version = version;
-                    emit versionChanged();
-                }
+                source.version = trimmed_line.mid(8).trimmed(); // 跳过 "VERSION="
                 break;
             }
         }
     }
     
-    if (content.isEmpty()) {
-        // 尝试直接查询file_name为"map.wef"的记录
-        QList<DbFileRecord> allFiles = m_dbManager->GetAllFiles();
+    if (content.isEmpty() && !isCancelled()) {
+        // 尝试直接查询file_name为"map.wef"的记录：先只列元数据，命中后再读取该文件内容
+        QList<DbFileRecord> allFiles = dbManager->ListFiles();
         for (const DbFileRecord& record : allFiles) {
             if (record.file_name.toLower() == "map.wef" || 
                 record.file_name.toLower().contains("map")) {
-                content = record.content;
+                content = dbManager->ReadFileText(record.archive_id, record.id);
                 break;
             }
         }
     }
     
-    return content;
+    source.xmlContent = content;
+    return source;
 }
 
-QString MapDataManager::getVehicleDataFromDatabase()
+QString MapDataManager::getVehicleDataFromDatabase(SqliteDbManager* dbManager, const std::function<bool()>& isCancelled)
 {
-    if (!m_dbManager) {
-        return QString();
-    }
-    
     // 通过关键字"vehicle"获取文件内容
-    QString content = m_dbManager->GetMergedContentByKeyword("vehicle");
+    QString content = dbManager->GetMergedContentByKeyword("vehicle", QList<int>(), isCancelled);
     
-    if (content.isEmpty()) {
+    if (content.isEmpty() && !isCancelled()) {
         // 如果通过关键字找不到，尝试查找包含"vehicle"的文件名
-        QList<DbFileRecord> allFiles = m_dbManager->GetAllFiles();
+        QList<DbFileRecord> allFiles = dbManager->ListFiles();
         for (const DbFileRecord& record : allFiles) {
             if (record.file_name.toLower().contains("vehicle")) {
-                content = record.content;
+                content = dbManager->ReadFileText(record.archive_id, record.id);
                 break;
             }
         }
@@ -8,6 +8,8 @@
 #include <QRectF>
 #include <QPointF>
 #include <QPainterPath>
+#include <QFuture>
+#include <functional>
 #include "map_xml_parser.h"
 
 class SqliteDbManager;
@@ -35,6 +37,7 @@ public:
     void setDatabaseManager(SqliteDbManager* dbManager);
     
     // QML可调用的方法
+    // 加载为异步：数据库读取在数据库线程上进行，返回是否已开始，结果经mapDataLoaded/vehicleTrackLoaded/loadError通知
     Q_INVOKABLE bool loadMapData();
     Q_INVOKABLE void clearMapData();
     Q_INVOKABLE bool loadVehicleTrack();
@@ -84,9 +87,17 @@ private:
     bool m_vehicleTrackLoaded;
     QString m_version;
     
-    // 内部辅助方法
-    QString getXmlContentFromDatabase();
-    QString getVehicleDataFromDatabase();
+    // 从数据库读取的地图数据（在数据库线程上生成）
+    struct MapSource {
+        QString xmlContent;
+        QString version;
+    };
+    QFuture<MapSource> m_mapFuture;
+    QFuture<QString> m_trackFuture;
+    
+    // 内部辅助方法（在数据库线程上执行，不访问成员）
+    static MapSource getMapSourceFromDatabase(SqliteDbManager* dbManager, const std::function<bool()>& isCancelled);
+    static QString getVehicleDataFromDatabase(SqliteDbManager* dbManager, const std::function<bool()>& isCancelled);
     QVariantMap segmentToVariantMap(const MapSegment& segment) const;
     QVariantMap partToVariantMap(const MapPart& part) const;
     QVariantList controlPointsToVariantList(const QList<ControlPoint>& controlPoints) const;
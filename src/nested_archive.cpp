@@ -0,0 +1,405 @@
+#include "nested_archive.h"
+#include "zip_archive_reader.h"
+#include <QDebug>
+#include <zlib.h>
+#include <cstring>
+
+namespace {
+
+constexpr int k_tar_block_size = 512;
+constexpr qint64 k_gzip_output_size = 256 * 1024;
+constexpr qint64 k_max_tar_meta_size = 1024 * 1024;   // 长文件名/pax头的上限
+
+// tar数字字段：八进制文本，或GNU扩展的base-256（首字节最高位为1）
+qint64 ParseTarNumber(const char* field, int size) {
+    const auto* p = reinterpret_cast<const unsigned char*>(field);
+    if (p[0] & 0x80) {
+        qint64 value = p[0] & 0x7F;
+        for (int i = 1; i < size; ++i) {
+            value = (value << 8) | p[i];
+        }
+        return value;
+    }
+
+    qint64 value = 0;
+    int i = 0;
+    while (i < size && (p[i] == ' ' || p[i] == 0)) {
+        ++i;
+    }
+    for (; i < size && p[i] >= '0' && p[i] <= '7'; ++i) {
+        value = value * 8 + (p[i] - '0');
+    }
+    return value;
+}
+
+QString ParseTarString(const char* field, int size) {
+    int length = 0;
+    while (length < size && field[length] != 0) {
+        ++length;
+    }
+    return QString::fromUtf8(field, length);
+}
+
+QString NormalizeMemberPath(QString path) {
+    while (path.startsWith("./")) {
+        path.remove(0, 2);
+    }
+    while (path.startsWith('/')) {
+        path.remove(0, 1);
+    }
+    return path;
+}
+
+} // namespace
+
+// ==================== NestedArchive ====================
+
+NestedArchive::Kind NestedArchive::DetectKind(const QString& name) {
+    QString lower = name.toLower();
+    if (lower.endsWith(".tar.gz") || lower.endsWith(".tgz")) {
+        return Kind::TarGzip;
+    }
+    if (lower.endsWith(".tar")) {
+        return Kind::Tar;
+    }
+    if (lower.endsWith(".gz")) {
+        return Kind::Gzip;
+    }
+    if (lower.endsWith(".zip")) {
+        return Kind::Zip;
+    }
+    return Kind::None;
+}
+
+QString NestedArchive::GzipInnerName(const QString& name) {
+    return name.toLower().endsWith(".gz") ? name.left(name.size() - 3) : name;
+}
+
+std::unique_ptr<ByteSink> NestedArchive::CreateExpander(Kind kind, const QString& path, ArchiveMemberFactory* factory,
+                                                        int depth, qint64 zip_memory_limit) {
+    if (depth > k_max_depth_) {
+        qWarning() << "归档嵌套层数超过上限，跳过:" << path;
+        return nullptr;
+    }
+
+    switch (kind) {
+    case Kind::Gzip: {
+        std::unique_ptr<ByteSink> inner = factory->OpenMember(GzipInnerName(path), -1, depth);
+        if (!inner) {
+            return nullptr;
+        }
+        return std::make_unique<GzipDecodeSink>(std::move(inner));
+    }
+    case Kind::Tar:
+        return std::make_unique<TarExtractSink>(path, factory, depth);
+    case Kind::TarGzip:
+        return std::make_unique<GzipDecodeSink>(std::make_unique<TarExtractSink>(path, factory, depth));
+    case Kind::Zip:
+        return std::make_unique<ZipBufferSink>(path, factory, depth, zip_memory_limit);
+    case Kind::None:
+        break;
+    }
+    return nullptr;
+}
+
+// ==================== GzipDecodeSink ====================
+
+struct GzipDecodeSink::State {
+    z_stream stream;
+    bool initialized = false;
+};
+
+GzipDecodeSink::GzipDecodeSink(std::unique_ptr<ByteSink> downstream)
+    : m_downstream_(std::move(downstream))
+    , m_state_(std::make_unique<State>())
+    , m_out_buffer_(static_cast<int>(k_gzip_output_size), Qt::Uninitialized)
+    , m_stream_ended_(false)
+    , m_trailing_garbage_(false) {
+    memset(&m_state_->stream, 0, sizeof(m_state_->stream));
+    // 16 + MAX_WBITS：只接受gzip封装
+    m_state_->initialized = inflateInit2(&m_state_->stream, 16 + MAX_WBITS) == Z_OK;
+}
+
+GzipDecodeSink::~GzipDecodeSink() {
+    if (m_state_->initialized) {
+        inflateEnd(&m_state_->stream);
+    }
+}
+
+bool GzipDecodeSink::Write(const char* data, qint64 size) {
+    if (!m_state_->initialized) {
+        return Fail("初始化gzip解压器失败");
+    }
+    if (m_trailing_garbage_ || size <= 0) {
+        return true;
+    }
+
+    z_stream& stream = m_state_->stream;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(size);
+
+    do {
+        if (m_stream_ended_) {
+            // 首尾相接的下一个gzip成员；其他数据（如填充的0）忽略
+            if (stream.next_in[0] != 0x1f) {
+                m_trailing_garbage_ = true;
+                return true;
+            }
+            inflateReset(&stream);
+            m_stream_ended_ = false;
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*>(m_out_buffer_.data());
+        stream.avail_out = static_cast<uInt>(m_out_buffer_.size());
+        int ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            m_stream_ended_ = true;
+        } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            return Fail(QString("gzip解压失败：%1").arg(QString::fromLatin1(stream.msg ? stream.msg : "")));
+        }
+
+        qint64 produced = m_out_buffer_.size() - static_cast<qint64>(stream.avail_out);
+        if (produced > 0 && !m_downstream_->Write(m_out_buffer_.constData(), produced)) {
+            return Fail(m_downstream_->ErrorString());
+        }
+    } while (stream.avail_in > 0 || (stream.avail_out == 0 && !m_stream_ended_));
+
+    return true;
+}
+
+bool GzipDecodeSink::Finish() {
+    if (!m_stream_ended_) {
+        return Fail("gzip数据不完整");
+    }
+    if (!m_downstream_->Finish()) {
+        return Fail(m_downstream_->ErrorString());
+    }
+    return true;
+}
+
+// ==================== TarExtractSink ====================
+
+TarExtractSink::TarExtractSink(const QString& prefix, ArchiveMemberFactory* factory, int depth)
+    : m_prefix_(prefix)
+    , m_factory_(factory)
+    , m_depth_(depth)
+    , m_member_remaining_(0)
+    , m_padding_remaining_(0)
+    , m_collect_meta_(false)
+    , m_meta_type_(0)
+    , m_finished_(false) {
+    m_header_.reserve(k_tar_block_size);
+}
+
+bool TarExtractSink::Write(const char* data, qint64 size) {
+    while (size > 0 && !m_finished_) {
+        if (m_member_remaining_ > 0) {
+            qint64 n = qMin(size, m_member_remaining_);
+            if (m_collect_meta_) {
+                if (m_meta_data_.size() + n <= k_max_tar_meta_size) {
+                    m_meta_data_.append(data, n);
+                }
+            } else if (m_member_sink_ && !m_member_sink_->Write(data, n)) {
+                return Fail(m_member_sink_->ErrorString());
+            }
+            data += n;
+            size -= n;
+            m_member_remaining_ -= n;
+            if (m_member_remaining_ == 0 && !FinishMember()) {
+                return false;
+            }
+            continue;
+        }
+
+        if (m_padding_remaining_ > 0) {
+            qint64 n = qMin(size, m_padding_remaining_);
+            data += n;
+            size -= n;
+            m_padding_remaining_ -= n;
+            continue;
+        }
+
+        qint64 n = qMin<qint64>(size, k_tar_block_size - m_header_.size());
+        m_header_.append(data, n);
+        data += n;
+        size -= n;
+        if (m_header_.size() == k_tar_block_size) {
+            bool ok = ParseHeader();
+            m_header_.clear();
+            if (!ok) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool TarExtractSink::ParseHeader() {
+    const char* h = m_header_.constData();
+
+    // 全零块表示归档结束
+    bool all_zero = true;
+    for (int i = 0; i < k_tar_block_size && all_zero; ++i) {
+        all_zero = h[i] == 0;
+    }
+    if (all_zero) {
+        m_finished_ = true;
+        return true;
+    }
+
+    // 校验和按校验字段为8个空格计算
+    quint32 checksum = 0;
+    for (int i = 0; i < k_tar_block_size; ++i) {
+        checksum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(h[i]);
+    }
+    if (checksum != static_cast<quint32>(ParseTarNumber(h + 148, 8))) {
+        return Fail(QString("%1 不是有效的tar数据（头校验失败）").arg(m_prefix_));
+    }
+
+    qint64 size = ParseTarNumber(h + 124, 12);
+    char type = h[156];
+    QString name = ParseTarString(h, 100);
+    if (memcmp(h + 257, "ustar", 5) == 0) {
+        QString prefix = ParseTarString(h + 345, 155);
+        if (!prefix.isEmpty()) {
+            name = prefix + "/" + name;
+        }
+    }
+
+    m_member_remaining_ = size;
+    m_padding_remaining_ = (k_tar_block_size - size % k_tar_block_size) % k_tar_block_size;
+    m_collect_meta_ = false;
+    m_member_sink_.reset();
+
+    if (type == 'L' || type == 'x') {
+        // GNU长文件名或pax扩展头：内容描述下一个成员
+        m_collect_meta_ = true;
+        m_meta_type_ = type;
+        m_meta_data_.clear();
+    } else {
+        if (!m_next_name_.isEmpty()) {
+            name = m_next_name_;
+            m_next_name_.clear();
+        }
+        if (type == '0' || type == '\0' || type == '7') {
+            m_member_sink_ = m_factory_->OpenMember(m_prefix_ + "/" + NormalizeMemberPath(name), size, m_depth_);
+        }
+    }
+
+    if (size == 0) {
+        return FinishMember();
+    }
+    return true;
+}
+
+bool TarExtractSink::FinishMember() {
+    if (m_collect_meta_) {
+        m_collect_meta_ = false;
+        if (m_meta_type_ == 'L') {
+            m_next_name_ = ParseTarString(m_meta_data_.constData(), m_meta_data_.size());
+        } else {
+            // pax记录格式："<长度> <键>=<值>\n"
+            qint64 pos = 0;
+            while (pos < m_meta_data_.size()) {
+                qint64 space = m_meta_data_.indexOf(' ', pos);
+                if (space < 0) {
+                    break;
+                }
+                qint64 length = m_meta_data_.mid(pos, space - pos).toLongLong();
+                if (length <= 0 || pos + length > m_meta_data_.size()) {
+                    break;
+                }
+                QByteArray record = m_meta_data_.mid(space + 1, pos + length - space - 1);
+                if (record.endsWith('\n')) {
+                    record.chop(1);
+                }
+                if (record.startsWith("path=")) {
+                    m_next_name_ = QString::fromUtf8(record.mid(5));
+                }
+                pos += length;
+            }
+        }
+        m_meta_data_.clear();
+        return true;
+    }
+
+    if (m_member_sink_) {
+        std::unique_ptr<ByteSink> sink = std::move(m_member_sink_);
+        if (!sink->Finish()) {
+            return Fail(sink->ErrorString());
+        }
+    }
+    return true;
+}
+
+bool TarExtractSink::Finish() {
+    if (m_member_remaining_ > 0) {
+        return Fail(QString("%1 tar数据不完整").arg(m_prefix_));
+    }
+    return true;
+}
+
+// ==================== ZipBufferSink ====================
+
+ZipBufferSink::ZipBufferSink(const QString& path, ArchiveMemberFactory* factory, int depth, qint64 memory_limit)
+    : m_path_(path)
+    , m_factory_(factory)
+    , m_depth_(depth)
+    , m_memory_limit_(memory_limit)
+    , m_oversized_(false) {
+}
+
+bool ZipBufferSink::Write(const char* data, qint64 size) {
+    if (m_oversized_) {
+        return true;
+    }
+    if (m_data_.size() + size > m_memory_limit_) {
+        qWarning() << "嵌套ZIP超过内存上限，跳过:" << m_path_ << "上限(MB):" << m_memory_limit_ / (1024 * 1024);
+        m_oversized_ = true;
+        m_data_ = QByteArray();
+        return true;
+    }
+    m_data_.append(data, size);
+    return true;
+}
+
+bool ZipBufferSink::Finish() {
+    if (m_oversized_) {
+        return true;
+    }
+
+    ZipArchiveReader reader(m_data_, m_path_);
+    if (!reader.Open()) {
+        // 嵌套ZIP损坏不影响外层归档的其他成员
+        qWarning() << "嵌套ZIP读取失败，跳过:" << m_path_ << reader.ErrorString();
+        return true;
+    }
+
+    for (const ZipEntryInfo& entry : reader.Entries()) {
+        if (entry.is_directory) {
+            continue;
+        }
+        std::unique_ptr<ByteSink> sink = m_factory_->OpenMember(m_path_ + "/" + entry.name,
+                                                                static_cast<qint64>(entry.uncompressed_size), m_depth_);
+        if (!sink) {
+            continue;
+        }
+
+        QString error;
+        bool ok = reader.ReadEntry(entry, [&sink](const char* data, qint64 size) {
+            return sink->Write(data, size);
+        }, &error);
+        if (!ok) {
+            if (!sink->ErrorString().isEmpty()) {
+                return Fail(sink->ErrorString());
+            }
+            qWarning() << "解压嵌套条目失败:" << m_path_ << entry.name << error;
+        }
+        if (!sink->Finish()) {
+            return Fail(sink->ErrorString());
+        }
+    }
+
+    m_data_ = QByteArray();
+    return true;
+}
@@ -0,0 +1,131 @@
+#ifndef NESTED_ARCHIVE_H
+#define NESTED_ARCHIVE_H
+
+#include <QString>
+#include <QByteArray>
+#include <memory>
+
+// 嵌套归档的流式展开（gzip / tar / tar.gz / zip）
+// 各解码器都是推送式的字节接收器：上游每解出一段数据就写入，解码器解出的内容再推给下游，
+// 整条链边解压边处理，不落地中间文件
+
+// 字节接收器
+class ByteSink {
+public:
+    virtual ~ByteSink() = default;
+
+    // 写入一段数据，返回false表示中止（出错或取消）
+    virtual bool Write(const char* data, qint64 size) = 0;
+    // 数据结束
+    virtual bool Finish() = 0;
+
+    QString ErrorString() const { return m_error_string_; }
+
+protected:
+    bool Fail(const QString& error) {
+        if (m_error_string_.isEmpty()) {
+            m_error_string_ = error;
+        }
+        return false;
+    }
+
+    QString m_error_string_;
+};
+
+// 容器成员的接收器工厂，由使用方实现（如导入流水线按文件名分类并切块）
+class ArchiveMemberFactory {
+public:
+    virtual ~ArchiveMemberFactory() = default;
+
+    // 为容器中的一个文件创建接收器，返回空指针表示跳过该文件
+    // path为包含外层容器的完整路径，size未知时为-1，depth为嵌套层数
+    virtual std::unique_ptr<ByteSink> OpenMember(const QString& path, qint64 size, int depth) = 0;
+};
+
+class NestedArchive {
+public:
+    enum class Kind {
+        None,
+        Gzip,       // 单文件gzip（如轮转日志vehicle.3.gz）
+        Tar,
+        TarGzip,    // .tar.gz / .tgz
+        Zip
+    };
+
+    // 按扩展名判断容器类型
+    static Kind DetectKind(const QString& name);
+    // 单文件gzip解压后的文件名（去掉.gz后缀）
+    static QString GzipInnerName(const QString& name);
+
+    // 创建容器的展开链：写入容器的原始字节，解出的文件交给factory
+    // 单文件gzip的内部路径为path去掉.gz；其他容器的成员路径为"path/成员路径"
+    static std::unique_ptr<ByteSink> CreateExpander(Kind kind, const QString& path, ArchiveMemberFactory* factory,
+                                                    int depth, qint64 zip_memory_limit);
+
+    // 嵌套层数上限，防止恶意构造的归档无限展开
+    static constexpr int k_max_depth_ = 4;
+};
+
+// gzip流式解压（支持多个gzip成员首尾相接）
+class GzipDecodeSink : public ByteSink {
+public:
+    explicit GzipDecodeSink(std::unique_ptr<ByteSink> downstream);
+    ~GzipDecodeSink() override;
+
+    bool Write(const char* data, qint64 size) override;
+    bool Finish() override;
+
+private:
+    std::unique_ptr<ByteSink> m_downstream_;
+    struct State;
+    std::unique_ptr<State> m_state_;
+    QByteArray m_out_buffer_;
+    bool m_stream_ended_;
+    bool m_trailing_garbage_;
+};
+
+// tar流式解析（ustar/GNU长文件名/pax路径），成员数据直接转发，不缓存整个成员
+class TarExtractSink : public ByteSink {
+public:
+    TarExtractSink(const QString& prefix, ArchiveMemberFactory* factory, int depth);
+
+    bool Write(const char* data, qint64 size) override;
+    bool Finish() override;
+
+private:
+    bool ParseHeader();
+    bool FinishMember();
+
+    QString m_prefix_;
+    ArchiveMemberFactory* m_factory_;
+    int m_depth_;
+
+    QByteArray m_header_;              // 正在累积的512字节头
+    qint64 m_member_remaining_;        // 当前成员剩余数据字节
+    qint64 m_padding_remaining_;       // 当前成员数据后的填充字节
+    std::unique_ptr<ByteSink> m_member_sink_;
+    bool m_collect_meta_;              // 当前成员是GNU长文件名或pax头，数据需要收集
+    char m_meta_type_;
+    QByteArray m_meta_data_;
+    QString m_next_name_;              // 由长文件名/pax头指定的下一个成员路径
+    bool m_finished_;                  // 已遇到结束块
+};
+
+// 嵌套ZIP：中央目录在末尾，只能先在内存中收集（有上限），结束后逐个条目流式展开
+class ZipBufferSink : public ByteSink {
+public:
+    ZipBufferSink(const QString& path, ArchiveMemberFactory* factory, int depth, qint64 memory_limit);
+
+    bool Write(const char* data, qint64 size) override;
+    bool Finish() override;
+
+private:
+    QString m_path_;
+    ArchiveMemberFactory* m_factory_;
+    int m_depth_;
+    qint64 m_memory_limit_;
+    QByteArray m_data_;
+    bool m_oversized_;
+};
+
+#endif // NESTED_ARCHIVE_H
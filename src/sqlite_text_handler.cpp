@@ -1,5 +1,11 @@
 #include "sqlite_text_handler.h"
 #include "textfilehandler.h"  // 复用FileListModel
+#include "zip_archive_reader.h"
+#include "import_pipeline.h"
+#include "content_hash.h"
+#include "utf8_codec.h"
+#include "file_classifier.h"
+#include "log_severity.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
@@ -7,41 +13,81 @@
 #include <QFileDialog>
 #include <QFile>
 #include <QTextStream>
-#include <QProcess>
 #include <QDir>
 #include <QDebug>
-#include <QRegularExpression>
 #include <QVariantList>
 #include <QVariantMap>
 #include <QStandardPaths>
 #include <QDateTime>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QUrl>
 #include <QStringConverter>
 #include <algorithm>
+#include <optional>
+#include <cstring>
 
 
 SqliteDbManager::SqliteDbManager(QObject* parent)
     : QObject(parent), m_is_connected_(false) {
+    // 异步查询多为读操作，各线程有独立的读连接，少量线程即可避免一个慢查询阻塞其他请求
+    m_db_pool_.setMaxThreadCount(qBound(2, QThread::idealThreadCount() / 2, 4));
+    
+    // 写连接在专用线程上打开和使用：GUI线程、导入线程和线程池都可能修改目录，
+    // 不占用导入线程，长时间导入期间GUI上的删除归档等操作也不需要排在导入之后
+    m_writer_thread_ = std::make_unique<QThread>();
+    m_writer_thread_->setObjectName("SqliteWriterThread");
+    m_writer_context_ = std::make_unique<QObject>();
+    m_writer_context_->moveToThread(m_writer_thread_.get());
+    m_writer_thread_->start();
 }
 
 SqliteDbManager::~SqliteDbManager() {
+    m_db_pool_.clear();
+    m_db_pool_.waitForDone();
     DisconnectDatabase();
+    m_writer_thread_->quit();
+    m_writer_thread_->wait();
+}
+
+SqliteDbManager::ArchiveConnection::~ArchiveConnection() {
+    if (!owned) {
+        return;
+    }
+    // 语句必须先于连接释放
+    statements.clear();
+    database.close();
+    database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(name);
 }
 
 bool SqliteDbManager::InitializeDatabase(const QString& db_path) {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return InitializeDatabase(db_path); });
+    }
     QMutexLocker locker(&m_mutex_);
     
     // 设置数据库路径
-    if (db_path.isEmpty()) {
+    QString path = db_path;
+    if (path.isEmpty()) {
         // 默认在用户文档目录创建数据库
         QString docs_path = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
-        m_database_path_ = docs_path + "/log_analyzer_data.db";
-    } else {
-        m_database_path_ = db_path;
+        path = docs_path + "/log_analyzer_data.db";
+    }
+    // 切换到其他数据库：先关闭当前连接，离开临时会话时删除其目录
+    if (m_is_connected_ && path != DatabasePath()) {
+        DisconnectDatabase();
+    }
+    if (m_ephemeral_dir_ && !path.startsWith(m_ephemeral_dir_->path() + "/")) {
+        m_ephemeral_dir_.reset();
+    }
+    {
+        QMutexLocker scope_locker(&m_scope_mutex_);
+        m_database_path_ = path;
+        m_active_archives_.clear();
     }
     
-    qDebug() << "初始化数据库，路径：" << m_database_path_;
+    qDebug() << "初始化数据库，路径：" << path;
     
     // 连接数据库
     if (!ConnectDatabase()) {
@@ -59,44 +105,493 @@ bool SqliteDbManager::InitializeDatabase(const QString& db_path) {
         return false;
     }
     
-    qDebug() << "数据库初始化成功";
+    if (!MigrateLegacyTables()) {
+        DisconnectDatabase();
+        return false;
+    }
+    
+    // 默认以最近导入的归档作为活动归档
+    QSqlQuery query(m_writer_.database);
+    if (query.exec("SELECT id FROM archives WHERE fingerprint <> '' ORDER BY import_time DESC, id DESC LIMIT 1") &&
+        query.next()) {
+        QMutexLocker scope_locker(&m_scope_mutex_);
+        m_active_archives_ = { query.value(0).toInt() };
+    }
+    
+    qDebug() << "数据库初始化成功，活动归档：" << ActiveArchives();
+    return true;
+}
+
+bool SqliteDbManager::InitializeEphemeralDatabase() {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return InitializeEphemeralDatabase(); });
+    }
+    QMutexLocker locker(&m_mutex_);
+    
+    QFileInfo shm_info("/dev/shm");
+    QString base = shm_info.isDir() && shm_info.isWritable()
+                       ? shm_info.absoluteFilePath()
+                       : QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    auto dir = std::make_unique<QTemporaryDir>(base + "/log_analyzer_XXXXXX");
+    if (!dir->isValid()) {
+        qCritical() << "无法创建临时会话目录：" << dir->errorString();
+        return false;
+    }
+    QString path = dir->filePath("log_analyzer_session.db");
+    
+    // 先关闭旧连接，再替换（并删除）之前的临时目录
+    DisconnectDatabase();
+    m_ephemeral_dir_ = std::move(dir);
+    if (!InitializeDatabase(path)) {
+        m_ephemeral_dir_.reset();
+        return false;
+    }
+    qDebug() << "临时会话已启动：" << path;
+    return true;
+}
+
+bool SqliteDbManager::IsEphemeral() const {
+    QMutexLocker locker(&m_mutex_);
+    return m_ephemeral_dir_ != nullptr;
+}
+
+bool SqliteDbManager::PersistSession(const QString& db_path) {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return PersistSession(db_path); });
+    }
+    QMutexLocker locker(&m_mutex_);
+    
+    if (!m_is_connected_) {
+        return false;
+    }
+    QFileInfo target(db_path);
+    if (target.exists()) {
+        qCritical() << "保存目标已存在：" << db_path;
+        return false;
+    }
+    QDir archive_dir(target.absolutePath() + "/archives");
+    if (!archive_dir.exists() && !archive_dir.mkpath(".")) {
+        qCritical() << "无法创建归档目录：" << archive_dir.absolutePath();
+        return false;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    
+    // VACUUM INTO在一个读事务内把schema写成紧凑的新数据库，效果同在线备份：
+    // 源库不加写锁，读连接不受影响；目录库只在写线程上修改，快照期间不会变化
+    QStringList written;
+    auto snapshot = [this, &written](const QString& schema, const QString& file) {
+        QSqlQuery query(m_writer_.database);
+        if (!query.exec(QString("VACUUM %1 INTO '%2'").arg(schema, QString(file).replace('\'', "''")))) {
+            qCritical() << "保存快照失败：" << file << query.lastError().text();
+            return false;
+        }
+        written << file;
+        return true;
+    };
+    auto discard = [&written]() {
+        for (const QString& file : written) {
+            QFile::remove(file);
+        }
+    };
+    
+    // 正在导入（指纹为空）的归档不保存
+    QHash<int, QString> archive_files;
+    for (const DbArchiveInfo& info : ReadArchives(m_writer_.database)) {
+        if (info.fingerprint.isEmpty()) {
+            continue;
+        }
+        QString schema = EnsureAttached(m_writer_, info.id);
+        QString file = archive_dir.absoluteFilePath(
+            QString("%1_arc_%2.db").arg(target.completeBaseName()).arg(info.id));
+        if (schema.isEmpty() || !snapshot(schema, file)) {
+            discard();
+            return false;
+        }
+        archive_files.insert(info.id, file);
+    }
+    if (!snapshot("main", target.absoluteFilePath())) {
+        discard();
+        return false;
+    }
+    
+    // 快照中的归档记录改为指向新文件，未完成的记录删除
+    bool ok = false;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "PersistSessionConnection");
+        database.setDatabaseName(target.absoluteFilePath());
+        if (database.open() && database.transaction()) {
+            QSqlQuery query(database);
+            ok = query.exec("DELETE FROM archives WHERE fingerprint = ''");
+            query.prepare("UPDATE archives SET db_file = ? WHERE id = ?");
+            for (auto it = archive_files.cbegin(); ok && it != archive_files.cend(); ++it) {
+                query.addBindValue(it.value());
+                query.addBindValue(it.key());
+                ok = query.exec();
+            }
+            if (!ok) {
+                qCritical() << "更新快照归档记录失败：" << query.lastError().text();
+            }
+            query.finish();
+            ok = ok && database.commit();
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase("PersistSessionConnection");
+    if (!ok) {
+        discard();
+        return false;
+    }
+    
+    qDebug() << "会话已保存：" << target.absoluteFilePath() << "归档数:" << archive_files.size()
+             << "耗时" << timer.elapsed() << "ms";
     return true;
 }
 
 bool SqliteDbManager::ConnectDatabase() {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return ConnectDatabase(); });
+    }
     if (m_is_connected_) {
         return true;
     }
     
-    // 创建SQLite连接
-    m_database_ = QSqlDatabase::addDatabase("QSQLITE", k_connection_name_);
-    m_database_.setDatabaseName(m_database_path_);
+    // 创建SQLite写连接
+    m_writer_.name = k_connection_name_;
+    m_writer_.database = QSqlDatabase::addDatabase("QSQLITE", k_connection_name_);
+    m_writer_.database.setDatabaseName(DatabasePath());
+    // 导入线程通过独立连接写归档文件，写冲突时等待锁释放而不是立即返回SQLITE_BUSY
+    m_writer_.database.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
     
-    if (!m_database_.open()) {
-        qCritical() << "无法打开数据库：" << m_database_.lastError().text();
-        emit databaseError(m_database_.lastError().text());
+    if (!m_writer_.database.open()) {
+        qCritical() << "无法打开数据库：" << m_writer_.database.lastError().text();
+        emit databaseError(m_writer_.database.lastError().text());
         return false;
     }
     
-    // 设置SQLite优化参数
-    QSqlQuery query(m_database_);
+    // 设置SQLite优化参数（WAL模式由写连接设置，读连接沿用）
+    ApplyConnectionPragmas(m_writer_.database);
+    
+    m_is_connected_ = true;
+    ++m_generation_;
+    qDebug() << "数据库连接成功";
+    return true;
+}
+
+void SqliteDbManager::ApplyConnectionPragmas(QSqlDatabase& database) {
+    QSqlQuery query(database);
     query.exec("PRAGMA journal_mode = WAL");       // 启用WAL模式，提高并发性能
     query.exec("PRAGMA synchronous = NORMAL");     // 平衡性能和安全性
     query.exec("PRAGMA cache_size = 10000");       // 增加缓存大小
     query.exec("PRAGMA temp_store = MEMORY");      // 临时表存储在内存
+}
+
+QSqlDatabase SqliteDbManager::OpenArchiveConnection(const QString& db_file, const QString& connection_name) {
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connection_name);
+    database.setDatabaseName(db_file);
+    // 与主连接并发访问时等待锁释放，而不是立即返回SQLITE_BUSY
+    database.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
     
-    m_is_connected_ = true;
-    qDebug() << "数据库连接成功";
+    if (!database.open()) {
+        qCritical() << "无法打开归档数据库：" << db_file << database.lastError().text();
+        return database;
+    }
+    
+    ApplyConnectionPragmas(database);
+    if (!CreateArchiveSchema(database)) {
+        database.close();
+    }
+    return database;
+}
+
+bool SqliteDbManager::CreateArchiveSchema(QSqlDatabase& database, const QString& schema) {
+    QSqlQuery query(database);
+    if (!query.exec(QString("PRAGMA %1.user_version").arg(schema)) || !query.next()) {
+        qCritical() << "读取归档版本失败：" << query.lastError().text();
+        return false;
+    }
+    
+    int version = query.value(0).toInt();
+    if (version == k_archive_schema_version_) {
+        return true;
+    }
+    if (version > k_archive_schema_version_) {
+        qCritical() << "归档数据库版本" << version << "高于程序支持的版本" << k_archive_schema_version_;
+        return false;
+    }
+    query.finish();
+    
+    QStringList statements;
+    if (version == 0) {
+        statements << QString(R"(
+            CREATE TABLE IF NOT EXISTS %1.files (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                file_path TEXT NOT NULL,
+                file_name TEXT NOT NULL,
+                keyword TEXT NOT NULL,
+                category TEXT,
+                file_size INTEGER,
+                zip_source TEXT,
+                import_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                line_count INTEGER DEFAULT 0,
+                entry_fingerprint TEXT,
+                content_hash TEXT,
+                error_count INTEGER NOT NULL DEFAULT 0,
+                warning_count INTEGER NOT NULL DEFAULT 0,
+                UNIQUE(file_path, zip_source)
+            )
+        )").arg(schema)
+        // 文件内容块表：按换行边界切分的UTF-8数据，每块独立压缩（codec），raw_size为解压后字节数
+                   << QString(R"(
+            CREATE TABLE IF NOT EXISTS %1.file_chunks (
+                file_id INTEGER NOT NULL,
+                chunk_no INTEGER NOT NULL,
+                first_line INTEGER NOT NULL,
+                line_count INTEGER NOT NULL,
+                data BLOB,
+                codec INTEGER NOT NULL DEFAULT 0,
+                raw_size INTEGER,
+                PRIMARY KEY(file_id, chunk_no)
+            )
+        )").arg(schema)
+                   << QString(k_create_keyword_files_sql_).arg(schema)
+                   << QString(k_create_line_times_sql_).arg(schema)
+                   << QString(k_create_keyword_stats_sql_).arg(schema);
+        for (const SecondaryIndex& index : k_secondary_indexes_) {
+            statements << QString("CREATE INDEX IF NOT EXISTS %1.%2 ON %3").arg(schema, index.name, index.columns);
+        }
+    } else {
+        qDebug() << "升级归档表结构：" << schema << version << "->" << k_archive_schema_version_;
+        if (version < 2) {
+            // 版本1的内容块均未压缩，保留原数据，之后写入的块才压缩
+            statements << QString("ALTER TABLE %1.file_chunks ADD COLUMN codec INTEGER NOT NULL DEFAULT 0").arg(schema)
+                       << QString("ALTER TABLE %1.file_chunks ADD COLUMN raw_size INTEGER").arg(schema)
+                       << QString("UPDATE %1.file_chunks SET raw_size = length(data)").arg(schema);
+        }
+        if (version < 3) {
+            // 行号索引：块按(file_id, first_line)定位，关键字合并文本按keyword_files定位到文件
+            statements << QString("CREATE INDEX IF NOT EXISTS %1.idx_chunk_lines ON file_chunks(file_id, first_line)").arg(schema)
+                       << QString(k_create_keyword_files_sql_).arg(schema)
+                       << QString("CREATE INDEX IF NOT EXISTS %1.idx_keyword_lines ON keyword_files(keyword, first_line)").arg(schema)
+                       << QString("CREATE INDEX IF NOT EXISTS %1.idx_keyword_files_file ON keyword_files(file_id)").arg(schema)
+                       << QString(k_rebuild_keyword_files_sql_[0]).arg(schema)
+                       << QString(k_rebuild_keyword_files_sql_[1]).arg(schema);
+        }
+        if (version < 4) {
+            // 时间索引：表建好后由BackfillChunkIndexes为已有内容补建
+            statements << QString(k_create_line_times_sql_).arg(schema)
+                       << QString("CREATE INDEX IF NOT EXISTS %1.idx_line_times_max ON line_times(file_id, max_ts)").arg(schema);
+        }
+        if (version < 6) {
+            // 级别统计由BackfillChunkIndexes补算，keyword_stats在补算之后重建
+            statements << QString("ALTER TABLE %1.files ADD COLUMN error_count INTEGER NOT NULL DEFAULT 0").arg(schema)
+                       << QString("ALTER TABLE %1.files ADD COLUMN warning_count INTEGER NOT NULL DEFAULT 0").arg(schema)
+                       << QString(k_create_keyword_stats_sql_).arg(schema);
+        }
+    }
+    
+    for (const QString& statement : statements) {
+        if (!query.exec(statement)) {
+            qCritical() << "创建归档表结构失败：" << query.lastError().text();
+            return false;
+        }
+    }
+    
+    // 行级全文索引依赖SQLite的FTS5/trigram支持，不可用时不影响其他功能
+    bool fts_created = version < 5 && CreateLineFts(database, schema);
+    if (version > 0 && version < 6) {
+        if (!BackfillChunkIndexes(database, schema, version < 4, fts_created, true) ||
+            !RebuildKeywordIndex(database, schema)) {
+            return false;
+        }
+    }
+    // 版本号最后写入，升级中途失败时下次会重新升级
+    if (!query.exec(QString("PRAGMA %1.user_version = %2").arg(schema).arg(k_archive_schema_version_))) {
+        qCritical() << "写入归档版本失败：" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool SqliteDbManager::DropSecondaryIndexes(QSqlDatabase& database, const QString& schema) {
+    QSqlQuery query(database);
+    for (const SecondaryIndex& index : k_secondary_indexes_) {
+        if (!query.exec(QString("DROP INDEX IF EXISTS %1.%2").arg(schema, index.name))) {
+            qCritical() << "删除索引失败：" << index.name << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SqliteDbManager::CreateSecondaryIndexes(QSqlDatabase& database, const QString& schema) {
+    QSqlQuery query(database);
+    for (const SecondaryIndex& index : k_secondary_indexes_) {
+        QElapsedTimer timer;
+        timer.start();
+        if (!query.exec(QString("CREATE INDEX IF NOT EXISTS %1.%2 ON %3").arg(schema, index.name, index.columns))) {
+            qCritical() << "创建索引失败：" << index.name << query.lastError().text();
+            return false;
+        }
+        qDebug() << "重建索引" << index.name << "耗时" << timer.elapsed() << "ms";
+    }
+    return true;
+}
+
+bool SqliteDbManager::CreateLineFts(QSqlDatabase& database, const QString& schema) {
+    QSqlQuery query(database);
+    // contentless_delete（SQLite 3.43+）允许直接按rowid删除，旧版本删除时需要提供原文
+    if (query.exec(QString("CREATE VIRTUAL TABLE IF NOT EXISTS %1.line_fts USING fts5("
+                           "text, content='', tokenize='trigram', contentless_delete=1)").arg(schema)) ||
+        query.exec(QString("CREATE VIRTUAL TABLE IF NOT EXISTS %1.line_fts USING fts5("
+                           "text, content='', tokenize='trigram')").arg(schema))) {
+        return true;
+    }
+    qWarning() << "当前SQLite不支持FTS5 trigram，搜索将逐块扫描：" << query.lastError().text();
+    return false;
+}
+
+bool SqliteDbManager::HasLineFts(QSqlDatabase& database, const QString& schema) {
+    QSqlQuery query(database);
+    return query.exec(QString("SELECT 1 FROM %1.sqlite_master WHERE type = 'table' AND name = 'line_fts'").arg(schema)) &&
+           query.next();
+}
+
+bool SqliteDbManager::IndexChunkLines(QSqlQuery& query, qint64 file_id, qint64 first_line, const QByteArray& data) {
+    const QString text = Utf8Codec::Decode(data);
+    qint64 line = first_line;
+    qsizetype start = 0;
+    while (start < text.size()) {
+        qsizetype end = text.indexOf('\n', start);
+        if (end < 0) {
+            end = text.size();
+        }
+        // 空行不会被搜索命中，不写入
+        if (end - start >= 3) {
+            query.addBindValue(LineRowId(file_id, line));
+            query.addBindValue(text.mid(start, end - start));
+            if (!query.exec()) {
+                return false;
+            }
+        }
+        ++line;
+        start = end + 1;
+    }
+    return true;
+}
+
+bool SqliteDbManager::DeleteLineFts(QSqlDatabase& database, qint64 file_id) {
+    QSqlQuery query(database);
+    query.prepare("DELETE FROM line_fts WHERE rowid BETWEEN ? AND ?");
+    query.addBindValue(LineRowId(file_id, 0));
+    query.addBindValue(LineRowId(file_id, 0xFFFFFFFFLL));
+    if (query.exec()) {
+        return true;
+    }
+    
+    // 旧版contentless表：逐行提交原文删除
+    QSqlQuery chunk_query(database);
+    chunk_query.prepare("SELECT data, codec, first_line FROM file_chunks WHERE file_id = ? ORDER BY chunk_no");
+    chunk_query.addBindValue(file_id);
+    QSqlQuery delete_query(database);
+    if (!chunk_query.exec() ||
+        !delete_query.prepare("INSERT INTO line_fts (line_fts, rowid, text) VALUES ('delete', ?, ?)")) {
+        qCritical() << "删除全文索引失败：" << chunk_query.lastError().text() << delete_query.lastError().text();
+        return false;
+    }
+    while (chunk_query.next()) {
+        QByteArray data = DecompressChunk(chunk_query.value(0).toByteArray(), chunk_query.value(1).toInt());
+        if (!IndexChunkLines(delete_query, file_id, chunk_query.value(2).toLongLong(), data)) {
+            qCritical() << "删除全文索引失败：" << delete_query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SqliteDbManager::BackfillChunkIndexes(QSqlDatabase& database, const QString& schema, bool line_times, bool line_fts,
+                                           bool severity) {
+    QElapsedTimer timer;
+    timer.start();
+    
+    QSqlQuery chunk_query(database);
+    chunk_query.setForwardOnly(true);
+    QSqlQuery times_query(database);
+    QSqlQuery fts_query(database);
+    if (!chunk_query.exec(QString("SELECT file_id, chunk_no, first_line, data, codec FROM %1.file_chunks").arg(schema)) ||
+        (line_times && !times_query.prepare(QString(k_insert_line_times_sql_).arg(schema))) ||
+        (line_fts && !fts_query.prepare(QString(k_insert_line_fts_sql_).arg(schema)))) {
+        qCritical() << "补建索引失败：" << chunk_query.lastError().text() << times_query.lastError().text()
+                    << fts_query.lastError().text();
+        return false;
+    }
+    
+    bool own_transaction = database.transaction();
+    int chunks = 0;
+    QHash<qint64, LogSeverity::Counts> severities;
+    while (chunk_query.next()) {
+        qint64 file_id = chunk_query.value(0).toLongLong();
+        qint64 first_line = chunk_query.value(2).toLongLong();
+        QByteArray data = DecompressChunk(chunk_query.value(3).toByteArray(), chunk_query.value(4).toInt());
+        if ((line_times && !BindAndInsertLineTimes(times_query, file_id, chunk_query.value(1).toInt(), first_line,
+                                                   LineTimeIndex::Build(data))) ||
+            (line_fts && !IndexChunkLines(fts_query, file_id, first_line, data))) {
+            qCritical() << "补建索引失败：" << times_query.lastError().text() << fts_query.lastError().text();
+            if (own_transaction) {
+                database.rollback();
+            }
+            return false;
+        }
+        if (severity) {
+            severities[file_id] += LogSeverity::Count(data);
+        }
+        ++chunks;
+    }
+    chunk_query.finish();
+    
+    QSqlQuery severity_query(database);
+    severity_query.prepare(QString("UPDATE %1.files SET error_count = ?, warning_count = ? WHERE id = ?").arg(schema));
+    for (auto it = severities.cbegin(); it != severities.cend(); ++it) {
+        severity_query.addBindValue(it.value().errors);
+        severity_query.addBindValue(it.value().warnings);
+        severity_query.addBindValue(it.key());
+        if (!severity_query.exec()) {
+            qCritical() << "补算级别统计失败：" << severity_query.lastError().text();
+            if (own_transaction) {
+                database.rollback();
+            }
+            return false;
+        }
+    }
+    if (own_transaction && !database.commit()) {
+        qCritical() << "补建索引提交失败：" << database.lastError().text();
+        return false;
+    }
+    
+    qDebug() << "已为" << schema << "补建索引，时间:" << line_times << "全文:" << line_fts << "级别:" << severity
+             << "内容块:" << chunks << "耗时:" << timer.elapsed() << "ms";
     return true;
 }
 
 void SqliteDbManager::DisconnectDatabase() {
+    if (!OnWriterThread()) {
+        ReleaseLocalReader();
+        RunOnWriter([this]() { DisconnectDatabase(); });
+        return;
+    }
     QMutexLocker locker(&m_mutex_);
     
     if (m_is_connected_) {
-        m_database_.close();
-        QSqlDatabase::removeDatabase(k_connection_name_);
         m_is_connected_ = false;
+        ++m_generation_;
+        // 调用线程和写线程的读连接立即释放；其他线程的读连接在下次使用或线程退出时释放
+        ReleaseLocalReader();
+        m_writer_.statements.clear();
+        m_writer_.database.close();
+        m_writer_.database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(k_connection_name_);
+        m_writer_.attached.clear();
         qDebug() << "数据库连接已关闭";
     }
 }
@@ -105,25 +600,74 @@ bool SqliteDbManager::IsConnected() const {
     return m_is_connected_;
 }
 
+QString SqliteDbManager::DatabasePath() const {
+    QMutexLocker scope_locker(&m_scope_mutex_);
+    return m_database_path_;
+}
+
+void SqliteDbManager::ReleaseLocalReader() {
+    if (m_readers_.hasLocalData()) {
+        m_readers_.setLocalData(nullptr);
+    }
+}
+
+SqliteDbManager::ArchiveConnection& SqliteDbManager::Reader() {
+    static std::atomic<int> s_reader_count{0};
+    
+    const quint64 generation = m_generation_;
+    ArchiveConnection* reader = m_readers_.hasLocalData() ? m_readers_.localData() : nullptr;
+    if (reader && reader->generation == generation) {
+        return *reader;
+    }
+    
+    // 过期的连接（重新连接或有归档被删除）整体丢弃，其ATTACH随连接一起释放
+    reader = new ArchiveConnection;
+    reader->owned = true;
+    reader->generation = generation;
+    reader->name = QString("%1_reader_%2").arg(k_connection_name_).arg(++s_reader_count);
+    m_readers_.setLocalData(reader);
+    
+    if (!m_is_connected_) {
+        return *reader;
+    }
+    
+    reader->database = QSqlDatabase::addDatabase("QSQLITE", reader->name);
+    reader->database.setDatabaseName(DatabasePath());
+    reader->database.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+    if (!reader->database.open()) {
+        qCritical() << "无法打开读连接：" << reader->database.lastError().text();
+        return *reader;
+    }
+    
+    QSqlQuery query(reader->database);
+    query.exec("PRAGMA cache_size = 10000");
+    query.exec("PRAGMA temp_store = MEMORY");
+    qDebug() << "打开读连接：" << reader->name << QThread::currentThread();
+    return *reader;
+}
+
 bool SqliteDbManager::CreateTables() {
-    // 创建文件表
-    QString create_files_table = R"(
-        CREATE TABLE IF NOT EXISTS files (
+    // 工作区目录：每个归档一行，内容存放在db_file指向的独立数据库中
+    QString create_archives_table = R"(
+        CREATE TABLE IF NOT EXISTS archives (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
-            file_path TEXT NOT NULL,
-            file_name TEXT NOT NULL,
-            keyword TEXT NOT NULL,
-            category TEXT,
-            content TEXT,
-            file_size INTEGER,
-            zip_source TEXT,
+            zip_source TEXT NOT NULL,
+            fingerprint TEXT NOT NULL,
+            archive_size INTEGER,
             import_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-            UNIQUE(file_path, zip_source)
+            db_file TEXT,
+            source_path TEXT
         )
     )";
     
-    if (!ExecuteQuery(create_files_table)) {
-        qCritical() << "创建files表失败";
+    if (!ExecuteQuery(create_archives_table)) {
+        qCritical() << "创建archives表失败";
+        return false;
+    }
+    
+    // 旧版本数据库缺少的列
+    if (!EnsureColumn("archives", "db_file", "TEXT") ||
+        !EnsureColumn("archives", "source_path", "TEXT")) {
         return false;
     }
     
@@ -147,198 +691,1123 @@ bool SqliteDbManager::CreateTables() {
 }
 
 bool SqliteDbManager::CreateIndexes() {
-    // 创建关键字索引
-    ExecuteQuery("CREATE INDEX IF NOT EXISTS idx_keyword ON files(keyword)");
-    
-    // 创建类别索引
-    ExecuteQuery("CREATE INDEX IF NOT EXISTS idx_category ON files(category)");
-    
-    // 创建ZIP源索引
-    ExecuteQuery("CREATE INDEX IF NOT EXISTS idx_zip_source ON files(zip_source)");
-    
-    // 创建全文搜索索引（使用FTS5）
-    QString create_fts = R"(
-        CREATE VIRTUAL TABLE IF NOT EXISTS files_fts USING fts5(
-            file_name, 
-            content,
-            content=files,
-            content_rowid=id
-        )
-    )";
-    
-    if (!ExecuteQuery(create_fts)) {
-        qWarning() << "创建全文搜索索引失败（可能不支持FTS5）";
-        // 不是致命错误，可以继续使用LIKE搜索
-    }
+    ExecuteQuery("CREATE INDEX IF NOT EXISTS idx_archive_source ON archives(zip_source)");
+    ExecuteQuery("CREATE INDEX IF NOT EXISTS idx_archive_source_path ON archives(source_path)");
     
     qDebug() << "数据库索引创建成功";
     return true;
 }
 
-bool SqliteDbManager::ExecuteQuery(const QString& query_str) {
-    QSqlQuery query(m_database_);
-    if (!query.exec(query_str)) {
-        qCritical() << "SQL执行失败：" << query.lastError().text();
-        qCritical() << "SQL语句：" << query_str;
-        emit databaseError(query.lastError().text());
+bool SqliteDbManager::EnsureColumn(const QString& table, const QString& column, const QString& definition) {
+    QSqlQuery query(m_writer_.database);
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        qCritical() << "读取表结构失败：" << table << query.lastError().text();
         return false;
     }
-    return true;
-}
-
-QSqlQuery SqliteDbManager::PrepareQuery(const QString& query_str) {
-    QSqlQuery query(m_database_);
-    query.prepare(query_str);
-    return query;
-}
-
-bool SqliteDbManager::BeginTransaction() {
-    return m_database_.transaction();
-}
-
-bool SqliteDbManager::CommitTransaction() {
-    return m_database_.commit();
-}
-
-bool SqliteDbManager::RollbackTransaction() {
-    return m_database_.rollback();
-}
-
-bool SqliteDbManager::InsertFile(const DbFileRecord& record) {
-    QMutexLocker locker(&m_mutex_);
-    
-    QSqlQuery query = PrepareQuery(R"(
-        INSERT OR REPLACE INTO files 
-        (file_path, file_name, keyword, category, content, file_size, zip_source, import_time)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?)
-    )");
-    
-    query.addBindValue(record.file_path);
-    query.addBindValue(record.file_name);
-    query.addBindValue(record.keyword);
-    query.addBindValue(record.category);
-    query.addBindValue(record.content);
-    query.addBindValue(record.file_size);
-    query.addBindValue(record.zip_source);
-    query.addBindValue(record.import_time);
     
-    if (!query.exec()) {
-        qCritical() << "插入文件记录失败：" << query.lastError().text();
-        emit databaseError(query.lastError().text());
-        return false;
+    while (query.next()) {
+        if (query.value(1).toString() == column) {
+            return true;
+        }
     }
     
-    return true;
+    qDebug() << "为表" << table << "添加列" << column;
+    return ExecuteQuery(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition));
 }
 
-bool SqliteDbManager::InsertFiles(const QList<DbFileRecord>& records) {
-    QMutexLocker locker(&m_mutex_);
-    
-    if (!BeginTransaction()) {
+bool SqliteDbManager::MigrateLegacyTables() {
+    // 旧版本把文件表放在主库中：整体迁入一个独立的归档文件
+    QSqlQuery query(m_writer_.database);
+    if (!query.exec("SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'files'")) {
+        qCritical() << "检查旧表失败：" << query.lastError().text();
         return false;
     }
+    bool has_legacy_files = query.next();
+    query.finish();
     
-    QSqlQuery query = PrepareQuery(R"(
-        INSERT OR REPLACE INTO files 
-        (file_path, file_name, keyword, category, content, file_size, zip_source, import_time)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?)
-    )");
-    
-    int progress = 0;
-    int total = records.size();
-    
-    for (const auto& record : records) {
-        query.addBindValue(record.file_path);
-        query.addBindValue(record.file_name);
-        query.addBindValue(record.keyword);
-        query.addBindValue(record.category);
-        query.addBindValue(record.content);
-        query.addBindValue(record.file_size);
-        query.addBindValue(record.zip_source);
-        query.addBindValue(record.import_time);
-        
-        if (!query.exec()) {
-            qCritical() << "批量插入失败：" << query.lastError().text();
-            RollbackTransaction();
-            return false;
-        }
-        
-        progress++;
-        if (progress % 10 == 0) {
-            emit progressUpdate((progress * 100) / total);
-        }
+    if (!has_legacy_files) {
+        // 没有db_file的归档行来自旧版本的单归档记录，已无对应内容
+        return ExecuteQuery("DELETE FROM archives WHERE db_file IS NULL");
     }
     
-    if (!CommitTransaction()) {
+    if (!EnsureColumn("files", "content", "TEXT") ||
+        !EnsureColumn("files", "line_count", "INTEGER DEFAULT 0") ||
+        !EnsureColumn("files", "entry_fingerprint", "TEXT") ||
+        !EnsureColumn("files", "content_hash", "TEXT")) {
         return false;
     }
     
-    emit progressUpdate(100);
-    qDebug() << "成功插入" << records.size() << "条文件记录";
-    return true;
-}
-
-bool SqliteDbManager::DeleteAllFiles() {
-    QMutexLocker locker(&m_mutex_);
-    
-    QSqlQuery query = PrepareQuery("DELETE FROM files");
+    bool has_chunks = query.exec("SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'file_chunks'") && query.next();
+    query.finish();
     
-    if (!query.exec()) {
-        qCritical() << "删除所有文件记录失败：" << query.lastError().text();
-        return false;
+    QString zip_source = "legacy";
+    QString fingerprint;
+    if (query.exec("SELECT zip_source FROM files LIMIT 1") && query.next()) {
+        zip_source = query.value(0).toString();
+    }
+    query.finish();
+    if (query.exec("SELECT fingerprint FROM archives WHERE db_file IS NULL ORDER BY id DESC LIMIT 1") && query.next()) {
+        fingerprint = query.value(0).toString();
+    }
+    query.finish();
+    if (fingerprint.isEmpty()) {
+        // 空指纹表示未完成导入，迁移来的数据是完整的
+        fingerprint = "legacy";
     }
     
-    qDebug() << "删除了" << query.numRowsAffected() << "条记录";
+    qDebug() << "迁移旧版文件表到独立归档：" << zip_source;
     
-    // 重置自增ID
-    QSqlQuery reset_sequence_query = PrepareQuery("DELETE FROM sqlite_sequence WHERE name='files'");
-    if (!reset_sequence_query.exec()) {
-        qWarning() << "重置sqlite_sequence失败：" << reset_sequence_query.lastError().text();
+    // 先在独立连接上建好归档表结构（m_mutex_可重入，CreateArchive等可在此调用）
+    int archive_id = CreateArchive(zip_source);
+    if (archive_id == 0) {
+        return false;
+    }
+    QString db_file = ReadArchives(m_writer_.database, archive_id).value(0).db_file;
+    {
+        QSqlDatabase archive_db = OpenArchiveConnection(db_file, "LegacyMigrationConnection");
+        bool ok = archive_db.isOpen();
+        archive_db.close();
+        if (!ok) {
+            QSqlDatabase::removeDatabase("LegacyMigrationConnection");
+            return false;
+        }
+    }
+    QSqlDatabase::removeDatabase("LegacyMigrationConnection");
+    
+    QString schema = EnsureAttached(m_writer_, archive_id);
+    if (schema.isEmpty()) {
+        return false;
+    }
+    
+    if (!BeginTransaction()) {
+        return false;
+    }
+    
+    QStringList statements = {
+        QString(R"(
+            INSERT INTO %1.files (id, file_path, file_name, keyword, category, file_size, zip_source,
+                                  import_time, line_count, entry_fingerprint, content_hash)
+            SELECT id, file_path, file_name, keyword, category, file_size, zip_source,
+                   import_time, line_count, entry_fingerprint, content_hash
+            FROM main.files
+        )").arg(schema),
+        // 更早的版本把整个文件内容存放在files.content中，迁移为单个内容块；
+        // 这些版本的line_count由EnsureColumn补上、默认为0，行数按内容重新数
+        QString(R"(
+            INSERT OR REPLACE INTO %1.file_chunks (file_id, chunk_no, first_line, line_count, data, raw_size)
+            SELECT id, 0, 0,
+                   length(content) - length(replace(content, char(10), '')) +
+                       (CASE WHEN content <> '' AND substr(content, -1) <> char(10) THEN 1 ELSE 0 END),
+                   CAST(content AS BLOB), length(CAST(content AS BLOB))
+            FROM main.files WHERE content IS NOT NULL
+        )").arg(schema)
+    };
+    if (has_chunks) {
+        statements << QString(R"(
+            INSERT OR REPLACE INTO %1.file_chunks (file_id, chunk_no, first_line, line_count, data, raw_size)
+            SELECT file_id, chunk_no, first_line, line_count, data, length(data) FROM main.file_chunks
+        )").arg(schema)
+                   << "DROP TABLE main.file_chunks";
+    }
+    // 文件行数以内容块为准，keyword_files按它计算各文件的起始行
+    statements << QString(R"(
+        UPDATE %1.files SET line_count =
+            (SELECT COALESCE(SUM(line_count), 0) FROM %1.file_chunks WHERE file_id = files.id)
+    )").arg(schema);
+    
+    // 关键字索引和统计在补建时间索引、全文索引和级别统计之后重建
+    QStringList finish_statements;
+    for (const char* statement : k_rebuild_keyword_files_sql_) {
+        finish_statements << QString(statement).arg(schema);
+    }
+    for (const char* statement : k_rebuild_keyword_stats_sql_) {
+        finish_statements << QString(statement).arg(schema);
+    }
+    finish_statements << "DROP TABLE IF EXISTS main.files_fts"
+                      << "DROP TABLE main.files"
+                      << "DELETE FROM archives WHERE db_file IS NULL";
+    finish_statements << QString("UPDATE archives SET fingerprint = '%1' WHERE id = %2").arg(fingerprint).arg(archive_id);
+    
+    for (const QString& statement : statements) {
+        if (!ExecuteQuery(statement)) {
+            RollbackTransaction();
+            return false;
+        }
+    }
+    // 迁移来的内容块没有line_times、line_fts和级别统计，否则搜索经全文索引时找不到任何行，
+    // 时间查询和统计面板也为空
+    if (!BackfillChunkIndexes(m_writer_.database, schema, true, HasLineFts(m_writer_.database, schema), true)) {
+        RollbackTransaction();
+        return false;
+    }
+    for (const QString& statement : finish_statements) {
+        if (!ExecuteQuery(statement)) {
+            RollbackTransaction();
+            return false;
+        }
+    }
+    
+    return CommitTransaction();
+}
+
+QString SqliteDbManager::EnsureAttached(ArchiveConnection& connection, int archive_id) {
+    QString schema = SchemaName(archive_id);
+    
+    int index = connection.attached.indexOf(archive_id);
+    if (index >= 0) {
+        // 移到最近使用位置
+        connection.attached.move(index, connection.attached.size() - 1);
+        return schema;
+    }
+    
+    // 超过上限时淘汰最久未使用的归档
+    while (connection.attached.size() >= k_max_attached_archives_) {
+        DetachArchive(connection, connection.attached.first());
+    }
+    
+    QSqlQuery query(connection.database);
+    if (!query.exec(QString("SELECT db_file FROM archives WHERE id = %1").arg(archive_id)) || !query.next()) {
+        qWarning() << "归档不存在：" << archive_id;
+        return QString();
+    }
+    QString db_file = query.value(0).toString();
+    query.finish();
+    
+    query.prepare(QString("ATTACH DATABASE ? AS %1").arg(schema));
+    query.addBindValue(db_file);
+    if (!query.exec()) {
+        qCritical() << "ATTACH归档失败：" << db_file << query.lastError().text();
+        return QString();
+    }
+    
+    // 校验归档表结构版本：旧版本就地升级，更高版本的归档不参与查询
+    bool compatible = false;
+    if (!connection.owned) {
+        compatible = CreateArchiveSchema(connection.database, schema);
+    } else {
+        // 读连接不能写，旧版本归档先DETACH，经临时写连接升级后重新ATTACH
+        int version = -1;
+        if (query.exec(QString("PRAGMA %1.user_version").arg(schema)) && query.next()) {
+            version = query.value(0).toInt();
+        }
+        query.finish();
+        compatible = version == k_archive_schema_version_;
+        if (version >= 0 && version < k_archive_schema_version_) {
+            query.exec(QString("DETACH DATABASE %1").arg(schema));
+            query.prepare(QString("ATTACH DATABASE ? AS %1").arg(schema));
+            query.addBindValue(db_file);
+            compatible = UpgradeArchive(db_file, schema) && query.exec();
+            if (!compatible) {
+                return QString();
+            }
+        }
+    }
+    if (!compatible) {
+        qWarning() << "归档版本不兼容，跳过：" << db_file;
+        query.exec(QString("DETACH DATABASE %1").arg(schema));
+        return QString();
+    }
+    
+    connection.attached.append(archive_id);
+    return schema;
+}
+
+bool SqliteDbManager::UpgradeArchive(const QString& db_file, const QString& schema) {
+    QMutexLocker locker(&m_mutex_);
+    
+    const QString connection_name = QString("%1_upgrade_%2").arg(k_connection_name_, schema);
+    bool upgraded = false;
+    {
+        QSqlDatabase database = OpenArchiveConnection(db_file, connection_name);
+        upgraded = database.isOpen();
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+    
+    if (!upgraded) {
+        qWarning() << "升级归档失败：" << db_file;
+    }
+    return upgraded;
+}
+
+void SqliteDbManager::DetachArchive(ArchiveConnection& connection, int archive_id) {
+    if (!connection.attached.removeOne(archive_id)) {
+        return;
+    }
+    
+    // 先释放引用该归档的缓存语句，否则DETACH会因语句未结束而失败
+    const QString prefix = SchemaName(archive_id) + ".";
+    for (auto it = connection.statements.begin(); it != connection.statements.end();) {
+        it = it.key().contains(prefix) ? connection.statements.erase(it) : std::next(it);
+    }
+    
+    QSqlQuery query(connection.database);
+    if (!query.exec(QString("DETACH DATABASE %1").arg(SchemaName(archive_id)))) {
+        qWarning() << "DETACH归档失败：" << archive_id << query.lastError().text();
+    }
+}
+
+QList<int> SqliteDbManager::ResolveScope(const QList<int>& archive_ids) const {
+    if (!archive_ids.isEmpty()) {
+        return archive_ids;
+    }
+    QMutexLocker scope_locker(&m_scope_mutex_);
+    return m_active_archives_;
+}
+
+bool SqliteDbManager::ExecuteQuery(const QString& query_str) {
+    QSqlQuery query(m_writer_.database);
+    if (!query.exec(query_str)) {
+        qCritical() << "SQL执行失败：" << query.lastError().text();
+        qCritical() << "SQL语句：" << query_str;
+        emit databaseError(query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+QSqlQuery SqliteDbManager::PrepareQuery(const QString& query_str) {
+    return PrepareQuery(m_writer_.database, query_str);
+}
+
+SqliteDbManager::CachedStatement SqliteDbManager::CachedQuery(ArchiveConnection& connection, const QString& sql) {
+    std::shared_ptr<QSqlQuery> query = connection.statements.value(sql);
+    if (query) {
+        return CachedStatement(query);
+    }
+    
+    query = std::make_shared<QSqlQuery>(connection.database);
+    query->setForwardOnly(true);
+    if (!query->prepare(sql)) {
+        // 不缓存失败的语句，下次重新编译（如ATTACH之后表才存在）
+        qCritical() << "SQL预编译失败：" << query->lastError().text();
+        qCritical() << "SQL语句：" << sql;
+        return CachedStatement(query);
+    }
+    connection.statements.insert(sql, query);
+    return CachedStatement(query);
+}
+
+QSqlQuery SqliteDbManager::PrepareQuery(QSqlDatabase& database, const QString& query_str) {
+    QSqlQuery query(database);
+    // 只向前遍历：QSQLITE默认会缓存已读过的行，内容块查询时会把整个结果集留在内存中
+    query.setForwardOnly(true);
+    query.prepare(query_str);
+    return query;
+}
+
+bool SqliteDbManager::BeginTransaction() {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return BeginTransaction(); });
+    }
+    return m_writer_.database.transaction();
+}
+
+bool SqliteDbManager::CommitTransaction() {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return CommitTransaction(); });
+    }
+    return m_writer_.database.commit();
+}
+
+bool SqliteDbManager::RollbackTransaction() {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return RollbackTransaction(); });
+    }
+    return m_writer_.database.rollback();
+}
+
+QList<DbArchiveInfo> SqliteDbManager::GetArchives() {
+    return ReadArchives(Reader().database);
+}
+
+QList<DbArchiveInfo> SqliteDbManager::ReadArchives(QSqlDatabase& database, int archive_id) {
+    QList<DbArchiveInfo> archives;
+    
+    QSqlQuery query(database);
+    query.prepare(QString("SELECT id, zip_source, fingerprint, archive_size, db_file, import_time, source_path "
+                          "FROM archives %1 ORDER BY id")
+                      .arg(archive_id > 0 ? "WHERE id = ?" : ""));
+    if (archive_id > 0) {
+        query.addBindValue(archive_id);
+    }
+    if (!query.exec()) {
+        qCritical() << "查询归档失败：" << query.lastError().text();
+        return archives;
+    }
+    
+    while (query.next()) {
+        DbArchiveInfo info;
+        info.id = query.value(0).toInt();
+        info.zip_source = query.value(1).toString();
+        info.fingerprint = query.value(2).toString();
+        info.archive_size = query.value(3).toLongLong();
+        info.db_file = query.value(4).toString();
+        info.import_time = query.value(5).toDateTime();
+        info.source_path = query.value(6).toString();
+        archives.append(info);
+    }
+    return archives;
+}
+
+DbArchiveInfo SqliteDbManager::GetArchive(int archive_id) {
+    return ReadArchives(Reader().database, archive_id).value(0);
+}
+
+DbArchiveInfo SqliteDbManager::FindArchiveBySource(const QString& source_path) {
+    // 不同目录下的同名ZIP是不同的归档；旧版本只记录了文件名，同名且未记录路径时沿用
+    const QString file_name = QFileInfo(source_path).fileName();
+    DbArchiveInfo legacy;
+    for (const DbArchiveInfo& info : GetArchives()) {
+        if (info.source_path == source_path) {
+            return info;
+        }
+        if (legacy.id == 0 && info.source_path.isEmpty() && info.zip_source == file_name) {
+            legacy = info;
+        }
+    }
+    return legacy;
+}
+
+int SqliteDbManager::CreateArchive(const QString& zip_source, const QString& source_path) {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return CreateArchive(zip_source, source_path); });
+    }
+    QMutexLocker locker(&m_mutex_);
+    
+    // 指纹为空表示导入尚未完成
+    QSqlQuery query = PrepareQuery("INSERT INTO archives (zip_source, source_path, fingerprint) VALUES (?, ?, '')");
+    query.addBindValue(zip_source);
+    query.addBindValue(source_path.isEmpty() ? QVariant() : QVariant(source_path));
+    if (!query.exec()) {
+        qCritical() << "创建归档记录失败：" << query.lastError().text();
+        return 0;
+    }
+    int archive_id = query.lastInsertId().toInt();
+    
+    // 归档文件放在主库旁的archives目录中
+    QFileInfo catalog_info(DatabasePath());
+    QDir archive_dir(catalog_info.absolutePath() + "/archives");
+    if (!archive_dir.exists() && !archive_dir.mkpath(".")) {
+        qCritical() << "无法创建归档目录：" << archive_dir.absolutePath();
+        return 0;
+    }
+    QString db_file = archive_dir.absoluteFilePath(QString("%1_arc_%2.db").arg(catalog_info.completeBaseName()).arg(archive_id));
+    
+    query = PrepareQuery("UPDATE archives SET db_file = ? WHERE id = ?");
+    query.addBindValue(db_file);
+    query.addBindValue(archive_id);
+    if (!query.exec()) {
+        qCritical() << "创建归档记录失败：" << query.lastError().text();
+        return 0;
+    }
+    
+    qDebug() << "创建归档：" << archive_id << zip_source << db_file;
+    return archive_id;
+}
+
+bool SqliteDbManager::UpdateArchive(int archive_id, const QString& fingerprint, qint64 archive_size) {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return UpdateArchive(archive_id, fingerprint, archive_size); });
+    }
+    QMutexLocker locker(&m_mutex_);
+    
+    QSqlQuery query = PrepareQuery(
+        "UPDATE archives SET fingerprint = ?, archive_size = ?, import_time = CURRENT_TIMESTAMP WHERE id = ?");
+    query.addBindValue(fingerprint);
+    query.addBindValue(archive_size);
+    query.addBindValue(archive_id);
+    if (!query.exec()) {
+        qCritical() << "更新归档记录失败：" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool SqliteDbManager::SetArchiveSourcePath(int archive_id, const QString& source_path) {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return SetArchiveSourcePath(archive_id, source_path); });
+    }
+    QMutexLocker locker(&m_mutex_);
+    
+    QSqlQuery query = PrepareQuery("UPDATE archives SET source_path = ? WHERE id = ?");
+    query.addBindValue(source_path);
+    query.addBindValue(archive_id);
+    if (!query.exec()) {
+        qCritical() << "更新归档来源失败：" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool SqliteDbManager::DropArchive(int archive_id) {
+    if (!OnWriterThread()) {
+        // 调用线程的读连接先释放，否则其ATTACH会占用要删除的归档文件
+        ReleaseLocalReader();
+        return RunOnWriter([&]() { return DropArchive(archive_id); });
+    }
+    QMutexLocker locker(&m_mutex_);
+    
+    DetachArchive(m_writer_, archive_id);
+    {
+        QMutexLocker scope_locker(&m_scope_mutex_);
+        m_active_archives_.removeAll(archive_id);
+    }
+    
+    QSqlQuery query(m_writer_.database);
+    QString db_file;
+    if (query.exec(QString("SELECT db_file FROM archives WHERE id = %1").arg(archive_id)) && query.next()) {
+        db_file = query.value(0).toString();
+    }
+    query.finish();
+    
+    if (!query.exec(QString("DELETE FROM archives WHERE id = %1").arg(archive_id))) {
+        qCritical() << "删除归档记录失败：" << query.lastError().text();
+        return false;
+    }
+    
+    // 读连接在下次使用时发现版本变化，整体重新打开，从而释放对该归档的ATTACH
+    ++m_generation_;
+    ReleaseLocalReader();
+    
+    // 只删除该归档自己的文件，其他归档不受影响
+    if (!db_file.isEmpty()) {
+        RemoveArchiveFiles(db_file);
+    }
+    
+    qDebug() << "删除归档：" << archive_id << db_file;
+    return true;
+}
+
+void SqliteDbManager::RemoveArchiveFiles(const QString& db_file) {
+    QMutexLocker scope_locker(&m_scope_mutex_);
+    
+    // 其他线程的读连接可能仍打开着文件（Windows上无法删除），失败的留到下次删除归档时重试
+    QStringList files = m_pending_removals_;
+    files << db_file << db_file + "-wal" << db_file + "-shm";
+    m_pending_removals_.clear();
+    for (const QString& file : files) {
+        if (QFile::exists(file) && !QFile::remove(file)) {
+            m_pending_removals_.append(file);
+        }
+    }
+    if (!m_pending_removals_.isEmpty()) {
+        qDebug() << "归档文件仍被占用，稍后删除：" << m_pending_removals_;
+    }
+}
+
+bool SqliteDbManager::DropAllArchives() {
+    bool ok = true;
+    for (int archive_id : AllArchiveIds()) {
+        ok = DropArchive(archive_id) && ok;
+    }
+    return ok;
+}
+
+bool SqliteDbManager::SetActiveArchives(const QList<int>& archive_ids) {
+    // 在当前线程的读连接上校验归档可用，不占用写连接
+    ArchiveConnection& reader = Reader();
+    
+    QList<int> active;
+    for (int archive_id : archive_ids) {
+        if (!active.contains(archive_id) && !EnsureAttached(reader, archive_id).isEmpty()) {
+            active.append(archive_id);
+        }
+    }
+    
+    QMutexLocker scope_locker(&m_scope_mutex_);
+    m_active_archives_ = active;
+    qDebug() << "活动归档：" << m_active_archives_;
+    return active.size() == archive_ids.size();
+}
+
+QList<int> SqliteDbManager::ActiveArchives() const {
+    QMutexLocker scope_locker(&m_scope_mutex_);
+    return m_active_archives_;
+}
+
+QList<int> SqliteDbManager::AllArchiveIds() {
+    QList<int> ids;
+    for (const DbArchiveInfo& info : GetArchives()) {
+        if (!info.fingerprint.isEmpty()) {
+            ids.append(info.id);
+        }
+    }
+    return ids;
+}
+
+QHash<QString, DbEntryState> SqliteDbManager::GetEntryStates(int archive_id) {
+    ArchiveConnection& reader = Reader();
+    
+    QHash<QString, DbEntryState> states;
+    QString schema = EnsureAttached(reader, archive_id);
+    if (schema.isEmpty()) {
+        return states;
+    }
+    
+    QSqlQuery query(reader.database);
+    if (!query.exec(QString("SELECT id, file_path, entry_fingerprint FROM %1.files").arg(schema))) {
+        qCritical() << "查询条目状态失败：" << query.lastError().text();
+        return states;
+    }
+    
+    while (query.next()) {
+        DbEntryState state;
+        state.file_id = query.value(0).toLongLong();
+        state.entry_fingerprint = query.value(2).toString();
+        states.insert(query.value(1).toString(), state);
+    }
+    return states;
+}
+
+bool SqliteDbManager::BindAndInsertFile(QSqlQuery& query, const DbFileRecord& record) {
+    query.addBindValue(record.file_path);
+    query.addBindValue(record.file_name);
+    query.addBindValue(record.keyword);
+    query.addBindValue(record.category);
+    query.addBindValue(record.file_size);
+    query.addBindValue(record.zip_source);
+    query.addBindValue(record.import_time);
+    query.addBindValue(record.line_count);
+    query.addBindValue(record.entry_fingerprint);
+    query.addBindValue(record.content_hash);
+    return query.exec();
+}
+
+bool SqliteDbManager::BindAndInsertChunk(QSqlQuery& query, qint64 file_id, int chunk_no, qint64 first_line,
+                                         int line_count, const QByteArray& data, int codec, qint64 raw_size) {
+    query.addBindValue(file_id);
+    query.addBindValue(chunk_no);
+    query.addBindValue(first_line);
+    query.addBindValue(line_count);
+    query.addBindValue(data);
+    query.addBindValue(codec);
+    query.addBindValue(raw_size);
+    return query.exec();
+}
+
+bool SqliteDbManager::BindAndInsertLineTimes(QSqlQuery& query, qint64 file_id, int chunk_no, qint64 first_line,
+                                             const LineTimeIndex::ChunkTimes& times) {
+    if (times.count == 0) {
+        return true;
+    }
+    query.addBindValue(file_id);
+    query.addBindValue(chunk_no);
+    query.addBindValue(first_line);
+    query.addBindValue(times.min_time);
+    query.addBindValue(times.max_time);
+    query.addBindValue(times.count);
+    query.addBindValue(times.entries);
+    return query.exec();
+}
+
+bool SqliteDbManager::RebuildKeywordIndex(QSqlDatabase& database, const QString& schema) {
+    QSqlQuery query(database);
+    for (const char* statement : k_rebuild_keyword_files_sql_) {
+        if (!query.exec(QString(statement).arg(schema))) {
+            qCritical() << "重建关键字行索引失败：" << query.lastError().text();
+            return false;
+        }
+    }
+    for (const char* statement : k_rebuild_keyword_stats_sql_) {
+        if (!query.exec(QString(statement).arg(schema))) {
+            qCritical() << "重建关键字统计失败：" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+QByteArray SqliteDbManager::CompressChunk(const QByteArray& raw, int* codec) {
+    // qCompress输出为4字节长度前缀+zlib流，qUncompress可直接还原
+    QByteArray compressed = qCompress(raw, k_chunk_compression_level_);
+    if (compressed.size() < raw.size()) {
+        *codec = k_codec_zlib_;
+        return compressed;
+    }
+    *codec = k_codec_raw_;
+    return raw;
+}
+
+QByteArray SqliteDbManager::DecompressChunk(const QByteArray& data, int codec) {
+    if (codec == k_codec_raw_) {
+        return data;
+    }
+    
+    QByteArray raw = qUncompress(data);
+    if (raw.isEmpty() && !data.isEmpty()) {
+        qWarning() << "内容块解压失败，codec:" << codec << "大小:" << data.size();
+    }
+    return raw;
+}
+
+qint64 SqliteDbManager::FindChunkCut(const QByteArray& buffer, qint64 limit) {
+    if (buffer.size() <= limit) {
+        return buffer.size();
+    }
+    
+    qint64 newline = buffer.lastIndexOf('\n', limit - 1);
+    if (newline >= 0) {
+        return newline + 1;
+    }
+    
+    // 超长行：在limit处强制切分，但不能拆开多字节UTF-8字符或\r\n
+    qint64 cut = limit;
+    while (cut > 0 && (static_cast<quint8>(buffer.at(cut)) & 0xC0) == 0x80) {
+        --cut;
+    }
+    if (cut > 1 && buffer.at(cut - 1) == '\r') {
+        --cut;
+    }
+    return cut > 0 ? cut : limit;
+}
+
+bool SqliteDbManager::InsertFileContent(const QString& schema, qint64 file_id, const QString& content) {
+    // 每个文件都要用到这几条语句，在写连接上只编译一次
+    CachedStatement query = CachedQuery(m_writer_, QString(k_insert_chunk_sql_).arg(schema));
+    CachedStatement times_query = CachedQuery(m_writer_, QString(k_insert_line_times_sql_).arg(schema));
+    const bool has_fts = HasLineFts(m_writer_.database, schema);
+    std::optional<CachedStatement> fts_query;
+    if (has_fts) {
+        fts_query.emplace(CachedQuery(m_writer_, QString(k_insert_line_fts_sql_).arg(schema)));
+    }
+    QByteArray remaining = content.toUtf8();
+    
+    int chunk_no = 0;
+    qint64 first_line = 0;
+    LogSeverity::Counts severity;
+    while (!remaining.isEmpty()) {
+        qint64 cut = FindChunkCut(remaining, k_chunk_size_);
+        QByteArray chunk = remaining.left(cut);
+        remaining.remove(0, cut);
+        
+        int line_count = chunk.count('\n');
+        if (remaining.isEmpty() && !chunk.endsWith('\n')) {
+            ++line_count;
+        }
+        
+        int codec = k_codec_raw_;
+        QByteArray stored = CompressChunk(chunk, &codec);
+        if (!BindAndInsertLineTimes(*times_query, file_id, chunk_no, first_line, LineTimeIndex::Build(chunk)) ||
+            (fts_query && !IndexChunkLines(**fts_query, file_id, first_line, chunk)) ||
+            !BindAndInsertChunk(*query, file_id, chunk_no++, first_line, line_count, stored, codec, chunk.size())) {
+            qCritical() << "插入内容块失败：" << query->lastError().text() << times_query->lastError().text()
+                        << (fts_query ? (*fts_query)->lastError().text() : QString());
+            return false;
+        }
+        severity += LogSeverity::Count(chunk);
+        first_line += line_count;
+    }
+    
+    CachedStatement severity_query = CachedQuery(m_writer_,
+        QString("UPDATE %1.files SET error_count = ?, warning_count = ? WHERE id = ?").arg(schema));
+    if (!severity_query.Exec(severity.errors, severity.warnings, file_id)) {
+        qCritical() << "更新级别统计失败：" << severity_query->lastError().text();
+        return false;
     }
-    
     return true;
 }
 
-QList<DbFileRecord> SqliteDbManager::GetFilesByKeyword(const QString& keyword) {
-    QMutexLocker locker(&m_mutex_);
+QByteArray SqliteDbManager::ReadFileContent(ArchiveConnection& connection, const QString& schema, qint64 file_id) {
+    QByteArray content;
+    
+    CachedStatement query = CachedQuery(connection,
+        QString("SELECT data, codec FROM %1.file_chunks WHERE file_id = ? ORDER BY chunk_no").arg(schema));
+    if (!query.Exec(file_id)) {
+        qCritical() << "读取内容块失败：" << query->lastError().text();
+        return content;
+    }
+    
+    while (query->next()) {
+        content += DecompressChunk(query->value(0).toByteArray(), query->value(1).toInt());
+    }
+    return content;
+}
+
+QString SqliteDbManager::ReadLineRange(int archive_id, qint64 file_id, qint64 first_line, int line_count) {
+    ArchiveConnection& reader = Reader();
+    
+    QString schema = EnsureAttached(reader, archive_id);
+    if (schema.isEmpty()) {
+        return QString();
+    }
+    return Utf8Codec::Decode(ReadFileLines(reader, schema, file_id, first_line, line_count));
+}
+
+QByteArray SqliteDbManager::ReadFileLines(ArchiveConnection& connection, const QString& schema, qint64 file_id,
+                                          qint64 first_line, int line_count) {
+    if (line_count <= 0 || first_line < 0) {
+        return QByteArray();
+    }
+    
+    // 经(file_id, first_line)索引定位：起始块为首行不大于first_line的最后一块，
+    // 之后取到区间末尾为止，不扫描文件的其他块
+    CachedStatement query = CachedQuery(connection, QString(R"(
+        SELECT data, codec, first_line FROM %1.file_chunks
+        WHERE file_id = ?
+          AND first_line >= (SELECT MAX(first_line) FROM %1.file_chunks WHERE file_id = ? AND first_line <= ?)
+          AND first_line < ?
+        ORDER BY chunk_no
+    )").arg(schema));
+    if (!query.Exec(file_id, file_id, first_line, first_line + line_count)) {
+        qCritical() << "读取内容块失败：" << query->lastError().text();
+        return QByteArray();
+    }
+    
+    QByteArray content;
+    qint64 content_first_line = -1;
+    while (query->next()) {
+        if (content_first_line < 0) {
+            content_first_line = query->value(2).toLongLong();
+        }
+        content += DecompressChunk(query->value(0).toByteArray(), query->value(1).toInt());
+    }
+    if (content_first_line < 0) {
+        return QByteArray();
+    }
+    
+    // 按换行定位到请求的行区间
+    qint64 start = 0;
+    for (qint64 line = content_first_line; line < first_line && start >= 0; ++line) {
+        start = content.indexOf('\n', start);
+        start = start >= 0 ? start + 1 : -1;
+    }
+    if (start < 0) {
+        return QByteArray();
+    }
+    qint64 end = start;
+    for (int i = 0; i < line_count && end >= 0; ++i) {
+        end = content.indexOf('\n', end);
+        end = end >= 0 ? end + 1 : -1;
+    }
+    if (end < 0) {
+        end = content.size();
+    }
+    return content.mid(start, end - start);
+}
+
+qint64 SqliteDbManager::GetKeywordLineCount(const QString& keyword, const QList<int>& archive_ids) {
+    ArchiveConnection& reader = Reader();
+    
+    qint64 total = 0;
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (!schema.isEmpty()) {
+            total += KeywordLineTotals(reader, schema).value(keyword);
+        }
+    }
+    return total;
+}
+
+QStringList SqliteDbManager::GetKeywordLines(const QString& keyword, qint64 first_line, int line_count,
+                                             const QList<int>& archive_ids) {
+    ArchiveConnection& reader = Reader();
+    
+    QStringList lines;
+    if (line_count <= 0 || first_line < 0) {
+        return lines;
+    }
+    
+    // 合并文本按活动归档顺序拼接，archive_base为当前归档在合并文本中的起始行
+    qint64 archive_base = 0;
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
+        
+        qint64 archive_lines = KeywordLineTotals(reader, schema).value(keyword);
+        qint64 wanted = first_line + lines.size();
+        if (wanted >= archive_base + archive_lines) {
+            archive_base += archive_lines;
+            continue;
+        }
+        
+        // 经(keyword, first_line)索引定位到包含起始行的文件
+        qint64 local_first = wanted - archive_base;
+        CachedStatement query = CachedQuery(reader, QString(R"(
+            SELECT file_id, first_line, line_count FROM %1.keyword_files
+            WHERE keyword = ?
+              AND first_line >= (SELECT MAX(first_line) FROM %1.keyword_files WHERE keyword = ? AND first_line <= ?)
+              AND first_line < ?
+            ORDER BY seq
+        )").arg(schema));
+        if (!query.Exec(keyword, keyword, local_first, local_first + (line_count - lines.size()))) {
+            qCritical() << "查询关键字行索引失败：" << query->lastError().text();
+            return lines;
+        }
+        
+        struct FileSpan { qint64 file_id; qint64 first_line; qint64 line_count; };
+        QList<FileSpan> spans;
+        while (query->next()) {
+            spans.append({ query->value(0).toLongLong(), query->value(1).toLongLong(), query->value(2).toLongLong() });
+        }
+        query->finish();
+        
+        for (const FileSpan& span : spans) {
+            qint64 local_wanted = first_line + lines.size() - archive_base;
+            if (span.line_count == 0 || local_wanted >= span.first_line + span.line_count) {
+                continue;
+            }
+            qint64 offset = local_wanted - span.first_line;
+            int count = static_cast<int>(qMin<qint64>(line_count - lines.size(), span.line_count - offset));
+            
+            QStringList file_lines =
+                Utf8Codec::Decode(ReadFileLines(reader, schema, span.file_id, offset, count)).split('\n');
+            // 以换行结尾时split会多出一个空串
+            while (file_lines.size() > count) {
+                file_lines.removeLast();
+            }
+            lines += file_lines;
+            if (lines.size() >= line_count) {
+                return lines;
+            }
+        }
+        archive_base += archive_lines;
+    }
+    return lines;
+}
+
+QHash<QString, qint64> SqliteDbManager::KeywordLineTotals(ArchiveConnection& connection, const QString& schema) {
+    QHash<QString, qint64> totals;
     
-    QList<DbFileRecord> records;
+    CachedStatement query = CachedQuery(connection,
+        QString("SELECT keyword, SUM(line_count) FROM %1.keyword_files GROUP BY keyword").arg(schema));
+    if (!query->exec()) {
+        qCritical() << "查询关键字行数失败：" << query->lastError().text();
+        return totals;
+    }
+    while (query->next()) {
+        totals.insert(query->value(0).toString(), query->value(1).toLongLong());
+    }
+    return totals;
+}
+
+QList<QPair<qint64, qint64>> SqliteDbManager::KeywordFileStarts(ArchiveConnection& connection, const QString& schema,
+                                                                const QString& keyword) {
+    QList<QPair<qint64, qint64>> files;
     
-    QSqlQuery query = PrepareQuery("SELECT * FROM files WHERE keyword = ?");
-    query.addBindValue(keyword);
+    CachedStatement query = CachedQuery(connection,
+        QString("SELECT file_id, first_line FROM %1.keyword_files WHERE keyword = ? ORDER BY seq").arg(schema));
+    if (!query.Exec(keyword)) {
+        qCritical() << "查询关键字文件失败：" << query->lastError().text();
+        return files;
+    }
+    while (query->next()) {
+        files.append(qMakePair(query->value(0).toLongLong(), query->value(1).toLongLong()));
+    }
+    return files;
+}
+
+bool SqliteDbManager::GetKeywordTimeRange(const QString& keyword, qint64* first_time, qint64* last_time,
+                                          const QList<int>& archive_ids) {
+    ArchiveConnection& reader = Reader();
     
-    if (!query.exec()) {
-        qCritical() << "查询失败：" << query.lastError().text();
-        return records;
+    bool found = false;
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
+        
+        // 每块只读min_ts/max_ts，不解码条目
+        CachedStatement query = CachedQuery(reader, QString(R"(
+            SELECT MIN(t.min_ts), MAX(t.max_ts) FROM %1.keyword_files k
+            JOIN %1.line_times t ON t.file_id = k.file_id
+            WHERE k.keyword = ?
+        )").arg(schema));
+        if (!query.Exec(keyword)) {
+            qCritical() << "查询时间范围失败：" << query->lastError().text();
+            continue;
+        }
+        if (!query->next() || query->value(0).isNull()) {
+            continue;
+        }
+        
+        qint64 archive_first = query->value(0).toLongLong();
+        qint64 archive_last = query->value(1).toLongLong();
+        if (!found || archive_first < *first_time) {
+            *first_time = archive_first;
+        }
+        if (!found || archive_last > *last_time) {
+            *last_time = archive_last;
+        }
+        found = true;
     }
+    return found;
+}
+
+qint64 SqliteDbManager::FindKeywordLineAtTime(const QString& keyword, qint64 time, const QList<int>& archive_ids) {
+    ArchiveConnection& reader = Reader();
     
-    while (query.next()) {
-        DbFileRecord record;
-        record.id = query.value("id").toInt();
-        record.file_path = query.value("file_path").toString();
-        record.file_name = query.value("file_name").toString();
-        record.keyword = query.value("keyword").toString();
-        record.category = query.value("category").toString();
-        record.content = query.value("content").toString();
-        record.file_size = query.value("file_size").toLongLong();
-        record.zip_source = query.value("zip_source").toString();
-        record.import_time = query.value("import_time").toDateTime();
-        records.append(record);
+    qint64 best_line = -1;
+    qint64 best_time = 0;
+    qint64 archive_base = 0;
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
+        
+        // 每个文件经(file_id, max_ts)索引定位到max_ts不小于time的最小块，只解码这一块；
+        // 日志按时间写入时该块就包含目标行
+        CachedStatement query = CachedQuery(reader, QString(R"(
+            SELECT first_line, min_ts, entries FROM %1.line_times
+            WHERE file_id = ? AND max_ts >= ?
+            ORDER BY max_ts
+            LIMIT 1
+        )").arg(schema));
+        
+        for (const auto& file : KeywordFileStarts(reader, schema, keyword)) {
+            if (!query.Exec(file.first, time)) {
+                qCritical() << "按时间定位失败：" << query->lastError().text();
+                break;
+            }
+            if (!query->next()) {
+                continue;
+            }
+            
+            const auto entries = LineTimeIndex::Decode(query->value(2).toByteArray(), query->value(0).toLongLong(),
+                                                       query->value(1).toLongLong());
+            for (const LineTimeIndex::Entry& entry : entries) {
+                if (entry.time < time) {
+                    continue;
+                }
+                if (best_line < 0 || entry.time < best_time) {
+                    best_time = entry.time;
+                    best_line = archive_base + file.second + entry.line;
+                }
+                break;
+            }
+        }
+        
+        archive_base += KeywordLineTotals(reader, schema).value(keyword);
     }
+    return best_line;
+}
+
+QList<qint64> SqliteDbManager::GetKeywordLinesInTimeWindow(const QString& keyword, qint64 from_time, qint64 to_time,
+                                                           int max_lines, const QList<int>& archive_ids) {
+    ArchiveConnection& reader = Reader();
     
-    return records;
+    QList<qint64> lines;
+    qint64 archive_base = 0;
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
+        
+        // 经(file_id, max_ts)索引跳过窗口之前的块，再按min_ts排除窗口之后的块
+        CachedStatement query = CachedQuery(reader, QString(R"(
+            SELECT first_line, min_ts, entries FROM %1.line_times
+            WHERE file_id = ? AND max_ts >= ? AND min_ts <= ?
+            ORDER BY chunk_no
+        )").arg(schema));
+        
+        for (const auto& file : KeywordFileStarts(reader, schema, keyword)) {
+            if (!query.Exec(file.first, from_time, to_time)) {
+                qCritical() << "查询时间窗口失败：" << query->lastError().text();
+                return lines;
+            }
+            while (query->next()) {
+                const auto entries = LineTimeIndex::Decode(query->value(2).toByteArray(), query->value(0).toLongLong(),
+                                                           query->value(1).toLongLong());
+                for (const LineTimeIndex::Entry& entry : entries) {
+                    if (entry.time < from_time || entry.time > to_time) {
+                        continue;
+                    }
+                    lines.append(archive_base + file.second + entry.line);
+                    if (lines.size() >= max_lines) {
+                        return lines;
+                    }
+                }
+            }
+        }
+        
+        archive_base += KeywordLineTotals(reader, schema).value(keyword);
+    }
+    return lines;
 }
 
-QList<DbFileRecord> SqliteDbManager::GetAllFiles() {
+bool SqliteDbManager::InsertFile(int archive_id, const DbFileRecord& record) {
+    return InsertFiles(archive_id, { record });
+}
+
+bool SqliteDbManager::InsertFiles(int archive_id, const QList<DbFileRecord>& records) {
+    if (!OnWriterThread()) {
+        return RunOnWriter([&]() { return InsertFiles(archive_id, records); });
+    }
     QMutexLocker locker(&m_mutex_);
     
-    QList<DbFileRecord> records;
+    QString schema = EnsureAttached(m_writer_, archive_id);
+    if (schema.isEmpty() || !BeginTransaction()) {
+        return false;
+    }
     
-    QSqlQuery query(m_database_);
-    if (!query.exec("SELECT * FROM files ORDER BY keyword, file_name")) {
-        qCritical() << "查询失败：" << query.lastError().text();
-        return records;
+    CachedStatement query = CachedQuery(m_writer_, QString(k_insert_file_sql_).arg(schema));
+    
+    int progress = 0;
+    int total = records.size();
+    
+    for (const auto& record : records) {
+        if (!BindAndInsertFile(*query, record) ||
+            !InsertFileContent(schema, query->lastInsertId().toLongLong(), record.content)) {
+            qCritical() << "批量插入失败：" << query->lastError().text();
+            emit databaseError(query->lastError().text());
+            RollbackTransaction();
+            return false;
+        }
+        
+        progress++;
+        if (progress % 10 == 0) {
+            emit progressUpdate((progress * 100) / total);
+        }
+    }
+    
+    if (!RebuildKeywordIndex(m_writer_.database, schema)) {
+        RollbackTransaction();
+        return false;
+    }
+    
+    if (!CommitTransaction()) {
+        return false;
+    }
+    
+    emit progressUpdate(100);
+    qDebug() << "成功插入" << records.size() << "条文件记录";
+    return true;
+}
+
+bool SqliteDbManager::DeleteFilesByIds(QSqlDatabase& database, const QList<qint64>& file_ids) {
+    QSqlQuery file_query(database);
+    file_query.prepare("DELETE FROM files WHERE id = ?");
+    QSqlQuery chunk_query(database);
+    chunk_query.prepare("DELETE FROM file_chunks WHERE file_id = ?");
+    QSqlQuery times_query(database);
+    times_query.prepare("DELETE FROM line_times WHERE file_id = ?");
+    const bool has_fts = HasLineFts(database);
+    
+    for (qint64 file_id : file_ids) {
+        // 旧版contentless表删除时需要读取原文，必须在删除内容块之前
+        if (has_fts && !DeleteLineFts(database, file_id)) {
+            return false;
+        }
+        file_query.addBindValue(file_id);
+        chunk_query.addBindValue(file_id);
+        times_query.addBindValue(file_id);
+        if (!file_query.exec() || !chunk_query.exec() || !times_query.exec()) {
+            qCritical() << "删除文件记录失败：" << file_query.lastError().text() << chunk_query.lastError().text()
+                        << times_query.lastError().text();
+            return false;
+        }
     }
+    return true;
+}
+
+QList<DbFileRecord> SqliteDbManager::ReadFileRecords(ArchiveConnection& connection, QSqlQuery& query, int archive_id,
+                                                     const QString& schema, bool load_content) {
+    QList<DbFileRecord> records;
     
     while (query.next()) {
         DbFileRecord record;
@@ -347,194 +1816,616 @@ QList<DbFileRecord> SqliteDbManager::GetAllFiles() {
         record.file_name = query.value("file_name").toString();
         record.keyword = query.value("keyword").toString();
         record.category = query.value("category").toString();
-        record.content = query.value("content").toString();
         record.file_size = query.value("file_size").toLongLong();
         record.zip_source = query.value("zip_source").toString();
         record.import_time = query.value("import_time").toDateTime();
+        record.line_count = query.value("line_count").toInt();
+        record.entry_fingerprint = query.value("entry_fingerprint").toString();
+        record.content_hash = query.value("content_hash").toString();
+        record.archive_id = archive_id;
         records.append(record);
     }
     
+    if (!load_content) {
+        return records;
+    }
+    
+    // 结果集读完后再读取内容，避免同一连接上嵌套游标
+    for (DbFileRecord& record : records) {
+        record.content = Utf8Codec::Decode(ReadFileContent(connection, schema, record.id));
+    }
     return records;
 }
 
-QString SqliteDbManager::GetMergedContentByKeyword(const QString& keyword) {
-    QMutexLocker locker(&m_mutex_);
+QList<DbFileRecord> SqliteDbManager::GetFilesByKeyword(const QString& keyword, const QList<int>& archive_ids) {
+    ArchiveConnection& reader = Reader();
+    
+    QList<DbFileRecord> records;
     
-    QString merged_content;
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
+        
+        CachedStatement query = CachedQuery(reader, QString("SELECT * FROM %1.files WHERE keyword = ?").arg(schema));
+        if (!query.Exec(keyword)) {
+            qCritical() << "查询失败：" << query->lastError().text();
+            continue;
+        }
+        
+        records += ReadFileRecords(reader, query, archive_id, schema);
+    }
     
-    QSqlQuery query = PrepareQuery(
-        "SELECT content FROM files WHERE keyword = ? ORDER BY file_name DESC"
-    );
-    query.addBindValue(keyword);
+    return records;
+}
+
+QList<DbFileRecord> SqliteDbManager::GetAllFiles(const QList<int>& archive_ids) {
+    ArchiveConnection& reader = Reader();
     
-    if (!query.exec()) {
-        qCritical() << "查询内容失败：" << query.lastError().text();
-        return merged_content;
+    QList<DbFileRecord> records;
+    
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
+        
+        QSqlQuery query(reader.database);
+        if (!query.exec(QString("SELECT * FROM %1.files ORDER BY keyword, file_name").arg(schema))) {
+            qCritical() << "查询失败：" << query.lastError().text();
+            continue;
+        }
+        
+        records += ReadFileRecords(reader, query, archive_id, schema);
     }
     
-    while (query.next()) {
-        merged_content += query.value("content").toString();
+    return records;
+}
+
+QList<DbFileRecord> SqliteDbManager::ListFiles(const QString& keyword, const QList<int>& archive_ids) {
+    ArchiveConnection& reader = Reader();
+    
+    QList<DbFileRecord> records;
+    
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
+        
+        CachedStatement query = CachedQuery(reader, QString(R"(
+            SELECT id, file_path, file_name, keyword, category, file_size, zip_source, import_time, line_count,
+                   entry_fingerprint, content_hash
+            FROM %1.files
+            WHERE ? = '' OR keyword = ?
+            ORDER BY keyword, file_name
+        )").arg(schema));
+        if (!query.Exec(keyword, keyword)) {
+            qCritical() << "查询文件列表失败：" << query->lastError().text();
+            continue;
+        }
+        
+        records += ReadFileRecords(reader, query, archive_id, schema, false);
     }
     
-    return merged_content;
+    return records;
 }
 
-QStringList SqliteDbManager::GetAllKeywords() {
-    QMutexLocker locker(&m_mutex_);
+QList<DbKeywordSummary> SqliteDbManager::GetKeywordSummaries(const QList<int>& archive_ids) {
+    ArchiveConnection& reader = Reader();
     
-    QStringList keywords;
+    // 多个归档的同名关键字合并为一组
+    QMap<QString, DbKeywordSummary> summaries;
     
-    QSqlQuery query(m_database_);
-    if (!query.exec("SELECT DISTINCT keyword FROM files ORDER BY keyword")) {
-        qCritical() << "查询关键字失败：" << query.lastError().text();
-        return keywords;
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
+        
+        CachedStatement query = CachedQuery(reader, QString(R"(
+            SELECT keyword, category, file_count, total_size, line_count, min_ts, max_ts, error_count, warning_count
+            FROM %1.keyword_stats
+        )").arg(schema));
+        if (!query->exec()) {
+            qCritical() << "查询关键字统计失败：" << query->lastError().text();
+            continue;
+        }
+        
+        while (query->next()) {
+            DbKeywordSummary& summary = summaries[query->value(0).toString()];
+            summary.keyword = query->value(0).toString();
+            if (summary.category.isEmpty()) {
+                summary.category = query->value(1).toString();
+            }
+            summary.file_count += query->value(2).toInt();
+            summary.total_size += query->value(3).toLongLong();
+            summary.line_count += query->value(4).toLongLong();
+            if (!query->value(5).isNull()) {
+                qint64 first_time = query->value(5).toLongLong();
+                qint64 last_time = query->value(6).toLongLong();
+                if (summary.first_time < 0 || first_time < summary.first_time) {
+                    summary.first_time = first_time;
+                }
+                if (summary.last_time < 0 || last_time > summary.last_time) {
+                    summary.last_time = last_time;
+                }
+            }
+            summary.error_count += query->value(7).toLongLong();
+            summary.warning_count += query->value(8).toLongLong();
+        }
     }
     
-    while (query.next()) {
-        keywords.append(query.value(0).toString());
+    return summaries.values();
+}
+
+bool SqliteDbManager::StreamFileContent(int archive_id, qint64 file_id,
+                                        const std::function<bool(const QByteArray&)>& consumer) {
+    ArchiveConnection& reader = Reader();
+    
+    QString schema = EnsureAttached(reader, archive_id);
+    if (schema.isEmpty()) {
+        return false;
     }
     
-    return keywords;
+    // 内容块按(file_id, chunk_no)主键顺序逐行取出，每块单独解压后即交给调用方
+    CachedStatement query = CachedQuery(reader,
+        QString("SELECT data, codec FROM %1.file_chunks WHERE file_id = ? ORDER BY chunk_no").arg(schema));
+    if (!query.Exec(file_id)) {
+        qCritical() << "读取内容块失败：" << query->lastError().text();
+        return false;
+    }
+    
+    while (query->next()) {
+        if (!consumer(DecompressChunk(query->value(0).toByteArray(), query->value(1).toInt()))) {
+            return false;
+        }
+    }
+    return true;
 }
 
-QList<DbSearchResult> SqliteDbManager::SearchInFiles(const QString& search_text, int max_results) {
-    QMutexLocker locker(&m_mutex_);
+QString SqliteDbManager::ReadFileText(int archive_id, qint64 file_id) {
+    QByteArray content;
+    StreamFileContent(archive_id, file_id, [&content](const QByteArray& chunk) {
+        content += chunk;
+        return true;
+    });
+    return Utf8Codec::Decode(content);
+}
+
+QString SqliteDbManager::GetMergedContentByKeyword(const QString& keyword, const QList<int>& archive_ids,
+                                                   const std::function<bool()>& is_cancelled) {
+    ArchiveConnection& reader = Reader();
     
-    QList<DbSearchResult> results;
+    // 先按UTF-8字节拼接，最后一次性解码，避免中间QString反复扩容
+    QByteArray merged_content;
     
-    // 尝试使用全文搜索
-    QSqlQuery fts_query = PrepareQuery(R"(
-        SELECT files.id, files.file_name, files.keyword, files.content
-        FROM files 
-        JOIN files_fts ON files.id = files_fts.rowid
-        WHERE files_fts MATCH ?
-        LIMIT ?
-    )");
-    
-    fts_query.addBindValue(search_text);
-    fts_query.addBindValue(max_results);
-    
-    bool use_fts = fts_query.exec();
-    
-    if (!use_fts) {
-        // 回退到LIKE搜索
-        QSqlQuery like_query = PrepareQuery(R"(
-            SELECT id, file_name, keyword, content
-            FROM files
-            WHERE content LIKE ?
-            LIMIT ?
-        )");
-        
-        like_query.addBindValue("%" + search_text + "%");
-        like_query.addBindValue(max_results);
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
         
-        if (!like_query.exec()) {
-            qCritical() << "搜索失败：" << like_query.lastError().text();
-            return results;
+        // 按keyword_files的合并顺序读取，行号与关键字行索引一致
+        CachedStatement query = CachedQuery(reader, QString(R"(
+            SELECT c.data, c.codec, c.file_id FROM %1.keyword_files k
+            JOIN %1.file_chunks c ON c.file_id = k.file_id
+            WHERE k.keyword = ?
+            ORDER BY k.seq, c.chunk_no
+        )").arg(schema));
+        if (!query.Exec(keyword)) {
+            qCritical() << "查询内容失败：" << query->lastError().text();
+            continue;
         }
         
-        ProcessSearchResults(like_query, search_text, results, max_results);
-    } else {
-        ProcessSearchResults(fts_query, search_text, results, max_results);
+        qint64 current_file = -1;
+        while (query->next()) {
+            if (is_cancelled && is_cancelled()) {
+                return QString();
+            }
+            // 上一个文件末行没有换行时补上，避免与下一个文件的首行连成一行
+            qint64 file_id = query->value(2).toLongLong();
+            if (file_id != current_file && !merged_content.isEmpty() && !merged_content.endsWith('\n')) {
+                merged_content += '\n';
+            }
+            current_file = file_id;
+            merged_content += DecompressChunk(query->value(0).toByteArray(), query->value(1).toInt());
+        }
+        if (!merged_content.isEmpty() && !merged_content.endsWith('\n')) {
+            merged_content += '\n';
+        }
     }
     
-    return results;
+    return Utf8Codec::Decode(merged_content);
 }
 
-QList<DbSearchResult> SqliteDbManager::SearchInKeyword(const QString& keyword, const QString& search_text, int max_results) {
-    QMutexLocker locker(&m_mutex_);
-    
-    QList<DbSearchResult> results;
+QFuture<QString> SqliteDbManager::GetMergedContentByKeywordAsync(const QString& keyword, const QList<int>& archive_ids) {
+    return RunAsync<QString>([this, keyword, archive_ids](QPromise<QString>& promise) {
+        QString content = GetMergedContentByKeyword(keyword, archive_ids, [&promise]() { return promise.isCanceled(); });
+        if (!promise.isCanceled()) {
+            promise.addResult(content);
+        }
+    });
+}
+
+QStringList SqliteDbManager::GetAllKeywords(const QList<int>& archive_ids) {
+    // GetKeywordSummaries按关键字有序且已去重
+    QStringList keywords;
+    for (const DbKeywordSummary& summary : GetKeywordSummaries(archive_ids)) {
+        keywords.append(summary.keyword);
+    }
+    return keywords;
+}
+
+QList<DbSearchResult> SqliteDbManager::SearchInFiles(const QString& search_text, int max_results, const QList<int>& archive_ids,
+                                                    const TextMatcher::Options& options) {
+    return SearchInFiles(QStringList{ search_text }, max_results, archive_ids, options);
+}
+
+QList<DbSearchResult> SqliteDbManager::SearchInFiles(const QStringList& search_terms, int max_results,
+                                                    const QList<int>& archive_ids, const TextMatcher::Options& options,
+                                                    const SearchBatchHandler& on_batch,
+                                                    const std::function<bool()>& is_cancelled) {
+    ArchiveConnection& reader = Reader();
     
-    QSqlQuery query = PrepareQuery(R"(
-        SELECT id, file_name, keyword, content
-        FROM files
-        WHERE keyword = ? AND content LIKE ?
-        LIMIT ?
-    )");
+    std::unique_ptr<TextMatcher> matcher = TextMatcher::Create(search_terms, options);
+    if (!matcher->IsValid()) {
+        qWarning() << "搜索词无效：" << search_terms;
+        return QList<DbSearchResult>();
+    }
+    SearchCollector collector(max_results, on_batch, is_cancelled);
+    // 行级全文索引每次只能查一个词；多词搜索直接逐块扫描，所有词一遍完成
+    const bool use_line_index = !options.regex && matcher->Patterns().size() == 1;
+    // 行号以关键字合并文本为准，后续归档的行号接在前面归档之后
+    QHash<QString, qint64> keyword_bases;
+    
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
+        
+        // 优先经行级全文索引定位，不可用、正则或多词搜索时逐块解压扫描
+        if (!use_line_index || !SearchLineIndex(reader, schema, archive_id, QString(), matcher->Patterns().front(),
+                                                *matcher, keyword_bases, collector)) {
+            // 按合并顺序（关键字、seq）扫描，结果顺序和max_results截断与合并文本一致
+            CachedStatement query = CachedQuery(reader, QString(R"(
+                SELECT f.id, f.file_name, f.keyword, c.data, k.first_line + c.first_line, c.codec
+                FROM %1.keyword_files k
+                JOIN %1.files f ON f.id = k.file_id
+                JOIN %1.file_chunks c ON c.file_id = k.file_id
+                ORDER BY k.keyword, k.seq, c.chunk_no
+            )").arg(schema));
+            
+            if (!query->exec()) {
+                qCritical() << "搜索失败：" << query->lastError().text();
+                continue;
+            }
+            
+            ProcessSearchResults(*query, archive_id, *matcher, keyword_bases, collector);
+        }
+        if (collector.Done()) {
+            break;
+        }
+        
+        const QHash<QString, qint64> totals = KeywordLineTotals(reader, schema);
+        for (auto it = totals.cbegin(); it != totals.cend(); ++it) {
+            keyword_bases[it.key()] += it.value();
+        }
+    }
     
-    query.addBindValue(keyword);
-    query.addBindValue("%" + search_text + "%");
-    query.addBindValue(max_results);
+    collector.Flush();
+    return collector.Results();
+}
+
+QList<DbSearchResult> SqliteDbManager::SearchInKeyword(const QString& keyword, const QString& search_text, int max_results,
+                                                      const QList<int>& archive_ids, const TextMatcher::Options& options) {
+    return SearchInKeyword(keyword, QStringList{ search_text }, max_results, archive_ids, options);
+}
+
+QList<DbSearchResult> SqliteDbManager::SearchInKeyword(const QString& keyword, const QStringList& search_terms, int max_results,
+                                                      const QList<int>& archive_ids, const TextMatcher::Options& options,
+                                                      const SearchBatchHandler& on_batch,
+                                                      const std::function<bool()>& is_cancelled) {
+    ArchiveConnection& reader = Reader();
     
-    if (!query.exec()) {
-        qCritical() << "搜索失败：" << query.lastError().text();
-        return results;
+    std::unique_ptr<TextMatcher> matcher = TextMatcher::Create(search_terms, options);
+    if (!matcher->IsValid()) {
+        qWarning() << "搜索词无效：" << search_terms;
+        return QList<DbSearchResult>();
+    }
+    SearchCollector collector(max_results, on_batch, is_cancelled);
+    const bool use_line_index = !options.regex && matcher->Patterns().size() == 1;
+    // 行号以关键字合并文本为准，后续归档的行号接在前面归档之后
+    QHash<QString, qint64> keyword_bases;
+    
+    for (int archive_id : ResolveScope(archive_ids)) {
+        QString schema = EnsureAttached(reader, archive_id);
+        if (schema.isEmpty()) {
+            continue;
+        }
+        
+        if (!use_line_index || !SearchLineIndex(reader, schema, archive_id, keyword, matcher->Patterns().front(),
+                                                *matcher, keyword_bases, collector)) {
+            // 与GetMergedContentByKeyword相同的读取顺序
+            CachedStatement query = CachedQuery(reader, QString(R"(
+                SELECT f.id, f.file_name, f.keyword, c.data, k.first_line + c.first_line, c.codec
+                FROM %1.keyword_files k
+                JOIN %1.files f ON f.id = k.file_id
+                JOIN %1.file_chunks c ON c.file_id = k.file_id
+                WHERE k.keyword = ?
+                ORDER BY k.seq, c.chunk_no
+            )").arg(schema));
+            
+            if (!query.Exec(keyword)) {
+                qCritical() << "搜索失败：" << query->lastError().text();
+                continue;
+            }
+            
+            ProcessSearchResults(*query, archive_id, *matcher, keyword_bases, collector);
+        }
+        if (collector.Done()) {
+            break;
+        }
+        
+        const QHash<QString, qint64> totals = KeywordLineTotals(reader, schema);
+        for (auto it = totals.cbegin(); it != totals.cend(); ++it) {
+            keyword_bases[it.key()] += it.value();
+        }
     }
     
-    ProcessSearchResults(query, search_text, results, max_results);
-    
-    return results;
+    collector.Flush();
+    return collector.Results();
+}
+
+SqliteDbManager::SearchCollector::SearchCollector(int max_results, const SearchBatchHandler& on_batch,
+                                                 const std::function<bool()>& is_cancelled)
+    : m_max_results_(max_results)
+    , m_on_batch_(on_batch)
+    , m_is_cancelled_(is_cancelled) {
+    m_timer_.start();
+}
+
+void SqliteDbManager::SearchCollector::Add(const DbSearchResult& result) {
+    m_results_.append(result);
+    if (m_on_batch_ && (m_flushed_ == 0 || m_results_.size() - m_flushed_ >= k_batch_rows_ ||
+                        m_timer_.elapsed() >= k_batch_interval_ms_)) {
+        Flush();
+    }
 }
 
-void SqliteDbManager::ProcessSearchResults(QSqlQuery& query, const QString& search_text, QList<DbSearchResult>& results, int max_results) {
-    QRegularExpression search_regex(QRegularExpression::escape(search_text), 
-                                   QRegularExpression::CaseInsensitiveOption);
+bool SqliteDbManager::SearchCollector::Done() const {
+    return m_results_.size() >= m_max_results_ || (m_is_cancelled_ && m_is_cancelled_());
+}
+
+void SqliteDbManager::SearchCollector::Flush() {
+    if (!m_on_batch_ || m_flushed_ == m_results_.size()) {
+        return;
+    }
+    m_on_batch_(m_results_.mid(m_flushed_));
+    m_flushed_ = m_results_.size();
+    m_timer_.restart();
+}
+
+bool SqliteDbManager::SearchLineIndex(ArchiveConnection& connection, const QString& schema, int archive_id,
+                                      const QString& keyword, const QString& search_text, const TextMatcher& matcher,
+                                      const QHash<QString, qint64>& keyword_bases, SearchCollector& collector) {
+    // trigram至少需要3个字符
+    if (search_text.size() < 3 || !HasLineFts(connection.database, schema)) {
+        return false;
+    }
     
-    while (query.next()) {
+    // 参与搜索的文件：名称、关键字和在合并文本中的起始行，按合并顺序（关键字、seq）排列。
+    // 文件编号由并行导入按条目完成顺序分配，与合并顺序无关，不能按rowid顺序收集命中行
+    struct FileInfo { QString file_name; QString keyword; qint64 first_line; };
+    QHash<qint64, FileInfo> files;
+    QList<qint64> file_ids;
+    CachedStatement file_query = CachedQuery(connection, QString(R"(
+        SELECT f.id, f.file_name, f.keyword, k.first_line FROM %1.keyword_files k
+        JOIN %1.files f ON f.id = k.file_id
+        WHERE ? = '' OR k.keyword = ?
+        ORDER BY k.keyword, k.seq
+    )").arg(schema));
+    if (!file_query.Exec(keyword, keyword)) {
+        qCritical() << "搜索失败：" << file_query->lastError().text();
+        return false;
+    }
+    while (file_query->next()) {
+        qint64 file_id = file_query->value(0).toLongLong();
+        file_ids.append(file_id);
+        files.insert(file_id, { file_query->value(1).toString(), file_query->value(2).toString(),
+                                file_query->value(3).toLongLong() });
+    }
+    file_query->finish();
+    
+    // line_fts包含归档中所有关键字的行：按合并顺序逐个文件区间MATCH，
+    // 合并顺序中相邻且编号递增连续的文件合并为一个区间，区间内rowid顺序即合并顺序
+    QList<QPair<qint64, qint64>> file_ranges;   // [首个文件, 末个文件]
+    for (qint64 file_id : file_ids) {
+        if (!file_ranges.isEmpty() && file_ranges.last().second + 1 == file_id) {
+            file_ranges.last().second = file_id;
+        } else {
+            file_ranges.append({ file_id, file_id });
+        }
+    }
+    
+    // 整个搜索词作为一个短语：trigram短语匹配即子串匹配（不区分大小写）
+    QString phrase = search_text;
+    phrase.replace('"', "\"\"");
+    phrase = QString("\"%1\"").arg(phrase);
+    CachedStatement match_query = CachedQuery(connection, QString(
+        "SELECT rowid FROM %1.line_fts WHERE line_fts MATCH ? AND rowid BETWEEN ? AND ? ORDER BY rowid").arg(schema));
+    
+    // 区间内命中行按rowid即(file_id, 行号)有序，同一块内的命中只解压一次
+    CachedStatement chunk_query = CachedQuery(connection, QString(R"(
+        SELECT data, codec, first_line FROM %1.file_chunks
+        WHERE file_id = ? AND first_line <= ?
+        ORDER BY first_line DESC
+        LIMIT 1
+    )").arg(schema));
+    qint64 cached_file = -1;
+    qint64 cached_first_line = 0;
+    QByteArray cached_data;
+    QList<qsizetype> cached_starts;   // 块内各行的字节起点
+    
+    int hits = 0;
+    for (qsizetype range = 0; range < file_ranges.size() && !collector.Done(); ++range) {
+        if (!match_query.Exec(phrase, LineRowId(file_ranges[range].first, 0),
+                              LineRowId(file_ranges[range].second, 0xFFFFFFFFLL))) {
+            // 第一次查询就失败时索引不可用，改为逐块扫描；之后失败时已有部分结果，不再重复扫描
+            qWarning() << "全文索引搜索失败：" << match_query->lastError().text();
+            if (range == 0) {
+                return false;
+            }
+            break;
+        }
+        while (!collector.Done() && match_query->next()) {
+            qint64 row_id = match_query->value(0).toLongLong();
+            qint64 file_id = row_id >> 32;
+            qint64 line = row_id & 0xFFFFFFFFLL;
+            auto file = files.constFind(file_id);
+            if (file == files.constEnd()) {
+                continue;
+            }
+            ++hits;
+            
+            if (file_id != cached_file || line < cached_first_line || line >= cached_first_line + cached_starts.size()) {
+                if (!chunk_query.Exec(file_id, line) || !chunk_query->next()) {
+                    continue;
+                }
+                cached_file = file_id;
+                cached_first_line = chunk_query->value(2).toLongLong();
+                cached_data = DecompressChunk(chunk_query->value(0).toByteArray(), chunk_query->value(1).toInt());
+                chunk_query->finish();
+                cached_starts = { 0 };
+                for (qsizetype pos = cached_data.indexOf('\n'); pos >= 0; pos = cached_data.indexOf('\n', pos + 1)) {
+                    cached_starts.append(pos + 1);
+                }
+            }
+            
+            qint64 offset = line - cached_first_line;
+            if (offset < 0 || offset >= cached_starts.size()) {
+                continue;
+            }
+            // 在该行的UTF-8字节上校验（区分大小写、整词等），命中后才解码
+            const char* line_data = cached_data.constData() + cached_starts[offset];
+            qsizetype line_size = (offset + 1 < cached_starts.size() ? cached_starts[offset + 1] - 1 : cached_data.size())
+                                  - cached_starts[offset];
+            TextMatcher::Match match = matcher.Find(line_data, line_size);
+            if (match.offset < 0) {
+                continue;
+            }
+            const QString text = Utf8Codec::Decode(line_data, line_size);
+            int position = static_cast<int>(TextMatcher::Utf16Length(line_data, match.offset));
+            
+            DbSearchResult result;
+            result.file_id = static_cast<int>(file_id);
+            result.archive_id = archive_id;
+            result.file_name = file->file_name;
+            result.keyword = file->keyword;
+            result.line_number = static_cast<int>(keyword_bases.value(file->keyword) + file->first_line + line) + 1;
+            result.line_content = text;
+            result.preview = text.length() > 50 ? text.left(50) + "..." : text;
+            result.match_position = position;
+            result.matched_term = search_text;
+            collector.Add(result);
+        }
+    }
+    
+    qDebug() << "全文索引搜索:" << schema << search_text << "命中行:" << hits << "结果:" << collector.Results().size();
+    return true;
+}
+
+void SqliteDbManager::ProcessSearchResults(QSqlQuery& query, int archive_id, const TextMatcher& matcher,
+                                           const QHash<QString, qint64>& keyword_bases, SearchCollector& collector) {
+    while (!collector.Done() && query.next()) {
         int file_id = query.value(0).toInt();
         QString file_name = query.value(1).toString();
         QString keyword = query.value(2).toString();
-        QString content = query.value(3).toString();
+        qint64 first_line = keyword_bases.value(keyword) + query.value(4).toLongLong();
+        
+        // 内容块已压缩，无法在SQL中过滤：解压后直接在UTF-8字节上查找，只解码命中的行
+        const QByteArray data = DecompressChunk(query.value(3).toByteArray(), query.value(5).toInt());
+        const char* base = data.constData();
         
-        // 分割内容为行并查找匹配
-        QStringList lines = content.split('\n');
-        for (int i = 0; i < lines.size(); ++i) {
-            const QString& line = lines[i];
-            QRegularExpressionMatch match = search_regex.match(line);
+        // 内容块按换行边界切分，块内行号加上块起始行即为合并文本中的行号
+        qsizetype line_start = 0;
+        qint64 line_index = 0;
+        for (TextMatcher::Match match = matcher.Find(data); match.offset >= 0; match = matcher.Find(data, line_start)) {
+            const char* p = base + line_start;
+            const char* hit = base + match.offset;
+            while (const char* newline = static_cast<const char*>(std::memchr(p, '\n', hit - p))) {
+                ++line_index;
+                p = newline + 1;
+            }
+            line_start = p - base;
+            const char* line_end = static_cast<const char*>(std::memchr(hit, '\n', data.size() - match.offset));
+            qsizetype line_size = (line_end ? line_end - base : data.size()) - line_start;
+            const QString line = Utf8Codec::Decode(base + line_start, line_size);
+            
+            // 多词搜索时一行按命中的每个搜索词各记一条，位置取该词在行内第一次出现处
+            QList<TextMatcher::Span> hits;
+            if (matcher.Patterns().size() > 1) {
+                for (const TextMatcher::Span& span : matcher.FindAll(line)) {
+                    if (std::none_of(hits.cbegin(), hits.cend(),
+                                     [&span](const TextMatcher::Span& hit) { return hit.pattern == span.pattern; })) {
+                        hits.append(span);
+                    }
+                }
+            }
+            if (hits.isEmpty()) {
+                hits.append({ TextMatcher::Utf16Length(base + line_start, match.offset - line_start), 0, match.pattern });
+            }
             
-            if (match.hasMatch()) {
+            for (const TextMatcher::Span& hit : hits) {
                 DbSearchResult result;
                 result.file_id = file_id;
+                result.archive_id = archive_id;
                 result.file_name = file_name;
                 result.keyword = keyword;
-                result.line_number = i + 1;
+                result.line_number = static_cast<int>(first_line + line_index) + 1;
                 result.line_content = line;
                 result.preview = line.length() > 50 ? line.left(50) + "..." : line;
-                result.match_position = match.capturedStart();
-                
-                results.append(result);
+                result.match_position = static_cast<int>(hit.start);
+                result.matched_term = matcher.Patterns().value(hit.pattern);
                 
-                if (results.size() >= max_results) {
+                collector.Add(result);
+                if (collector.Done()) {
                     return;
                 }
             }
+            // 同一行只记一次，从下一行继续
+            if (!line_end) {
+                break;
+            }
+            line_start = line_end + 1 - base;
+            ++line_index;
         }
     }
 }
 
-int SqliteDbManager::GetTotalFileCount() {
-    QMutexLocker locker(&m_mutex_);
-    
-    QSqlQuery query(m_database_);
-    if (query.exec("SELECT COUNT(*) FROM files") && query.next()) {
-        return query.value(0).toInt();
+int SqliteDbManager::GetTotalFileCount(const QList<int>& archive_ids) {
+    int total = 0;
+    for (const DbKeywordSummary& summary : GetKeywordSummaries(archive_ids)) {
+        total += summary.file_count;
     }
-    return 0;
+    return total;
 }
 
-qint64 SqliteDbManager::GetTotalSize() {
-    QMutexLocker locker(&m_mutex_);
-    
-    QSqlQuery query(m_database_);
-    if (query.exec("SELECT SUM(file_size) FROM files") && query.next()) {
-        return query.value(0).toLongLong();
+qint64 SqliteDbManager::GetTotalSize(const QList<int>& archive_ids) {
+    qint64 total = 0;
+    for (const DbKeywordSummary& summary : GetKeywordSummaries(archive_ids)) {
+        total += summary.total_size;
     }
-    return 0;
+    return total;
 }
 
-QMap<QString, int> SqliteDbManager::GetFileCountByCategory() {
-    QMutexLocker locker(&m_mutex_);
-    
+QMap<QString, int> SqliteDbManager::GetFileCountByCategory(const QList<int>& archive_ids) {
     QMap<QString, int> counts;
-    
-    QSqlQuery query(m_database_);
-    if (query.exec("SELECT category, COUNT(*) FROM files GROUP BY category")) {
-        while (query.next()) {
-            counts[query.value(0).toString()] = query.value(1).toInt();
-        }
+    for (const DbKeywordSummary& summary : GetKeywordSummaries(archive_ids)) {
+        counts[summary.category] += summary.file_count;
     }
-    
     return counts;
 }
 
@@ -546,6 +2437,7 @@ DbSearchWorker::DbSearchWorker(SqliteDbManager* db_manager, QObject* parent)
     , m_db_manager_(db_manager)
     , m_max_results_(100)
     , m_cancelled_(false)
+    , m_search_id_(0)
     , m_is_full_search_(false) {
 }
 
@@ -553,22 +2445,27 @@ DbSearchWorker::~DbSearchWorker() {
     m_cancelled_ = true;
 }
 
-void DbSearchWorker::SetSearchData(const QString& keyword, const QString& search_text, int max_results) {
+void DbSearchWorker::SetSearchData(const QString& keyword, const QStringList& search_terms, int max_results,
+                                   const TextMatcher::Options& options) {
     QMutexLocker locker(&m_mutex_);
     m_keyword_ = keyword;
-    m_search_text_ = search_text;
+    m_search_terms_ = search_terms;
+    m_options_ = options;
     m_max_results_ = max_results;
     m_is_full_search_ = false;
     m_cancelled_ = false;
+    ++m_search_id_;
 }
 
-void DbSearchWorker::SetFullSearchData(const QString& search_text, int max_results) {
+void DbSearchWorker::SetFullSearchData(const QStringList& search_terms, int max_results, const TextMatcher::Options& options) {
     QMutexLocker locker(&m_mutex_);
     m_keyword_.clear();
-    m_search_text_ = search_text;
+    m_search_terms_ = search_terms;
+    m_options_ = options;
     m_max_results_ = max_results;
     m_is_full_search_ = true;
     m_cancelled_ = false;
+    ++m_search_id_;
 }
 
 void DbSearchWorker::CancelSearch() {
@@ -576,85 +2473,221 @@ void DbSearchWorker::CancelSearch() {
 }
 
 void DbSearchWorker::StartSearch() {
-    qDebug() << "开始数据库搜索，搜索词：" << m_search_text_;
+    // GUI线程可能在上一次搜索进行中设置新的搜索数据，这里先在锁内取一份副本
+    QString keyword;
+    QStringList search_terms;
+    TextMatcher::Options options;
+    int max_results;
+    bool is_full_search;
+    int search_id;
+    {
+        QMutexLocker locker(&m_mutex_);
+        keyword = m_keyword_;
+        search_terms = m_search_terms_;
+        options = m_options_;
+        max_results = m_max_results_;
+        is_full_search = m_is_full_search_;
+        search_id = m_search_id_;
+    }
+    qDebug() << "开始数据库搜索，搜索词：" << search_terms;
+    
+    if (search_terms.join(QString()).isEmpty()) {
+        emit searchFinished(search_id);
+        return;
+    }
     
-    if (m_search_text_.isEmpty()) {
-        emit searchFinished();
+    // 搜索词无效时不必查库
+    if (!TextMatcher::Create(search_terms, options)->IsValid()) {
+        qWarning() << "搜索词无效（正则表达式错误？）：" << search_terms;
+        emit searchFinished(search_id);
         return;
     }
     
-    // 执行数据库搜索
+    // 执行数据库搜索，结果边找边分批发出；取消或有新的搜索设置进来时提前结束
+    auto is_cancelled = [this, search_id]() { return m_cancelled_ || m_search_id_ != search_id; };
+    auto on_batch = [this, search_id](const QList<DbSearchResult>& batch) {
+        emit searchResultsBatch(search_id, batch);
+    };
+    
+    QElapsedTimer timer;
+    timer.start();
     QList<DbSearchResult> results;
+    if (is_full_search) {
+        results = m_db_manager_->SearchInFiles(search_terms, max_results, QList<int>(), options,
+                                               on_batch, is_cancelled);
+    } else if (!keyword.isEmpty()) {
+        results = m_db_manager_->SearchInKeyword(keyword, search_terms, max_results, QList<int>(), options,
+                                                 on_batch, is_cancelled);
+    }
+    qDebug() << "数据库搜索完成：" << results.size() << "条结果，耗时" << timer.elapsed() << "ms";
+    
+    if (is_cancelled()) {
+        emit searchCancelled(search_id);
+        return;
+    }
+    
+    emit searchFinished(search_id);
+}
+
+// ==================== DbImportWorker 实现 ====================
+
+DbImportWorker::DbImportWorker(SqliteDbManager* db_manager, const Classifier& classifier,
+                               const Classifier& category_resolver, QObject* parent)
+    : QObject(parent)
+    , m_db_manager_(db_manager)
+    , m_classifier_(classifier)
+    , m_category_resolver_(category_resolver)
+    , m_cancelled_(false) {
+}
+
+DbImportWorker::~DbImportWorker() {
+    m_cancelled_ = true;
+}
+
+void DbImportWorker::CancelImport() {
+    m_cancelled_ = true;
+}
+
+void DbImportWorker::ResetCancel() {
+    m_cancelled_ = false;
+}
+
+void DbImportWorker::StartImport(const QString& zip_path, qint64 memory_budget) {
+    qDebug() << "开始后台导入：" << zip_path;
+    
+    QElapsedTimer timer;
+    timer.start();
+    emit importProgress(2);
     
-    if (m_is_full_search_) {
-        results = m_db_manager_->SearchInFiles(m_search_text_, m_max_results_);
-    } else if (!m_keyword_.isEmpty()) {
-        results = m_db_manager_->SearchInKeyword(m_keyword_, m_search_text_, m_max_results_);
+    // 进程内读取ZIP中央目录，不再调用外部解压工具
+    ZipArchiveReader reader(zip_path);
+    if (!reader.Open()) {
+        emit importFailed(QString("ZIP文件处理错误：ZIP文件读取失败：%1").arg(reader.ErrorString()));
+        return;
     }
     
     if (m_cancelled_) {
-        emit searchCancelled();
+        emit importCancelled();
         return;
     }
+    emit importProgress(5);
     
-    // 生成高亮内容
-    QString highlighted_content;
-    if (!m_keyword_.isEmpty()) {
-        QString content = m_db_manager_->GetMergedContentByKeyword(m_keyword_);
-        highlighted_content = HighlightSearchResults(content, m_search_text_);
+    // 解压/解码/索引在线程池上并行执行，由唯一的写线程写入该归档自己的数据库文件；
+    // 只导入新增或变化的条目，旧条目在同一事务中删除，取消时整体回滚
+    QFileInfo zip_info(zip_path);
+    QString archive_fingerprint = XxHash64::ToHex(reader.DirectoryHash());
+    
+    // 同一路径的归档复用已有的归档文件做增量导入，其余归档不受影响；
+    // 归档按绝对路径识别，界面上只显示文件名
+    const QString source_path = zip_info.absoluteFilePath();
+    DbArchiveInfo archive = m_db_manager_->FindArchiveBySource(source_path);
+    bool is_new_archive = archive.id == 0;
+    if (is_new_archive) {
+        archive = m_db_manager_->GetArchive(m_db_manager_->CreateArchive(zip_info.fileName(), source_path));
+        if (archive.id == 0) {
+            emit importFailed("ZIP文件处理错误：无法创建归档数据库");
+            return;
+        }
+    } else if (archive.source_path.isEmpty()) {
+        // 旧版本的归档记录补上来源路径，之后同名的其他ZIP不再匹配到它
+        m_db_manager_->SetArchiveSourcePath(archive.id, source_path);
     }
+    // 导入失败或取消时，删除本次新建的归档
+    auto discard_new_archive = [this, &archive, is_new_archive]() {
+        if (is_new_archive) {
+            m_db_manager_->DropArchive(archive.id);
+        }
+    };
     
-    emit searchResultReady(results, highlighted_content);
-    emit searchFinished();
-}
-
-QString DbSearchWorker::HighlightSearchResults(const QString& content, const QString& search_text) {
-    QString highlighted;
-    QStringList lines = content.split('\n');
-    QRegularExpression search_regex(QRegularExpression::escape(search_text), 
-                                   QRegularExpression::CaseInsensitiveOption);
+    ImportPipeline pipeline(archive.db_file, reader, zip_info.fileName());
+    pipeline.SetMemoryBudget(memory_budget);
+    pipeline.SetClassifier(m_classifier_);
+    pipeline.SetCategoryResolver(m_category_resolver_);
+    pipeline.SetCancelFlag(&m_cancelled_);
+    if (is_new_archive) {
+        // 新归档为空库，延后建索引不需要重建已有数据
+        pipeline.SetBulkLoad(true);
+    } else {
+        pipeline.SetExistingEntries(m_db_manager_->GetEntryStates(archive.id));
+    }
+    pipeline.Prepare();
+    
+    // 同一归档重新打开：只做元数据比对，不开启写事务
+    if (!pipeline.HasChanges() && !is_new_archive && archive_fingerprint == archive.fingerprint) {
+        qDebug() << "归档未变化，跳过导入：" << zip_path << "指纹:" << archive_fingerprint;
+        m_db_manager_->SetActiveArchives({ archive.id });
+        emit importProgress(95);
+        EmitImportFinished(pipeline.UnchangedFileCount(), 0, timer);
+        return;
+    }
     
-    for (const QString& line : lines) {
-        QString highlighted_line = line;
-        QRegularExpressionMatch match = search_regex.match(line);
-        
-        if (match.hasMatch()) {
-            // 高亮匹配的文本
-            int offset = 0;
-            while (true) {
-                match = search_regex.match(highlighted_line, offset);
-                if (!match.hasMatch()) break;
-                
-                int start = match.capturedStart();
-                int length = match.capturedLength();
-                
-                highlighted_line.replace(
-                    start, length,
-                    QString("<span style=\"background-color: #DBEAFE; color: #1D4ED8; font-weight: bold;\">%1</span>")
-                        .arg(highlighted_line.mid(start, length))
-                );
-                
-                offset = start + length + 73; // 跳过高亮标签
-            }
-        } else {
-            // HTML转义
-            highlighted_line.replace("&", "&amp;")
-                           .replace("<", "&lt;")
-                           .replace(">", "&gt;");
+    int last_progress = -1;
+    QString last_entry;
+    pipeline.SetProgressHandler([this, &last_progress, &last_entry](const QString& entry_name, int done, int total,
+                                                                   qint64 bytes_done, qint64 bytes_total) {
+        // 写入阶段占总进度的5%~95%，按字节计算；只在数值变化时发信号，避免淹没GUI事件队列
+        // 压缩成员展开后的字节数会超过条目大小，进度只是估算，封顶95
+        int progress = qMin(95, 5 + static_cast<int>((bytes_done * 90) / qMax<qint64>(1, bytes_total)));
+        if (progress != last_progress) {
+            last_progress = progress;
+            emit importProgress(progress);
         }
-        
-        highlighted += QString("<p style=\"margin: 0; padding: 4px 0; line-height: 1.5; border-bottom: 1px solid #F3F4F6;\">%1</p>")
-                            .arg(highlighted_line.isEmpty() ? "&nbsp;" : highlighted_line);
+        if (entry_name != last_entry) {
+            last_entry = entry_name;
+            emit entryProgress(entry_name, qMin(done + 1, total), total);
+        }
+    });
+    
+    bool ok = pipeline.Run();
+    if (pipeline.WasCancelled()) {
+        qDebug() << "导入已取消，事务已回滚";
+        discard_new_archive();
+        emit importCancelled();
+        return;
+    }
+    if (!ok) {
+        discard_new_archive();
+        emit importFailed(QString("ZIP文件处理错误：无法将文件导入数据库：%1").arg(pipeline.ErrorString()));
+        return;
+    }
+    int file_count = pipeline.ImportedFileCount() + pipeline.UnchangedFileCount();
+    if (file_count == 0) {
+        discard_new_archive();
+        emit importFailed("ZIP文件处理错误：ZIP文件中未找到可识别的文本文件");
+        return;
+    }
+    
+    // 内容提交后再记录归档指纹，指纹为空的归档不会被当作已完成
+    m_db_manager_->UpdateArchive(archive.id, archive_fingerprint, reader.ArchiveSize());
+    m_db_manager_->SetActiveArchives({ archive.id });
+    
+    emit importProgress(96);
+    
+    qDebug() << "后台导入完成，新导入" << pipeline.ImportedFileCount() << "个，未变化" << pipeline.UnchangedFileCount()
+             << "个，删除" << pipeline.RemovedFileCount() << "个，解压失败" << pipeline.FailedEntryCount()
+             << "个，耗时" << timer.elapsed() << "ms";
+    EmitImportFinished(file_count, pipeline.FailedEntryCount(), timer);
+}
+
+void DbImportWorker::EmitImportFinished(int file_count, int failed_entries, const QElapsedTimer& timer) {
+    // 只查元数据确定默认关键字，内容由页面经requestFileContent按需读取：
+    // 归档未变化时整个重新打开只做元数据比对，不解压合并文本
+    QString first_keyword;
+    QStringList keywords = m_db_manager_->GetAllKeywords();
+    if (!keywords.isEmpty()) {
+        first_keyword = keywords.first();
     }
     
-    return highlighted;
+    emit importFinished(file_count, failed_entries, timer.elapsed(), first_keyword);
 }
 
 // ==================== SqliteTextHandler 实现 ====================
 
 SqliteTextHandler::SqliteTextHandler(QObject* parent)
     : QObject(parent)
-    , m_cancel_loading_(false) {
+    , m_cancel_loading_(false)
+    , m_import_memory_budget_(ImportPipeline::k_default_memory_budget_)
+    , m_is_importing_(false) {
     
     qDebug() << "SqliteTextHandler 构造函数开始";
     
@@ -667,19 +2700,24 @@ SqliteTextHandler::SqliteTextHandler(QObject* parent)
     connect(m_db_manager_.get(), &SqliteDbManager::progressUpdate,
             this, &SqliteTextHandler::loadProgress);
     
-    // 初始化文件列表模型
+    // 初始化文件列表模型、搜索结果模型和文本内容行模型
     m_file_list_model_ = new FileListModel(this);
+    m_search_result_model_ = new SearchResultModel(this);
+    m_text_line_model_ = new TextLineModel(this);
     
     // 初始化搜索线程
     InitializeSearchThread();
     
+    // 初始化导入线程
+    InitializeImportThread();
+    
     // 自动初始化数据库
     initializeDatabase();
 }
 
 SqliteTextHandler::~SqliteTextHandler() {
+    CleanupImportThread();
     cleanupSearchThread();
-    CleanupTempFiles();
 }
 
 bool SqliteTextHandler::initializeDatabase(const QString& db_path) {
@@ -690,20 +2728,222 @@ bool SqliteTextHandler::initializeDatabase(const QString& db_path) {
     return false;
 }
 
-void SqliteTextHandler::clearDatabase() {
-    m_db_manager_->DeleteAllFiles();
+bool SqliteTextHandler::startEphemeralSession() {
+    if (m_is_importing_) {
+        qWarning() << "导入进行中，不能切换数据库";
+        return false;
+    }
+    
+    bool ok = m_db_manager_->InitializeEphemeralDatabase();
     UpdateFileListModel();
+    emit archivesChanged();
+    if (ok) {
+        emit databaseInitialized();
+    }
+    return ok;
+}
+
+bool SqliteTextHandler::isEphemeralSession() const {
+    return m_db_manager_->IsEphemeral();
+}
+
+QString SqliteTextHandler::keepAnalysis(const QString& db_path) {
+    QString path = db_path;
+    if (path.isEmpty()) {
+        QString docs_path = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+        path = QString("%1/log_analyzer_%2.db").arg(docs_path, QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+    }
+    return m_db_manager_->PersistSession(path) ? path : QString();
+}
+
+void SqliteTextHandler::clearDatabase() {
+    // 在导入线程上删除归档文件，与之后投递的导入任务保持先后顺序，GUI线程不等待
+    m_content_future_.cancel();
+    SqliteDbManager* db_manager = m_db_manager_.get();
+    auto drop_all = [this, db_manager]() {
+        db_manager->DropAllArchives();
+        QMetaObject::invokeMethod(this, [this]() {
+            UpdateFileListModel();
+            emit archivesChanged();
+        }, Qt::QueuedConnection);
+    };
+    if (m_import_worker_) {
+        QMetaObject::invokeMethod(m_import_worker_, drop_all, Qt::QueuedConnection);
+    } else {
+        drop_all();
+    }
 }
 
 QVariantMap SqliteTextHandler::getDatabaseStats() {
+    return BuildDatabaseStats(m_db_manager_.get());
+}
+
+void SqliteTextHandler::requestDatabaseStats() {
+    SqliteDbManager* db_manager = m_db_manager_.get();
+    m_db_manager_->RunAsync<QVariantMap>([db_manager](QPromise<QVariantMap>& promise) {
+        promise.addResult(BuildDatabaseStats(db_manager));
+    }).then(this, [this](const QVariantMap& stats) {
+        emit databaseStatsReady(stats);
+    });
+}
+
+QVariantMap SqliteTextHandler::BuildDatabaseStats(SqliteDbManager* db_manager) {
+    // 全部由keyword_stats的预计算行汇总，与数据库大小无关
+    int total_files = 0;
+    qint64 total_size = 0;
+    qint64 total_lines = 0;
+    qint64 total_errors = 0;
+    qint64 total_warnings = 0;
+    QVariantMap categories;
+    QStringList keywords;
+    QVariantList keyword_stats;
+    for (const DbKeywordSummary& summary : db_manager->GetKeywordSummaries()) {
+        total_files += summary.file_count;
+        total_size += summary.total_size;
+        total_lines += summary.line_count;
+        total_errors += summary.error_count;
+        total_warnings += summary.warning_count;
+        categories[summary.category] = categories.value(summary.category).toInt() + summary.file_count;
+        keywords.append(summary.keyword);
+        
+        QVariantMap item;
+        item["keyword"] = summary.keyword;
+        item["category"] = summary.category;
+        item["fileCount"] = summary.file_count;
+        item["totalSize"] = summary.total_size;
+        item["lineCount"] = summary.line_count;
+        item["startMs"] = summary.first_time;
+        item["endMs"] = summary.last_time;
+        item["errorCount"] = summary.error_count;
+        item["warningCount"] = summary.warning_count;
+        keyword_stats.append(item);
+    }
+    
     QVariantMap stats;
-    stats["totalFiles"] = m_db_manager_->GetTotalFileCount();
-    stats["totalSize"] = m_db_manager_->GetTotalSize();
-    stats["categories"] = QVariant::fromValue(m_db_manager_->GetFileCountByCategory());
-    stats["keywords"] = m_db_manager_->GetAllKeywords();
+    stats["totalFiles"] = total_files;
+    stats["totalSize"] = total_size;
+    stats["totalLines"] = total_lines;
+    stats["errorCount"] = total_errors;
+    stats["warningCount"] = total_warnings;
+    stats["categories"] = categories;
+    stats["keywords"] = keywords;
+    stats["keywordStats"] = keyword_stats;
+    stats["archives"] = db_manager->AllArchiveIds().size();
+    stats["activeArchives"] = db_manager->ActiveArchives().size();
     return stats;
 }
 
+QVariantList SqliteTextHandler::getArchives() {
+    QVariantList archives;
+    QList<int> active = m_db_manager_->ActiveArchives();
+    
+    for (const DbArchiveInfo& info : m_db_manager_->GetArchives()) {
+        if (info.fingerprint.isEmpty()) {
+            continue;   // 正在导入或导入未完成
+        }
+        QVariantMap map;
+        map["id"] = info.id;
+        map["zipSource"] = info.zip_source;
+        map["sourcePath"] = info.source_path;
+        map["archiveSize"] = info.archive_size;
+        map["importTime"] = info.import_time;
+        map["active"] = active.contains(info.id);
+        
+        // 每个归档的keyword_stats行数很少，逐个汇总
+        int file_count = 0;
+        qint64 total_size = 0;
+        for (const DbKeywordSummary& summary : m_db_manager_->GetKeywordSummaries({ info.id })) {
+            file_count += summary.file_count;
+            total_size += summary.total_size;
+        }
+        map["fileCount"] = file_count;
+        map["totalSize"] = total_size;
+        archives.append(map);
+    }
+    return archives;
+}
+
+bool SqliteTextHandler::setActiveArchives(const QVariantList& archive_ids) {
+    QList<int> ids;
+    for (const QVariant& id : archive_ids) {
+        ids.append(id.toInt());
+    }
+    
+    bool ok = m_db_manager_->SetActiveArchives(ids);
+    UpdateFileListModel();
+    emit archivesChanged();
+    return ok;
+}
+
+bool SqliteTextHandler::dropArchive(int archive_id) {
+    if (m_is_importing_) {
+        qWarning() << "导入进行中，不能删除归档";
+        return false;
+    }
+    
+    bool ok = m_db_manager_->DropArchive(archive_id);
+    UpdateFileListModel();
+    emit archivesChanged();
+    return ok;
+}
+
+qint64 SqliteTextHandler::getKeywordLineCount(const QString& keyword) {
+    return m_db_manager_->GetKeywordLineCount(keyword);
+}
+
+QStringList SqliteTextHandler::getKeywordLines(const QString& keyword, qint64 first_line, int line_count) {
+    return m_db_manager_->GetKeywordLines(keyword, first_line, line_count);
+}
+
+QVariantMap SqliteTextHandler::getTimeRange(const QString& keyword) {
+    QVariantMap range;
+    qint64 first_time = 0;
+    qint64 last_time = 0;
+    bool valid = m_db_manager_->GetKeywordTimeRange(keyword, &first_time, &last_time);
+    range["valid"] = valid;
+    if (valid) {
+        range["start"] = LineTimeIndex::Format(first_time);
+        range["end"] = LineTimeIndex::Format(last_time);
+        range["startMs"] = first_time;
+        range["endMs"] = last_time;
+    }
+    return range;
+}
+
+qint64 SqliteTextHandler::findLineAtTime(const QString& keyword, const QString& time_text) {
+    qint64 time = LineTimeIndex::ParseText(time_text);
+    if (time < 0) {
+        qWarning() << "无法解析时间:" << time_text;
+        return -1;
+    }
+    return m_db_manager_->FindKeywordLineAtTime(keyword, time);
+}
+
+QVariantList SqliteTextHandler::getLinesInTimeWindow(const QString& keyword, const QString& from_text,
+                                                     const QString& to_text, int max_lines) {
+    QVariantList result;
+    qint64 from_time = LineTimeIndex::ParseText(from_text);
+    qint64 to_time = LineTimeIndex::ParseText(to_text);
+    if (from_time < 0 || to_time < 0) {
+        qWarning() << "无法解析时间窗口:" << from_text << to_text;
+        return result;
+    }
+    for (qint64 line : m_db_manager_->GetKeywordLinesInTimeWindow(keyword, from_time, to_time, max_lines)) {
+        result.append(line);
+    }
+    return result;
+}
+
+void SqliteTextHandler::setImportMemoryLimit(int megabytes) {
+    // 过小的上限会让流水线退化为单线程，但仍能完成导入
+    m_import_memory_budget_ = qMax(16, megabytes) * 1024ll * 1024;
+    qDebug() << "导入内存上限设置为" << m_import_memory_budget_ / (1024 * 1024) << "MB";
+}
+
+int SqliteTextHandler::importMemoryLimit() const {
+    return static_cast<int>(m_import_memory_budget_ / (1024 * 1024));
+}
+
 void SqliteTextHandler::InitializeSearchThread() {
     qDebug() << "初始化搜索线程";
     
@@ -714,24 +2954,41 @@ void SqliteTextHandler::InitializeSearchThread() {
     // 连接信号
     connect(m_search_worker_, &DbSearchWorker::searchProgress,
             this, &SqliteTextHandler::searchProgress);
-    connect(m_search_worker_, &DbSearchWorker::searchResultReady,
-            this, [this](const QList<DbSearchResult>& results, const QString& highlighted_content) {
-        QVariantList variant_results;
-        for (const auto& result : results) {
-            QVariantMap map;
-            map["lineNumber"] = result.line_number;
-            map["preview"] = result.preview;
-            map["fullLine"] = result.line_content;
-            map["fileName"] = result.file_name;
-            map["keyword"] = result.keyword;
-            variant_results.append(map);
-        }
-        emit searchResultReady(variant_results, highlighted_content);
+    // 旧搜索晚到的批次直接丢弃
+    connect(m_search_worker_, &DbSearchWorker::searchResultsBatch,
+            this, [this](int search_id, const QList<DbSearchResult>& batch) {
+        if (!m_search_worker_ || search_id != m_search_worker_->CurrentSearchId()) {
+            return;
+        }
+        QList<SearchResult> rows;
+        rows.reserve(batch.size());
+        for (const DbSearchResult& result : batch) {
+            SearchResult row;
+            row.lineNumber = result.line_number;
+            row.preview = result.preview;
+            row.fullLine = result.line_content;
+            row.fileName = result.file_name;
+            row.keyword = result.keyword;
+            row.archiveId = result.archive_id;
+            row.term = result.matched_term;
+            rows.append(row);
+        }
+        m_search_result_model_->appendResults(rows);
     });
+    // 被新搜索取代的旧搜索也会结束或取消，只转发当前搜索的，
+    // 否则页面会在新搜索进行中收到旧搜索的取消而清掉搜索状态
     connect(m_search_worker_, &DbSearchWorker::searchFinished,
-            this, &SqliteTextHandler::searchFinished);
+            this, [this](int search_id) {
+        if (m_search_worker_ && search_id == m_search_worker_->CurrentSearchId()) {
+            emit searchFinished();
+        }
+    });
     connect(m_search_worker_, &DbSearchWorker::searchCancelled,
-            this, &SqliteTextHandler::searchCancelled);
+            this, [this](int search_id) {
+        if (m_search_worker_ && search_id == m_search_worker_->CurrentSearchId()) {
+            emit searchCancelled();
+        }
+    });
     
     m_search_thread_->start();
     qDebug() << "搜索线程已启动";
@@ -762,6 +3019,56 @@ void SqliteTextHandler::cleanupSearchThread() {
     qDebug() << "搜索线程清理完成";
 }
 
+void SqliteTextHandler::InitializeImportThread() {
+    qDebug() << "初始化导入线程";
+    
+    m_import_thread_ = std::make_unique<QThread>();
+    m_import_worker_ = new DbImportWorker(
+        m_db_manager_.get(),
+        [this](const QString& file_name) { return GetFileKeyword(file_name); },
+        [this](const QString& keyword) { return GetFileCategory(keyword); });
+    m_import_worker_->moveToThread(m_import_thread_.get());
+    
+    // 连接信号（跨线程，排队投递到GUI线程）
+    connect(m_import_worker_, &DbImportWorker::importProgress,
+            this, &SqliteTextHandler::loadProgress);
+    connect(m_import_worker_, &DbImportWorker::entryProgress,
+            this, &SqliteTextHandler::entryProgress);
+    connect(m_import_worker_, &DbImportWorker::importFinished,
+            this, &SqliteTextHandler::OnImportFinished);
+    connect(m_import_worker_, &DbImportWorker::importCancelled,
+            this, [this]() {
+        m_is_importing_ = false;
+        emit importCancelled();
+    });
+    connect(m_import_worker_, &DbImportWorker::importFailed,
+            this, [this](const QString& error_message) {
+        m_is_importing_ = false;
+        emit loadError(error_message);
+    });
+    
+    m_import_thread_->start();
+    qDebug() << "导入线程已启动";
+}
+
+void SqliteTextHandler::CleanupImportThread() {
+    if (m_import_worker_) {
+        m_import_worker_->CancelImport();
+    }
+    
+    if (m_import_thread_ && m_import_thread_->isRunning()) {
+        m_import_thread_->quit();
+        m_import_thread_->wait();
+    }
+    
+    if (m_import_worker_) {
+        delete m_import_worker_;
+        m_import_worker_ = nullptr;
+    }
+    
+    m_import_thread_.reset();
+}
+
 void SqliteTextHandler::loadTextFileAsync(const QString& file_name) {
     m_cancel_loading_ = false;
     
@@ -785,307 +3092,79 @@ void SqliteTextHandler::loadTextFileAsync(const QString& file_name) {
     
     // 检查是否为ZIP文件
     if (selected_file_name.toLower().endsWith(".zip")) {
-        try {
-            ProcessZipFile(selected_file_name);
-        } catch (const std::exception& e) {
-            emit loadError(QString("ZIP文件处理错误：%1").arg(e.what()));
-        }
+        ProcessZipFile(selected_file_name);
         return;
     }
     
 }
 
 void SqliteTextHandler::ProcessZipFile(const QString& zip_path) {
-    emit loadProgress(10);
-    
-    // 清理之前的临时文件
-    CleanupTempFiles();
-    m_temp_dir_ = std::make_unique<QTemporaryDir>();
-    if (!m_temp_dir_->isValid()) {
-        throw std::runtime_error("无法创建临时目录");
-    }
-    
-    emit loadProgress(20);
-    
-    // 解压ZIP文件
-    if (!ExtractZipFile(zip_path, m_temp_dir_->path())) {
-        throw std::runtime_error("ZIP文件解压失败");
+    if (m_is_importing_) {
+        emit loadError("已有导入任务正在进行，请等待完成或取消后再试");
+        return;
     }
-    
-    emit loadProgress(60);
-    
-    // 扫描并导入文本文件到数据库
-    QFileInfo zip_info(zip_path);
-    QList<DbFileRecord> records = ScanAndImportTextFiles(m_temp_dir_->path(), zip_info.fileName());
-    
-    if (records.isEmpty()) {
-        throw std::runtime_error("ZIP文件中未找到可识别的文本文件");
+    if (!m_import_worker_) {
+        emit loadError("导入工作对象未初始化");
+        return;
     }
     
-    emit loadProgress(80);
+    m_is_importing_ = true;
+    m_import_worker_->ResetCancel();
+    emit loadProgress(0);
     
-    // 批量插入到数据库
-    if (!m_db_manager_->InsertFiles(records)) {
-        throw std::runtime_error("无法将文件导入数据库");
-    }
+    // 整个导入过程在导入线程中执行，GUI线程只接收进度与完成信号
+    QMetaObject::invokeMethod(m_import_worker_, "StartImport", Qt::QueuedConnection,
+                              Q_ARG(QString, zip_path), Q_ARG(qint64, m_import_memory_budget_));
+}
+
+void SqliteTextHandler::OnImportFinished(int file_count, int failed_entries, qint64 elapsed_ms,
+                                         const QString& first_keyword) {
+    m_is_importing_ = false;
     
     // 更新文件列表模型
     UpdateFileListModel();
     
     emit loadProgress(100);
+    emit importFinished(file_count, elapsed_ms, failed_entries);
+    emit archivesChanged();
     
-    // 自动加载第一个关键字的内容
-    QStringList keywords = m_db_manager_->GetAllKeywords();
-    if (!keywords.isEmpty()) {
-        m_current_keyword_ = keywords.first();
-        QString content = m_db_manager_->GetMergedContentByKeyword(m_current_keyword_);
-        emit fileLoaded(content);
-    }
-}
-
-bool SqliteTextHandler::ExtractZipFile(const QString& zip_path, const QString& extract_dir) {
-    qDebug() << "开始解压ZIP文件:" << zip_path << "到目录:" << extract_dir;
-
-    // 确保目标目录存在
-    QDir dir(extract_dir);
-    if (!dir.exists()) {
-        if (!dir.mkpath(".")) {
-            qDebug() << "无法创建解压目录:" << extract_dir;
-            return false;
-        }
-    }
-
-    // 方案1: 优先使用 tar (Windows 10/11 内置)
-    QProcess process;
-    
-#ifdef Q_OS_WIN
-    QString command = "tar";
-    QStringList arguments;
-    QString normalized_zip_path = QDir::toNativeSeparators(zip_path);
-    normalized_zip_path.remove(QRegularExpression("^\"|\"$"));
-    QString normalized_extract_dir = QDir::toNativeSeparators(extract_dir);
-    normalized_extract_dir.remove(QRegularExpression("^\"|\"$"));
-    arguments << "-xf" << normalized_zip_path << "-C" << normalized_extract_dir;
-#else
-    QString command = "unzip"; // Unix/Linux/Mac系统使用unzip命令
-    QStringList arguments;
-    arguments << "-o" << zip_path << "-d" << extract_dir;
-#endif
-    
-    qDebug() << "解压命令:" << command << arguments;
-    process.start(command, arguments);
-    bool finished = process.waitForFinished(30000);
-
-    qDebug() << "解压是否完成:" << finished;
-    qDebug() << "解压命令退出码:" << process.exitCode();
-    qDebug() << "标准输出:" << process.readAllStandardOutput();
-    qDebug() << "错误输出:" << process.readAllStandardError();
-    
-    if (finished && process.exitCode() == 0) {
-        QDir extracted_dir(extract_dir);
-        // 解压空包也算成功
-        qDebug() << "解压成功:" << command;
-        return true;
-    }
-
-    // 方案2: 备用方案 7-Zip
-    qDebug() << command << "解压失败，尝试备用解压方案 7-Zip";
-    
-    QProcess sevenZipProcess;
-    QString sevenZipCommand = "7z";
-    QStringList sevenZipArgs;
-
-    QString normalized_zip_path_7z = QDir::toNativeSeparators(zip_path);
-    normalized_zip_path_7z.remove(QRegularExpression("^\"|\"$"));
-    QString normalized_extract_dir_7z = QDir::toNativeSeparators(extract_dir);
-    normalized_extract_dir_7z.remove(QRegularExpression("^\"|\"$"));
-
-    sevenZipArgs << "x" << normalized_zip_path_7z << QString("-o%1").arg(normalized_extract_dir_7z) << "-y";
-    
-    qDebug() << "7-Zip解压命令:" << sevenZipCommand << sevenZipArgs;
-    
-    sevenZipProcess.start(sevenZipCommand, sevenZipArgs);
-    bool sevenZipFinished = sevenZipProcess.waitForFinished(30000);
-
-    qDebug() << "7-Zip解压是否完成:" << sevenZipFinished;
-    qDebug() << "7-Zip解压命令退出码:" << sevenZipProcess.exitCode();
-    qDebug() << "7-Zip标准输出:" << sevenZipProcess.readAllStandardOutput();
-    qDebug() << "7-Zip错误输出:" << sevenZipProcess.readAllStandardError();
-
-    if (sevenZipFinished && sevenZipProcess.exitCode() == 0) {
-         qDebug() << "7-Zip解压成功。";
-         return true;
-    }
-
-    qDebug() << "所有解压方案均失败";
-    return false;
-}
-
-QList<DbFileRecord> SqliteTextHandler::ScanAndImportTextFiles(const QString& dir_path, const QString& zip_source) {
-    qDebug() << "扫描文本文件，目录:" << dir_path;
-    
-    // 在导入前，先删除该zip_source的所有旧记录
-    m_db_manager_->DeleteAllFiles();
-    
-    QList<DbFileRecord> records;
-    QDir dir(dir_path);
-    
-    if (!dir.exists()) {
-        return records;
-    }
-    
-    QFileInfoList all_entries = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
-    
-    for (const QFileInfo& file_info : all_entries) {
-        if (file_info.isDir()) {
-            // 递归扫描子目录
-            records.append(ScanAndImportTextFiles(file_info.absoluteFilePath(), zip_source));
-        } else {
-            QString keyword = GetFileKeyword(file_info.fileName());
-            if (!keyword.isEmpty()) {
-                // 读取文件内容
-                QFile file(file_info.absoluteFilePath());
-                if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                    QTextStream in(&file);
-                    in.setEncoding(QStringConverter::Utf8);
-                    QString content = in.readAll();
-                    file.close();
-                    
-                    DbFileRecord record;
-                    record.file_path = file_info.absoluteFilePath();
-                    record.file_name = file_info.fileName();
-                    record.keyword = keyword;
-                    record.category = GetFileCategory(keyword);
-                    record.content = content;
-                    record.file_size = file_info.size();
-                    record.zip_source = zip_source;
-                    record.import_time = QDateTime::currentDateTime();
-                    
-                    records.append(record);
-                    qDebug() << "添加文件记录:" << file_info.fileName() << "关键字:" << keyword;
-                }
-            }
-        }
+    // 默认关键字的内容不在这里读取：fileListReady之后页面选中第一项，经requestFileContent异步加载
+    if (!first_keyword.isEmpty()) {
+        m_current_keyword_ = first_keyword;
+        emit fileLoaded();
     }
-    
-    qDebug() << "扫描完成，找到" << records.size() << "个文本文件";
-    return records;
 }
 
 QString SqliteTextHandler::GetFileKeyword(const QString& file_name) {
-    QString lower_file_name = file_name.toLower();
-    
-    // 定义关键字模式（与原TextFileHandler保持一致）
-    struct KeywordPattern {
-        QString keyword;
-        QRegularExpression exact_regex;
-        QRegularExpression numbered_regex;
-    };
-    
-    QList<KeywordPattern> patterns = {
-        // {"master", QRegularExpression("^master$"), QRegularExpression("^master\\.\\d+$")},
-        // {"chassis", QRegularExpression("^chassis$"), QRegularExpression("^chassis\\..*$")},
-        // {"guidance", QRegularExpression("^guidance$"), QRegularExpression("^guidance\\..*$")},
-        // {"sc2000a", QRegularExpression("^sc2000a$"), QRegularExpression("^sc2000a\\..*$")},
-        {"vehicle", QRegularExpression("^vehicle$"), QRegularExpression("^vehicle\\..*$")},
-        // {"vehicle_navigator", QRegularExpression("^vehicle_navigator$"), QRegularExpression("^vehicle_navigator\\..*$")},
-        {"map", QRegularExpression("^map$"), QRegularExpression("^map\\..*$")},
-        {"version",QRegularExpression("^version$"), QRegularExpression("^version\\..*$")}
-    };
-    
-    for (const auto& pattern : patterns) {
-        if (pattern.exact_regex.match(lower_file_name).hasMatch() ||pattern.numbered_regex.match(lower_file_name).hasMatch()) {
-            return pattern.keyword;
-        }
-    }
-    
-    // 检查扩展名
-    // QStringList text_extensions = {
-    //     "txt", "md", "csv", "json", 
-    //     "xml", "ini", "cfg", "yml", "yaml",
-    //     "out", "err", "trace", "debug", "info"
-    // };
-    
-    // QString extension = QFileInfo(file_name).suffix().toLower();
-    // if (!extension.isEmpty() && text_extensions.contains(extension)) {
-    //     return "extension_" + extension;
-    // }
-    
-    // 检查日志关键词
-    // QStringList log_keywords = {
-    //     "trace", "debug", "error", "err", "out", 
-    //     "audit", "access", "system", "application"
-    // };
-    
-    // for (const QString& keyword : log_keywords) {
-    //     if (lower_file_name.contains(keyword)) {
-    //         return "log_" + keyword;
-    //     }
-    // }
-    
-    return QString();
+    // 规则表由FileClassifier从配置编译，导入线程也通过这里分类
+    return FileClassifier::Current()->Classify(file_name);
 }
 
 QString SqliteTextHandler::GetFileCategory(const QString& keyword) {
-    if (keyword.startsWith("extension_")) {
-        return "通用文本文件";
-    } else if (keyword.startsWith("log_")) {
-        return "日志文件";
-    } else if (keyword == "master") {
-        return "主控文件";
-    } else if (keyword == "chassis") {
-        return "底盘文件";
-    } else if (keyword == "guidance") {
-        return "引导文件";
-    } else if (keyword == "sc2000a") {
-        return "SC2000A文件";
-    } else if (keyword == "vehicle" || keyword == "vehicle_navigator") {
-        return "车辆文件";
-    } else if (keyword == "version") {
-        return "版本文件";
-    }
-    return "其他文件";
+    return FileClassifier::Current()->Category(keyword);
 }
 
 bool SqliteTextHandler::IsTextFile(const QString& file_name) {
     return !GetFileKeyword(file_name).isEmpty();
 }
 
-void SqliteTextHandler::CleanupTempFiles() {
-    if (m_temp_dir_) {
-        qDebug() << "清理临时文件目录:" << m_temp_dir_->path();
-        m_temp_dir_.reset();
-    }
-}
-
 void SqliteTextHandler::UpdateFileListModel() {
-    // 从数据库获取文件分组信息
-    QMap<QString, QList<DbFileRecord>> grouped_files;
-    QList<DbFileRecord> all_files = m_db_manager_->GetAllFiles();
-    
-    for (const auto& record : all_files) {
-        grouped_files[record.keyword].append(record);
-    }
+    // 从数据库获取文件分组信息：只在SQL中聚合元数据，不读取文件内容
+    const QList<DbKeywordSummary> summaries = m_db_manager_->GetKeywordSummaries();
     
     // 创建文件列表模型数据
     QList<FileMeta> model_files;
-    for (auto it = grouped_files.constBegin(); it != grouped_files.constEnd(); ++it) {
-        const QString& keyword = it.key();
-        const QList<DbFileRecord>& group = it.value();
-        
-        qint64 total_size = 0;
-        for (const auto& record : group) {
-            total_size += record.file_size;
-        }
+    for (const DbKeywordSummary& summary : summaries) {
+        const QString& keyword = summary.keyword;
         
-        QString display_name = group.size() > 1
-            ? QString("%1 (%2 个文件)").arg(keyword).arg(group.size())
+        QString display_name = summary.file_count > 1
+            ? QString("%1 (%2 个文件)").arg(keyword).arg(summary.file_count)
             : keyword;
         
         FileMeta meta(
             keyword,                      // path作为唯一标识
             display_name,                 // 显示名称
-            total_size,                   // 总大小
+            summary.total_size,           // 总大小
             keyword,                      // 关键字
             GetFileCategory(keyword)      // 类别
         );
@@ -1102,20 +3181,43 @@ void SqliteTextHandler::UpdateFileListModel() {
     emit fileListReady(m_file_list_model_);
 }
 
-void SqliteTextHandler::startAsyncSearch(const QString& content, const QString& search_text, int max_results) {
+void SqliteTextHandler::startAsyncSearch(const QString& content, const QString& search_text, int max_results,
+                                         const QVariantMap& options) {
     Q_UNUSED(content)  // 数据库版本不需要传入content
     
     qDebug() << "SqliteTextHandler::startAsyncSearch 被调用";
     qDebug() << "搜索词:" << search_text;
     qDebug() << "当前关键字:" << m_current_keyword_;
     
+    StartSearchWorker(QStringList{ search_text }, max_results, options);
+}
+
+void SqliteTextHandler::startAsyncMultiSearch(const QStringList& search_terms, int max_results, const QVariantMap& options) {
+    qDebug() << "SqliteTextHandler::startAsyncMultiSearch 被调用";
+    qDebug() << "搜索词:" << search_terms;
+    qDebug() << "当前关键字:" << m_current_keyword_;
+    
+    StartSearchWorker(search_terms, max_results, options);
+}
+
+void SqliteTextHandler::StartSearchWorker(const QStringList& search_terms, int max_results, const QVariantMap& options) {
+    TextMatcher::Options matcher_options;
+    matcher_options.case_sensitive = options.value("caseSensitive", false).toBool();
+    matcher_options.whole_word = options.value("wholeWord", false).toBool();
+    matcher_options.regex = options.value("regex", false).toBool();
+    
     if (m_search_worker_) {
+        // 新搜索的结果从空列表开始逐批追加
+        m_search_result_model_->clear();
+        // 高亮只在可见行取数据时计算，这里换上新的匹配器即可
+        std::shared_ptr<const TextMatcher> matcher = TextMatcher::Create(search_terms, matcher_options);
+        m_text_line_model_->setMatcher(matcher->IsValid() ? matcher : nullptr);
         if (!m_current_keyword_.isEmpty()) {
             // 在特定关键字内搜索
-            m_search_worker_->SetSearchData(m_current_keyword_, search_text, max_results);
+            m_search_worker_->SetSearchData(m_current_keyword_, search_terms, max_results, matcher_options);
         } else {
             // 全库搜索
-            m_search_worker_->SetFullSearchData(search_text, max_results);
+            m_search_worker_->SetFullSearchData(search_terms, max_results, matcher_options);
         }
         QMetaObject::invokeMethod(m_search_worker_, "StartSearch", Qt::QueuedConnection);
     } else {
@@ -1131,23 +3233,34 @@ void SqliteTextHandler::cancelSearch() {
 
 void SqliteTextHandler::cancelFileLoading() {
     m_cancel_loading_ = true;
+    
+    // 直接置位取消标志（不经过事件队列），导入线程会尽快回滚并退出
+    if (m_import_worker_) {
+        m_import_worker_->CancelImport();
+    }
 }
 
 void SqliteTextHandler::requestFileContent(const QString& file_path) {
     qDebug() << "请求文件内容，关键字:" << file_path;
     
     // file_path 实际上是 keyword
+    // 合并内容在数据库线程上读取，切换关键字时取消尚未完成的上一次读取
     m_current_keyword_ = file_path;
-    QString content = m_db_manager_->GetMergedContentByKeyword(file_path);
-    
-    if (!content.isEmpty()) {
-        emit fileContentReady(content, file_path);
-    } else {
-        // emit loadError(QString("未找到关键字 %1 的内容").arg(file_path));
-    }
+    m_content_future_.cancel();
+    m_content_future_ = m_db_manager_->GetMergedContentByKeywordAsync(file_path);
+    m_content_future_.then(this, [this, file_path](const QString& content) {
+        if (file_path != m_current_keyword_) {
+            return;
+        }
+        m_text_line_model_->setContent(content);
+        if (!content.isEmpty()) {
+            emit fileContentReady(file_path);
+        } else {
+            // emit loadError(QString("未找到关键字 %1 的内容").arg(file_path));
+        }
+    });
 }
 
 void SqliteTextHandler::clearFileCache() {
-    // 数据库版本不需要清理缓存，但可以清理临时文件
-    CleanupTempFiles();
+    // 数据库版本不需要清理缓存，ZIP条目直接解压入库，也没有临时文件
 }
@@ -8,16 +8,30 @@
 #include <QSqlError>
 #include <QThread>
 #include <QMutex>
-#include <QTemporaryDir>
+#include <QRecursiveMutex>
+#include <QThreadStorage>
 #include <QAbstractListModel>
 #include <memory>
 #include <atomic>
+#include <functional>
+#include <type_traits>
 #include <QPointer>
 #include <QFileInfo>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QFuture>
+#include <QPromise>
+#include "line_time_index.h"
+#include "text_matcher.h"
 
 // 前向声明
 class FileListModel;
+class SearchResultModel;
+class TextLineModel;
 class SearchWorker;
+class ZipArchiveReader;
 
 // 数据库文件记录结构
 struct DbFileRecord {
@@ -30,10 +44,45 @@ struct DbFileRecord {
     qint64 file_size;       // 文件大小
     QString zip_source;     // 来源ZIP文件
     QDateTime import_time;  // 导入时间
+    int line_count = 0;     // 行数（导入时的索引阶段计算）
+    QString entry_fingerprint;  // 条目指纹（路径+CRC32+大小）
+    QString content_hash;       // 解压后内容的xxHash64
+    int archive_id = 0;         // 所属归档（id只在同一归档内唯一）
+};
+
+// 按关键字分组的文件统计（文件列表、统计面板使用），来自各归档的keyword_stats表
+struct DbKeywordSummary {
+    QString keyword;
+    QString category;
+    int file_count = 0;
+    qint64 total_size = 0;
+    qint64 line_count = 0;
+    qint64 first_time = -1;     // 带时间戳行的最早/最晚毫秒时间戳，没有时为-1
+    qint64 last_time = -1;
+    qint64 error_count = 0;     // 错误/警告行数（见LogSeverity）
+    qint64 warning_count = 0;
+};
+
+// 已入库条目的状态，用于增量导入比对
+struct DbEntryState {
+    qint64 file_id = 0;
+    QString entry_fingerprint;
+};
+
+// 工作区中的归档（目录库archives表）
+struct DbArchiveInfo {
+    int id = 0;
+    QString zip_source;     // 来源ZIP文件名（用于显示）
+    QString source_path;    // 来源ZIP文件的绝对路径，用于识别同一归档；旧版本的记录为空
+    QString fingerprint;    // 归档指纹，为空表示尚未完成导入
+    qint64 archive_size = 0;
+    QString db_file;        // 归档独立的SQLite文件
+    QDateTime import_time;
 };
 
 // 数据库搜索结果
 struct DbSearchResult {
+    int archive_id = 0;
     int file_id;
     QString file_name;
     QString keyword;
@@ -41,9 +90,12 @@ struct DbSearchResult {
     QString line_content;
     QString preview;
     int match_position;     // 匹配位置
+    QString matched_term;   // 命中的搜索词（多词搜索时区分来源）
 };
 
 // SQLite数据库管理类
+// 主库只保存工作区目录（archives）；每个归档的文件与内容块存放在独立的SQLite文件中，
+// 查询时按需ATTACH为arc_<id>，逐个归档执行后在内存中合并结果
 class SqliteDbManager : public QObject {
     Q_OBJECT
 
@@ -56,33 +108,258 @@ public:
     bool ConnectDatabase();
     void DisconnectDatabase();
     bool IsConnected() const;
+    QString DatabasePath() const;
+
+    // 临时会话：目录库和归档文件放在内存文件系统（/dev/shm，不可用时为系统临时目录）的临时目录中，
+    // 导入和建索引不写磁盘；切换数据库或退出时整个目录删除
+    bool InitializeEphemeralDatabase();
+    bool IsEphemeral() const;
+    // 把目录库和所有已完成的归档快照到db_path（归档文件写入其旁边的archives目录），
+    // db_path不能已存在；快照期间读连接照常工作，当前会话不变
+    bool PersistSession(const QString& db_path);
+
+    // 异步执行：task(QPromise<T>&)在数据库线程池上运行，每个池线程使用自己的读连接，
+    // 写操作照常投递到写线程串行执行；task通过promise.isCanceled()响应取消，用addResult()交付结果。
+    // 调用方用QFuture::then(context, ...)在自己的线程上接收结果，cancel()后不再回调
+    template <typename T, typename Task>
+    QFuture<T> RunAsync(Task task);
+    QFuture<QString> GetMergedContentByKeywordAsync(const QString& keyword, const QList<int>& archive_ids = QList<int>());
+
+    // 在调用线程上打开归档文件的独立连接（如导入写线程），必要时创建归档表结构
+    // 调用方负责关闭连接并调用QSqlDatabase::removeDatabase
+    static QSqlDatabase OpenArchiveConnection(const QString& db_file, const QString& connection_name);
+
+    // 文件内容按块存储在file_chunks表中（UTF-8字节，按换行边界切分，每块独立压缩）
+    // 读取和搜索只解压涉及的块
+    static constexpr qint64 k_chunk_size_ = 64 * 1024;
+
+    // file_chunks.codec取值
+    static constexpr int k_codec_raw_ = 0;
+    static constexpr int k_codec_zlib_ = 1;
+    static constexpr int k_chunk_compression_level_ = 3;   // 日志文本压缩率高，低级别即可兼顾速度
+
+    // 压缩一个内容块；压缩后不更小时原样返回并置codec为k_codec_raw_
+    static QByteArray CompressChunk(const QByteArray& raw, int* codec);
+    static QByteArray DecompressChunk(const QByteArray& data, int codec);
+
+    // 文件元数据/内容块插入语句，%1为归档schema（独立连接上为main）
+    static constexpr const char* k_insert_file_sql_ = R"(
+        INSERT OR REPLACE INTO %1.files 
+        (file_path, file_name, keyword, category, file_size, zip_source, import_time, line_count,
+         entry_fingerprint, content_hash)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )";
+    static constexpr const char* k_insert_chunk_sql_ = R"(
+        INSERT INTO %1.file_chunks (file_id, chunk_no, first_line, line_count, data, codec, raw_size)
+        VALUES (?, ?, ?, ?, ?, ?, ?)
+    )";
+    // 关键字行索引：seq为合并顺序（文件名降序），first_line为文件在合并文本中的起始行
+    static constexpr const char* k_create_keyword_files_sql_ = R"(
+        CREATE TABLE IF NOT EXISTS %1.keyword_files (
+            keyword TEXT NOT NULL,
+            seq INTEGER NOT NULL,
+            file_id INTEGER NOT NULL,
+            first_line INTEGER NOT NULL,
+            line_count INTEGER NOT NULL,
+            PRIMARY KEY(keyword, seq)
+        )
+    )";
+    static constexpr const char* k_rebuild_keyword_files_sql_[] = {
+        "DELETE FROM %1.keyword_files",
+        R"(
+        INSERT INTO %1.keyword_files (keyword, seq, file_id, first_line, line_count)
+        SELECT keyword,
+               ROW_NUMBER() OVER w,
+               id,
+               COALESCE(SUM(line_count) OVER (w ROWS BETWEEN UNBOUNDED PRECEDING AND 1 PRECEDING), 0),
+               line_count
+        FROM %1.files
+        WINDOW w AS (PARTITION BY keyword ORDER BY file_name DESC, id)
+    )"
+    };
+    // 关键字统计：每个关键字一行，随导入/删除在同一事务中由RebuildKeywordIndex重建（只汇总元数据），
+    // 统计面板和文件列表直接读取，与数据库大小无关
+    static constexpr const char* k_create_keyword_stats_sql_ = R"(
+        CREATE TABLE IF NOT EXISTS %1.keyword_stats (
+            keyword TEXT PRIMARY KEY,
+            category TEXT,
+            file_count INTEGER NOT NULL,
+            total_size INTEGER NOT NULL,
+            line_count INTEGER NOT NULL,
+            min_ts INTEGER,
+            max_ts INTEGER,
+            error_count INTEGER NOT NULL,
+            warning_count INTEGER NOT NULL
+        )
+    )";
+    static constexpr const char* k_rebuild_keyword_stats_sql_[] = {
+        "DELETE FROM %1.keyword_stats",
+        R"(
+        INSERT INTO %1.keyword_stats (keyword, category, file_count, total_size, line_count, min_ts, max_ts,
+                                      error_count, warning_count)
+        SELECT f.keyword, MIN(f.category), COUNT(*), COALESCE(SUM(f.file_size), 0), COALESCE(SUM(f.line_count), 0),
+               MIN(t.min_ts), MAX(t.max_ts), COALESCE(SUM(f.error_count), 0), COALESCE(SUM(f.warning_count), 0)
+        FROM %1.files f
+        LEFT JOIN (SELECT file_id, MIN(min_ts) AS min_ts, MAX(max_ts) AS max_ts
+                   FROM %1.line_times GROUP BY file_id) t ON t.file_id = f.id
+        GROUP BY f.keyword
+    )"
+    };
+    // 行时间戳索引：每个内容块一条记录（见LineTimeIndex），按(file_id, max_ts)定位
+    static constexpr const char* k_create_line_times_sql_ = R"(
+        CREATE TABLE IF NOT EXISTS %1.line_times (
+            file_id INTEGER NOT NULL,
+            chunk_no INTEGER NOT NULL,
+            first_line INTEGER NOT NULL,
+            min_ts INTEGER NOT NULL,
+            max_ts INTEGER NOT NULL,
+            entry_count INTEGER NOT NULL,
+            entries BLOB,
+            PRIMARY KEY(file_id, chunk_no)
+        )
+    )";
+    static constexpr const char* k_insert_line_times_sql_ = R"(
+        INSERT INTO %1.line_times (file_id, chunk_no, first_line, min_ts, max_ts, entry_count, entries)
+        VALUES (?, ?, ?, ?, ?, ?, ?)
+    )";
+    // 行级全文索引：contentless FTS5表，trigram分词，任意>=3字符的子串都能经索引定位；
+    // 行文本不重复存储，rowid由(file_id, 行号)组合而成（见LineRowId）
+    static constexpr const char* k_insert_line_fts_sql_ = "INSERT INTO %1.line_fts (rowid, text) VALUES (?, ?)";
+    static qint64 LineRowId(qint64 file_id, qint64 line) { return (file_id << 32) | line; }
+    // 创建line_fts；当前SQLite不支持FTS5/trigram时返回false，搜索退回逐块扫描
+    static bool CreateLineFts(QSqlDatabase& database, const QString& schema = QStringLiteral("main"));
+    static bool HasLineFts(QSqlDatabase& database, const QString& schema = QStringLiteral("main"));
+    // 把一个内容块的各行写入line_fts（first_line为块首行在文件中的行号）
+    static bool IndexChunkLines(QSqlQuery& query, qint64 file_id, qint64 first_line, const QByteArray& data);
+    static bool BindAndInsertFile(QSqlQuery& query, const DbFileRecord& record);
+    static bool BindAndInsertChunk(QSqlQuery& query, qint64 file_id, int chunk_no, qint64 first_line,
+                                   int line_count, const QByteArray& data, int codec, qint64 raw_size);
+    // 没有时间戳的块不写入
+    static bool BindAndInsertLineTimes(QSqlQuery& query, qint64 file_id, int chunk_no, qint64 first_line,
+                                       const LineTimeIndex::ChunkTimes& times);
+
+    // 在buffer的前limit字节内寻找切块位置：优先最后一个换行之后，
+    // 没有换行时退回到UTF-8字符边界
+    static qint64 FindChunkCut(const QByteArray& buffer, qint64 limit);
+
+    // 重建keyword_files和keyword_stats：每个关键字下的文件按合并顺序排列，记录各文件在合并文本中的起始行，
+    // 并汇总各关键字的统计；导入事务提交前调用，只涉及文件元数据，与内容大小无关
+    static bool RebuildKeywordIndex(QSqlDatabase& database, const QString& schema = QStringLiteral("main"));
+
+    // 归档中主键以外的索引（名称, 表及列）
+    // 批量导入新归档时先删除，全部写完后逐个CREATE INDEX，每个索引只需一次排序，
+    // 避免逐行插入时随机更新B树
+    struct SecondaryIndex {
+        const char* name;
+        const char* columns;
+    };
+    static constexpr SecondaryIndex k_secondary_indexes_[] = {
+        { "idx_keyword", "files(keyword)" },
+        { "idx_category", "files(category)" },
+        { "idx_chunk_lines", "file_chunks(file_id, first_line)" },
+        { "idx_keyword_lines", "keyword_files(keyword, first_line)" },
+        { "idx_keyword_files_file", "keyword_files(file_id)" },
+        { "idx_line_times_max", "line_times(file_id, max_ts)" },
+    };
+    static bool DropSecondaryIndexes(QSqlDatabase& database, const QString& schema = QStringLiteral("main"));
+    static bool CreateSecondaryIndexes(QSqlDatabase& database, const QString& schema = QStringLiteral("main"));
+
+    // 在归档连接上删除指定文件及其内容块（可在调用方的事务中执行）
+    static bool DeleteFilesByIds(QSqlDatabase& database, const QList<qint64>& file_ids);
+
+    // 工作区归档管理：目录读取走当前线程的读连接，修改在写线程上执行
+    QList<DbArchiveInfo> GetArchives();
+    DbArchiveInfo GetArchive(int archive_id);
+    // 按来源文件的绝对路径查找；没有记录路径的旧版本归档按文件名匹配
+    DbArchiveInfo FindArchiveBySource(const QString& source_path);
+    int CreateArchive(const QString& zip_source, const QString& source_path = QString());
+    bool UpdateArchive(int archive_id, const QString& fingerprint, qint64 archive_size);
+    bool SetArchiveSourcePath(int archive_id, const QString& source_path);
+    bool DropArchive(int archive_id);
+    bool DropAllArchives();
+    
+    // 查询范围：未显式指定归档时，查询作用于当前活动归档
+    bool SetActiveArchives(const QList<int>& archive_ids);
+    QList<int> ActiveArchives() const;
+    QList<int> AllArchiveIds();
+    
+    // 增量导入：已入库条目状态
+    QHash<QString, DbEntryState> GetEntryStates(int archive_id);
 
     // 文件操作
-    bool InsertFile(const DbFileRecord& record);
-    bool InsertFiles(const QList<DbFileRecord>& records);
-    bool DeleteFilesByZipSource(const QString& zip_source);
-    bool DeleteAllFiles();
-    QList<DbFileRecord> GetFilesByKeyword(const QString& keyword);
-    QList<DbFileRecord> GetAllFiles();
+    bool InsertFile(int archive_id, const DbFileRecord& record);
+    bool InsertFiles(int archive_id, const QList<DbFileRecord>& records);
+    // 以下两个方法会读出每个文件的全部内容，只需要元数据时使用ListFiles
+    QList<DbFileRecord> GetFilesByKeyword(const QString& keyword, const QList<int>& archive_ids = QList<int>());
+    QList<DbFileRecord> GetAllFiles(const QList<int>& archive_ids = QList<int>());
+    // 只读元数据（content为空），keyword为空时列出全部文件，按关键字、文件名排序
+    QList<DbFileRecord> ListFiles(const QString& keyword = QString(), const QList<int>& archive_ids = QList<int>());
+    // 按关键字分组的统计，读取导入时维护的keyword_stats，多个归档的同名关键字合并
+    QList<DbKeywordSummary> GetKeywordSummaries(const QList<int>& archive_ids = QList<int>());
+    // 逐块读取文件内容：按块顺序每次解压一块交给consumer，consumer返回false时停止，
+    // 任何时刻只持有一块内容；返回是否读完（文件不存在或中途停止时返回false）
+    bool StreamFileContent(int archive_id, qint64 file_id, const std::function<bool(const QByteArray&)>& consumer);
+    // 读取单个文件的全部内容（用于ListFiles之后按需加载）
+    QString ReadFileText(int archive_id, qint64 file_id);
     
     // 内容操作
-    QString GetMergedContentByKeyword(const QString& keyword);
-    QStringList GetAllKeywords();
+    // is_cancelled返回true时停止读取并返回空字符串
+    QString GetMergedContentByKeyword(const QString& keyword, const QList<int>& archive_ids = QList<int>(),
+                                      const std::function<bool()>& is_cancelled = nullptr);
+    QStringList GetAllKeywords(const QList<int>& archive_ids = QList<int>());
+    // 按行号随机读取：只解压与[first_line, first_line + line_count)相交的内容块
+    QString ReadLineRange(int archive_id, qint64 file_id, qint64 first_line, int line_count);
     
-    // 搜索操作
-    QList<DbSearchResult> SearchInFiles(const QString& search_text, int max_results = 100);
-    QList<DbSearchResult> SearchInKeyword(const QString& keyword, const QString& search_text, int max_results = 100);
+    // 关键字合并文本的行寻址（行号从0开始），与GetMergedContentByKeyword的行一一对应，
+    // 通过导入时建立的keyword_files行索引定位，不需要生成整个合并文本
+    qint64 GetKeywordLineCount(const QString& keyword, const QList<int>& archive_ids = QList<int>());
+    QStringList GetKeywordLines(const QString& keyword, qint64 first_line, int line_count,
+                                const QList<int>& archive_ids = QList<int>());
     
-    // 统计信息
-    int GetTotalFileCount();
-    qint64 GetTotalSize();
-    QMap<QString, int> GetFileCountByCategory();
+    // 关键字合并文本的时间查询（时间为毫秒时间戳，行号与GetKeywordLines一致），均经line_times索引完成
+    // 时间范围：所有带时间戳行的最早/最晚时间，没有时间戳时返回false
+    bool GetKeywordTimeRange(const QString& keyword, qint64* first_time, qint64* last_time,
+                             const QList<int>& archive_ids = QList<int>());
+    // 跳转：时间不早于time的最早一行（时间相同取合并文本中靠前的行），没有时返回-1
+    qint64 FindKeywordLineAtTime(const QString& keyword, qint64 time, const QList<int>& archive_ids = QList<int>());
+    // 时间窗口：时间落在[from_time, to_time]内的行，按合并文本顺序，最多max_lines行
+    QList<qint64> GetKeywordLinesInTimeWindow(const QString& keyword, qint64 from_time, qint64 to_time,
+                                              int max_lines = 10000, const QList<int>& archive_ids = QList<int>());
+    
+    // 搜索操作：默认为不区分大小写的字面量匹配，options可选区分大小写、整词或正则
+    QList<DbSearchResult> SearchInFiles(const QString& search_text, int max_results = 100,
+                                        const QList<int>& archive_ids = QList<int>(),
+                                        const TextMatcher::Options& options = TextMatcher::Options());
+    QList<DbSearchResult> SearchInKeyword(const QString& keyword, const QString& search_text, int max_results = 100,
+                                          const QList<int>& archive_ids = QList<int>(),
+                                          const TextMatcher::Options& options = TextMatcher::Options());
+    // 多词搜索：一遍扫描找出所有搜索词，一行命中几个词就记几条结果，按matched_term区分
+    // on_batch非空时边搜索边分批交出新结果（在搜索线程上调用），is_cancelled返回true时提前结束
+    using SearchBatchHandler = std::function<void(const QList<DbSearchResult>& batch)>;
+    QList<DbSearchResult> SearchInFiles(const QStringList& search_terms, int max_results = 100,
+                                        const QList<int>& archive_ids = QList<int>(),
+                                        const TextMatcher::Options& options = TextMatcher::Options(),
+                                        const SearchBatchHandler& on_batch = nullptr,
+                                        const std::function<bool()>& is_cancelled = nullptr);
+    QList<DbSearchResult> SearchInKeyword(const QString& keyword, const QStringList& search_terms, int max_results = 100,
+                                          const QList<int>& archive_ids = QList<int>(),
+                                          const TextMatcher::Options& options = TextMatcher::Options(),
+                                          const SearchBatchHandler& on_batch = nullptr,
+                                          const std::function<bool()>& is_cancelled = nullptr);
+    
+    // 统计信息（均由keyword_stats汇总）
+    int GetTotalFileCount(const QList<int>& archive_ids = QList<int>());
+    qint64 GetTotalSize(const QList<int>& archive_ids = QList<int>());
+    QMap<QString, int> GetFileCountByCategory(const QList<int>& archive_ids = QList<int>());
 
-    // 事务操作
+    // 事务操作（写连接）
     bool BeginTransaction();
     bool CommitTransaction();
     bool RollbackTransaction();
 
+    static constexpr int k_archive_schema_version_ = 6;    // 归档文件的PRAGMA user_version
+    static constexpr int k_max_attached_archives_ = 8;     // 同时ATTACH的归档数上限（SQLite默认上限为10）
+
 signals:
     void databaseError(const QString& error);
     void progressUpdate(int progress);
@@ -91,19 +368,151 @@ private:
     // 创建数据库表和索引
     bool CreateTables();
     bool CreateIndexes();
+    bool EnsureColumn(const QString& table, const QString& column, const QString& definition);
+    bool MigrateLegacyTables();
+    // 创建或升级归档表结构（schema为main或已ATTACH的arc_<id>）
+    static bool CreateArchiveSchema(QSqlDatabase& database, const QString& schema = QStringLiteral("main"));
+    static void ApplyConnectionPragmas(QSqlDatabase& database);
+    // 为升级前导入的内容块补建时间索引/全文索引/级别统计
+    static bool BackfillChunkIndexes(QSqlDatabase& database, const QString& schema, bool line_times, bool line_fts,
+                                     bool severity);
+    // 删除文件在line_fts中的行
+    static bool DeleteLineFts(QSqlDatabase& database, qint64 file_id);
+    
+    // 一个连接及其ATTACH状态
+    // 写连接只有一个（m_writer_），只在写线程上打开和使用，负责目录表修改和InsertFiles；
+    // 其他线程调用写操作时经RunOnWriter投递到写线程并等待结果；
+    // 读连接每个线程一个（只读打开，WAL下读不阻塞写、也不被写阻塞），各自维护ATTACH列表，
+    // 查询、搜索、地图/轨迹加载和文件列表刷新都走读连接，不再相互等待，也不等待进行中的导入
+    struct ArchiveConnection {
+        ~ArchiveConnection();
+        QString name;
+        QSqlDatabase database;
+        QList<int> attached;        // 已ATTACH的归档，按最近使用排序（末尾最新）
+        quint64 generation = 0;     // 建立时的目录版本，与m_generation_不一致时重新打开
+        bool owned = false;         // 读连接：析构时关闭并移除
+        QHash<QString, std::shared_ptr<QSqlQuery>> statements;   // 预编译语句缓存，键为SQL文本
+    };
+    
+    // 缓存语句的使用句柄：离开作用域时finish()，结束语句占用的读事务，
+    // 否则读连接会一直停留在旧快照上，也会阻止WAL检查点
+    class CachedStatement {
+    public:
+        explicit CachedStatement(std::shared_ptr<QSqlQuery> query) : m_query_(std::move(query)) {}
+        CachedStatement(CachedStatement&&) = default;
+        ~CachedStatement() {
+            if (m_query_) {
+                m_query_->finish();
+            }
+        }
+        QSqlQuery* operator->() const { return m_query_.get(); }
+        QSqlQuery& operator*() const { return *m_query_; }
+        
+        // 按位置绑定全部参数并执行（重复执行时不依赖addBindValue的内部计数）
+        template <typename... Args>
+        bool Exec(const Args&... args) {
+            int index = 0;
+            (m_query_->bindValue(index++, args), ...);
+            return m_query_->exec();
+        }
+        
+    private:
+        std::shared_ptr<QSqlQuery> m_query_;
+    };
+    
+    // 取连接上缓存的预编译语句，首次使用时prepare；同一条SQL在一个连接上只解析一次
+    static CachedStatement CachedQuery(ArchiveConnection& connection, const QString& sql);
+    
+    // 当前线程的读连接，不存在或已过期时（重新）打开；打开失败时返回未打开的连接，查询会失败并返回空结果
+    ArchiveConnection& Reader();
+    
+    // ATTACH管理：写连接只在写线程上使用，读连接只在所属线程使用
+    QString EnsureAttached(ArchiveConnection& connection, int archive_id);
+    void DetachArchive(ArchiveConnection& connection, int archive_id);
+    // 读连接ATTACH到旧版本归档时，经临时写连接就地升级（持有m_mutex_，避免并发升级）
+    bool UpgradeArchive(const QString& db_file, const QString& schema);
+    QList<int> ResolveScope(const QList<int>& archive_ids) const;
+    // 读取目录表中的归档记录（archive_id为0时读取全部）
+    static QList<DbArchiveInfo> ReadArchives(QSqlDatabase& database, int archive_id = 0);
+    
+    // 写线程：写操作的公有方法在其他线程上被调用时，经RunOnWriter在写线程上重新调用自身。
+    // fn在写线程上执行，调用方阻塞等待其返回值；调用时不能持有m_mutex_
+    bool OnWriterThread() const { return QThread::currentThread() == m_writer_thread_.get(); }
+    template <typename Fn>
+    auto RunOnWriter(Fn fn) -> decltype(fn());
+    // 释放当前线程的读连接（删除或切换数据库前，避免文件仍被本线程打开）
+    void ReleaseLocalReader();
+    // 删除归档文件；读连接尚未DETACH导致删除失败的文件留待下次重试
+    void RemoveArchiveFiles(const QString& db_file);
+    static QString SchemaName(int archive_id) { return QString("arc_%1").arg(archive_id); }
     
     // 执行SQL查询的辅助方法
     bool ExecuteQuery(const QString& query_str);
     QSqlQuery PrepareQuery(const QString& query_str);
+    static QSqlQuery PrepareQuery(QSqlDatabase& database, const QString& query_str);
     
+    // 以下读取辅助方法在调用方给出的连接上执行（通常为当前线程的读连接）
+    // 读取并拼接单个文件的全部内容块
+    static QByteArray ReadFileContent(ArchiveConnection& connection, const QString& schema, qint64 file_id);
+    static QByteArray ReadFileLines(ArchiveConnection& connection, const QString& schema, qint64 file_id,
+                                    qint64 first_line, int line_count);
+    static QHash<QString, qint64> KeywordLineTotals(ArchiveConnection& connection, const QString& schema);
+    // 关键字下的文件及其在合并文本中的起始行，按合并顺序
+    static QList<QPair<qint64, qint64>> KeywordFileStarts(ArchiveConnection& connection, const QString& schema,
+                                                          const QString& keyword);
+    bool InsertFileContent(const QString& schema, qint64 file_id, const QString& content);
+    // load_content为false时只读元数据
+    static QList<DbFileRecord> ReadFileRecords(ArchiveConnection& connection, QSqlQuery& query, int archive_id,
+                                               const QString& schema, bool load_content = true);
+    
+    // 搜索结果收集：达到上限或被取消后Done()为真。
+    // 设置了回调时把新结果分批交出：第一条立即交出，之后每k_batch_rows_条或每k_batch_interval_ms_毫秒一批
+    class SearchCollector {
+    public:
+        SearchCollector(int max_results, const SearchBatchHandler& on_batch, const std::function<bool()>& is_cancelled);
+        void Add(const DbSearchResult& result);
+        bool Done() const;
+        // 交出尚未交出的结果
+        void Flush();
+        const QList<DbSearchResult>& Results() const { return m_results_; }
+        
+    private:
+        static constexpr int k_batch_rows_ = 64;
+        static constexpr qint64 k_batch_interval_ms_ = 50;
+        
+        int m_max_results_;
+        SearchBatchHandler m_on_batch_;
+        std::function<bool()> m_is_cancelled_;
+        QList<DbSearchResult> m_results_;
+        qsizetype m_flushed_ = 0;
+        QElapsedTimer m_timer_;
+    };
+    
+    // 经line_fts搜索（keyword为空时搜索全部文件），索引不可用或搜索词过短时返回false
+    // 索引只用于定位候选行（trigram不区分大小写），每行再经matcher校验
+    static bool SearchLineIndex(ArchiveConnection& connection, const QString& schema, int archive_id,
+                                const QString& keyword, const QString& search_text, const TextMatcher& matcher,
+                                const QHash<QString, qint64>& keyword_bases, SearchCollector& collector);
     // 处理搜索结果
-    void ProcessSearchResults(QSqlQuery& query, const QString& search_text, QList<DbSearchResult>& results, int max_results);
+    static void ProcessSearchResults(QSqlQuery& query, int archive_id, const TextMatcher& matcher,
+                                     const QHash<QString, qint64>& keyword_bases, SearchCollector& collector);
 
 private:
-    QSqlDatabase m_database_;
+    ArchiveConnection m_writer_;        // 只在m_writer_thread_上使用
+    std::unique_ptr<QThread> m_writer_thread_;
+    std::unique_ptr<QObject> m_writer_context_;   // 位于写线程，RunOnWriter的投递目标
     QString m_database_path_;
-    mutable QMutex m_mutex_;
-    bool m_is_connected_;
+    // 写线程上的操作与UpgradeArchive互斥（避免同时升级同一归档），并保护m_ephemeral_dir_；
+    // 可重入：写线程上的公有方法之间会相互调用
+    mutable QRecursiveMutex m_mutex_;
+    mutable QMutex m_scope_mutex_;      // 保护m_active_archives_、m_database_path_和待删除文件列表
+    std::atomic<bool> m_is_connected_;
+    std::atomic<quint64> m_generation_{1};   // 目录版本：重新连接或删除归档时递增，读连接据此丢弃旧连接
+    QThreadStorage<ArchiveConnection*> m_readers_;
+    QList<int> m_active_archives_;
+    QStringList m_pending_removals_;    // 仍被读连接占用、待删除的归档文件
+    std::unique_ptr<QTemporaryDir> m_ephemeral_dir_;   // 临时会话的目录，由m_mutex_保护
+    QThreadPool m_db_pool_;             // RunAsync的数据库线程
     static constexpr const char* k_connection_name_ = "SqliteTextHandlerConnection";
 };
 
@@ -115,43 +524,96 @@ public:
     explicit DbSearchWorker(SqliteDbManager* db_manager, QObject* parent = nullptr);
     ~DbSearchWorker();
 
-    void SetSearchData(const QString& keyword, const QString& search_text, int max_results = 100);
-    void SetFullSearchData(const QString& search_text, int max_results = 100);
+    void SetSearchData(const QString& keyword, const QStringList& search_terms, int max_results = 100,
+                       const TextMatcher::Options& options = TextMatcher::Options());
+    void SetFullSearchData(const QStringList& search_terms, int max_results = 100,
+                           const TextMatcher::Options& options = TextMatcher::Options());
     void CancelSearch();
+    // 每次设置搜索数据都会换一个编号，接收方据此丢弃旧搜索晚到的结果
+    int CurrentSearchId() const { return m_search_id_; }
 
 public slots:
     void StartSearch();
 
 signals:
     void searchProgress(int progress);
-    void searchResultReady(const QList<DbSearchResult>& results, const QString& highlighted_content);
-    void searchFinished();
-    void searchCancelled();
-
-private:
-    QString HighlightSearchResults(const QString& content, const QString& search_text);
+    // 搜索过程中分批发出结果；高亮由TextLineModel按可见行计算
+    // 结束和取消也带搜索编号，接收方只处理当前搜索的
+    void searchResultsBatch(int search_id, const QList<DbSearchResult>& batch);
+    void searchFinished(int search_id);
+    void searchCancelled(int search_id);
     
 private:
     SqliteDbManager* m_db_manager_;
+    // 搜索参数由GUI线程设置，StartSearch在m_mutex_内取副本后使用
     QString m_keyword_;
-    QString m_search_text_;
+    QStringList m_search_terms_;
+    TextMatcher::Options m_options_;
     int m_max_results_;
     std::atomic<bool> m_cancelled_;
+    std::atomic<int> m_search_id_;
     bool m_is_full_search_;  // 是否全库搜索
     QMutex m_mutex_;
 };
 
+// 后台ZIP导入工作类（运行在独立线程，可随时取消）
+class DbImportWorker : public QObject {
+    Q_OBJECT
+
+public:
+    using Classifier = std::function<QString(const QString& file_name)>;
+
+    DbImportWorker(SqliteDbManager* db_manager, const Classifier& classifier,
+                   const Classifier& category_resolver, QObject* parent = nullptr);
+    ~DbImportWorker();
+
+    // 在GUI线程投递新任务前调用，避免与排队中的取消请求竞争
+    void ResetCancel();
+    void CancelImport();
+
+public slots:
+    void StartImport(const QString& zip_path, qint64 memory_budget);
+
+signals:
+    void importProgress(int progress);
+    void entryProgress(const QString& entry_name, int current, int total);
+    // 导入完成：failed_entries为解压中途出错、只导入了部分内容的条目数，
+    // first_keyword为默认显示的关键字（只有名称，内容按需读取）
+    void importFinished(int file_count, int failed_entries, qint64 elapsed_ms, const QString& first_keyword);
+    void importCancelled();
+    void importFailed(const QString& error_message);
+
+private:
+    void EmitImportFinished(int file_count, int failed_entries, const QElapsedTimer& timer);
+
+private:
+    SqliteDbManager* m_db_manager_;
+    Classifier m_classifier_;
+    Classifier m_category_resolver_;
+    std::atomic<bool> m_cancelled_;
+};
+
 // 主处理类 - 与TextFileHandler接口兼容
 class SqliteTextHandler : public QObject {
     Q_OBJECT
+    Q_PROPERTY(SearchResultModel* searchResultModel READ searchResultModel CONSTANT)
+    Q_PROPERTY(TextLineModel* textLineModel READ textLineModel CONSTANT)
 
 public:
     explicit SqliteTextHandler(QObject* parent = nullptr);
     ~SqliteTextHandler() override;
+    
+    SearchResultModel* searchResultModel() const { return m_search_result_model_; }
+    TextLineModel* textLineModel() const { return m_text_line_model_; }
 
     // 公共接口 - 与TextFileHandler保持一致
     Q_INVOKABLE void loadTextFileAsync(const QString& file_name = QString());
-    Q_INVOKABLE void startAsyncSearch(const QString& content, const QString& search_text, int max_results = 100);
+    // options可包含caseSensitive、wholeWord、regex（均默认false）
+    Q_INVOKABLE void startAsyncSearch(const QString& content, const QString& search_text, int max_results = 100,
+                                      const QVariantMap& options = QVariantMap());
+    // 多词搜索：一次扫描查找全部搜索词，结果的term字段为命中的搜索词
+    Q_INVOKABLE void startAsyncMultiSearch(const QStringList& search_terms, int max_results = 100,
+                                           const QVariantMap& options = QVariantMap());
     Q_INVOKABLE void cancelSearch();
     Q_INVOKABLE void cancelFileLoading();
     Q_INVOKABLE void requestFileContent(const QString& file_path);
@@ -162,6 +624,35 @@ public:
     Q_INVOKABLE bool initializeDatabase(const QString& db_path = QString());
     Q_INVOKABLE void clearDatabase();
     Q_INVOKABLE QVariantMap getDatabaseStats();
+    // 在数据库线程上统计，完成后发出databaseStatsReady
+    Q_INVOKABLE void requestDatabaseStats();
+    
+    // 临时会话：一次性分析不写磁盘；keepAnalysis把当前分析保存到db_path
+    // （为空时在文档目录按时间命名），返回保存的路径，失败返回空字符串
+    Q_INVOKABLE bool startEphemeralSession();
+    Q_INVOKABLE bool isEphemeralSession() const;
+    Q_INVOKABLE QString keepAnalysis(const QString& db_path = QString());
+    
+    // ZIP导入时缓冲数据的内存上限（MB），导入内存占用与归档大小无关
+    Q_INVOKABLE void setImportMemoryLimit(int megabytes);
+    Q_INVOKABLE int importMemoryLimit() const;
+    Q_INVOKABLE bool isImporting() const { return m_is_importing_; }
+    
+    // 工作区归档：每个导入的ZIP独立存储，查询只作用于活动归档
+    Q_INVOKABLE QVariantList getArchives();
+    Q_INVOKABLE bool setActiveArchives(const QVariantList& archive_ids);
+    Q_INVOKABLE bool dropArchive(int archive_id);
+    
+    // 按行读取关键字合并文本（行号从0开始），用于分页、跳转和上下文获取
+    Q_INVOKABLE qint64 getKeywordLineCount(const QString& keyword);
+    Q_INVOKABLE QStringList getKeywordLines(const QString& keyword, qint64 first_line, int line_count);
+    
+    // 时间索引查询：时间格式为dd/mm/yy hh:mm:ss.zzz或Unix秒，返回的行号与getKeywordLines一致
+    // getTimeRange返回{valid, start, end, startMs, endMs}
+    Q_INVOKABLE QVariantMap getTimeRange(const QString& keyword);
+    Q_INVOKABLE qint64 findLineAtTime(const QString& keyword, const QString& time_text);
+    Q_INVOKABLE QVariantList getLinesInTimeWindow(const QString& keyword, const QString& from_text,
+                                                  const QString& to_text, int max_lines = 10000);
 
     // 仅供C++层使用的访问器（不暴露给QML）
     SqliteDbManager* dbManager() const { return m_db_manager_.get(); }
@@ -169,47 +660,69 @@ public:
 signals:
     // 与TextFileHandler兼容的信号
     void loadProgress(int progress);
-    void fileLoaded(const QString& content);
+    // 导入完成、数据可用；内容不随信号传递，经requestFileContent/fileContentReady读取
+    void fileLoaded();
     void loadError(const QString& error_message);
     void searchProgress(int progress);
-    void searchResultReady(const QVariantList& results, const QString& highlighted_content);
+    // 结果逐批写入searchResultModel，高亮由textLineModel按可见行计算
     void searchFinished();
     void searchCancelled();
     void fileListReady(FileListModel* model);
-    void fileContentReady(const QString& content, const QString& file_path);
+    // 关键字内容已填入textLineModel；全文不随信号传给QML，避免在GUI线程上再复制一份
+    void fileContentReady(const QString& file_path);
+    
+    // ZIP导入时逐条目报告进度（current从1开始）
+    void entryProgress(const QString& entry_name, int current, int total);
+    
+    // 后台导入完成/取消；failed_entries为只导入了部分内容的损坏条目数
+    void importFinished(int file_count, qint64 elapsed_ms, int failed_entries);
+    void importCancelled();
+    
+    // 归档列表或活动归档变化
+    void archivesChanged();
     
     // 数据库特有信号
     void databaseInitialized();
+    void databaseStatsReady(const QVariantMap& stats);
     void databaseError(const QString& error);
 
 private:
-    // ZIP文件处理
+    // ZIP文件处理（投递到导入线程执行）
     void ProcessZipFile(const QString& zip_path);
-    bool ExtractZipFile(const QString& zip_path, const QString& extract_dir);
-    QList<DbFileRecord> ScanAndImportTextFiles(const QString& dir_path, const QString& zip_source);
+    void OnImportFinished(int file_count, int failed_entries, qint64 elapsed_ms, const QString& first_keyword);
     
     // 文件分类和关键字提取
     QString GetFileKeyword(const QString& file_name);
     QString GetFileCategory(const QString& keyword);
     bool IsTextFile(const QString& file_name);
     
-    // 清理和初始化
-    void CleanupTempFiles();
+    // 把搜索交给搜索线程，有当前关键字时只搜该关键字
+    void StartSearchWorker(const QStringList& search_terms, int max_results, const QVariantMap& options);
+    
+    // 初始化
     void InitializeSearchThread();
+    void InitializeImportThread();
+    void CleanupImportThread();
     
     // 更新文件列表模型
     void UpdateFileListModel();
+    static QVariantMap BuildDatabaseStats(SqliteDbManager* db_manager);
 
 private:
     // 数据库管理器
     std::unique_ptr<SqliteDbManager> m_db_manager_;
     
-    // 临时文件管理
-    std::unique_ptr<QTemporaryDir> m_temp_dir_;
-    
     // 取消标志
     std::atomic<bool> m_cancel_loading_;
     
+    // 导入内存上限（字节）
+    qint64 m_import_memory_budget_;
+    
+    // 导入线程管理
+    std::unique_ptr<QThread> m_import_thread_;
+    QPointer<DbImportWorker> m_import_worker_;
+    bool m_is_importing_;
+    
     // 搜索线程管理
     std::unique_ptr<QThread> m_search_thread_;
     QPointer<DbSearchWorker> m_search_worker_;
@@ -217,8 +730,44 @@ private:
     // 文件列表模型
     FileListModel* m_file_list_model_;
     
+    // 搜索结果模型，结果分批追加
+    SearchResultModel* m_search_result_model_;
+    
+    // 当前关键字合并文本的行模型，高亮按可见行计算
+    TextLineModel* m_text_line_model_;
+    
     // 当前加载的关键字（用于搜索）
     QString m_current_keyword_;
+    // 进行中的异步读取，新的请求到来时取消旧请求
+    QFuture<QString> m_content_future_;
 };
 
+template <typename Fn>
+auto SqliteDbManager::RunOnWriter(Fn fn) -> decltype(fn()) {
+    using Result = decltype(fn());
+    if constexpr (std::is_void_v<Result>) {
+        QMetaObject::invokeMethod(m_writer_context_.get(), fn, Qt::BlockingQueuedConnection);
+    } else {
+        Result result{};
+        QMetaObject::invokeMethod(m_writer_context_.get(), [&result, &fn]() { result = fn(); },
+                                  Qt::BlockingQueuedConnection);
+        return result;
+    }
+}
+
+template <typename T, typename Task>
+QFuture<T> SqliteDbManager::RunAsync(Task task) {
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    promise->start();
+    // 排队期间已取消的任务不再执行；线程池清空时promise析构，future随之结束
+    m_db_pool_.start([promise, task = std::move(task)]() mutable {
+        if (!promise->isCanceled()) {
+            task(*promise);
+        }
+        promise->finish();
+    });
+    return future;
+}
+
 #endif // SQLITE_TEXT_HANDLER_H
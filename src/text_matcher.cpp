@@ -0,0 +1,518 @@
+#include "text_matcher.h"
+#include "utf8_codec.h"
+#include <QRegularExpression>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXT_MATCHER_SSE2 1
+#endif
+
+namespace {
+
+inline bool IsAsciiLetter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline char FoldAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+inline bool IsWordBoundary(const char* data, qsizetype size, qsizetype offset, qsizetype length) {
+    qsizetype end = offset + length;
+    return (offset == 0 || !TextMatcher::IsWordByte(data[offset - 1])) &&
+           (end >= size || !TextMatcher::IsWordByte(data[end]));
+}
+
+// 字面量匹配：候选位置须同时满足首字节和尾字节相等（每次比较16个位置），再校验整个搜索词
+template <bool CaseInsensitive, bool WholeWord>
+class LiteralMatcher : public TextMatcher {
+public:
+    explicit LiteralMatcher(const QByteArray& needle) : m_needle_(needle) {
+        if constexpr (CaseInsensitive) {
+            for (char& c : m_needle_) {
+                c = FoldAscii(c);
+            }
+        }
+        m_first_ = m_needle_.front();
+        m_last_ = m_needle_.back();
+        // 字母的大小写只差0x20这一位，先置位再比较；非字母按原值比较
+        m_first_fold_ = CaseInsensitive && IsAsciiLetter(m_first_) ? 0x20 : 0;
+        m_last_fold_ = CaseInsensitive && IsAsciiLetter(m_last_) ? 0x20 : 0;
+    }
+
+    Match Find(const char* data, qsizetype size, qsizetype from) const override {
+        const char* p = data + from;
+        const char* end = data + size;
+        while (const char* hit = Search(p, end)) {
+            qsizetype offset = hit - data;
+            if (!WholeWord || IsWordBoundary(data, size, offset, m_needle_.size())) {
+                return { offset, m_needle_.size() };
+            }
+            p = hit + 1;
+        }
+        return {};
+    }
+
+private:
+    const char* Search(const char* p, const char* end) const {
+        const qsizetype n = m_needle_.size();
+        if (end - p < n) {
+            return nullptr;
+        }
+        const char* last_start = end - n;
+
+#ifdef TEXT_MATCHER_SSE2
+        const __m128i first = _mm_set1_epi8(m_first_);
+        const __m128i last = _mm_set1_epi8(m_last_);
+        const __m128i first_fold = _mm_set1_epi8(m_first_fold_);
+        const __m128i last_fold = _mm_set1_epi8(m_last_fold_);
+        // 块内16个起点的尾字节也须在缓冲区内
+        for (; last_start - p >= 15; p += 16) {
+            __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n - 1));
+            if constexpr (CaseInsensitive) {
+                block_first = _mm_or_si128(block_first, first_fold);
+                block_last = _mm_or_si128(block_last, last_fold);
+            }
+            __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last));
+            quint32 mask = static_cast<quint32>(_mm_movemask_epi8(eq));
+            while (mask) {
+                const char* candidate = p + qCountTrailingZeroBits(mask);
+                if (Verify(candidate)) {
+                    return candidate;
+                }
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; p <= last_start; ++p) {
+            if (static_cast<char>(p[0] | m_first_fold_) == m_first_ &&
+                static_cast<char>(p[n - 1] | m_last_fold_) == m_last_ && Verify(p)) {
+                return p;
+            }
+        }
+        return nullptr;
+    }
+
+    bool Verify(const char* p) const {
+        if constexpr (!CaseInsensitive) {
+            return std::memcmp(p, m_needle_.constData(), m_needle_.size()) == 0;
+        }
+        for (qsizetype i = 0; i < m_needle_.size(); ++i) {
+            if (FoldAscii(p[i]) != m_needle_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    QByteArray m_needle_;
+    char m_first_;
+    char m_last_;
+    char m_first_fold_;
+    char m_last_fold_;
+};
+
+// 多词匹配：Aho-Corasick自动机，一遍扫描同时查找所有搜索词，每个字节查一次转移表。
+// 字节先映射为等价类（未出现在任何搜索词中的字节同属0类）以压缩转移表，
+// 不区分大小写时大写字母与对应的小写字母同类；
+// 自动机处于根状态时，先按相邻两字节跳过不可能是任何搜索词开头的位置
+template <bool WholeWord>
+class AhoCorasickMatcher : public TextMatcher {
+public:
+    AhoCorasickMatcher(const QList<QByteArray>& needles, bool case_insensitive) {
+        std::fill(std::begin(m_class_), std::end(m_class_), 0);
+        int classes = 1;
+        for (const QByteArray& needle : needles) {
+            for (char c : needle) {
+                unsigned char b = static_cast<unsigned char>(case_insensitive ? FoldAscii(c) : c);
+                if (m_class_[b] == 0) {
+                    m_class_[b] = static_cast<quint16>(classes++);
+                }
+            }
+        }
+        if (case_insensitive) {
+            for (int c = 'A'; c <= 'Z'; ++c) {
+                m_class_[c] = m_class_[c | 0x20];
+            }
+        }
+        m_classes_ = classes;
+
+        // 字典树，-1表示尚无转移
+        std::vector<int> next_state(m_classes_, -1);
+        m_output_.assign(1, -1);
+        for (int i = 0; i < needles.size(); ++i) {
+            int state = 0;
+            for (char c : needles[i]) {
+                qsizetype index = static_cast<qsizetype>(state) * m_classes_ + m_class_[static_cast<unsigned char>(c)];
+                if (next_state[index] < 0) {
+                    next_state[index] = static_cast<int>(m_output_.size());
+                    next_state.resize(next_state.size() + m_classes_, -1);
+                    m_output_.push_back(-1);
+                }
+                state = next_state[index];
+            }
+            // 不区分大小写时仅大小写不同的词落在同一状态，保留第一个
+            if (m_output_[state] < 0) {
+                m_output_[state] = i;
+            }
+            m_lengths_.push_back(needles[i].size());
+        }
+
+        // 按深度广度优先补全失败转移，使每个状态对每个字节类都有确定的转移；
+        // m_dict_指向失败链上最近的一个有输出的状态，用于列出同一位置结束的较短搜索词
+        const int states = static_cast<int>(m_output_.size());
+        std::vector<int> fail(states, 0);
+        std::vector<int> queue;
+        queue.reserve(states);
+        m_dict_.assign(states, -1);
+        for (int c = 0; c < m_classes_; ++c) {
+            int& next = next_state[c];
+            if (next < 0) {
+                next = 0;
+            } else {
+                queue.push_back(next);
+            }
+        }
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const int state = queue[head];
+            for (int c = 0; c < m_classes_; ++c) {
+                const int target = next_state[fail[state] * static_cast<qsizetype>(m_classes_) + c];
+                int& next = next_state[state * static_cast<qsizetype>(m_classes_) + c];
+                if (next < 0) {
+                    next = target;
+                } else {
+                    fail[next] = target;
+                    m_dict_[next] = m_output_[target] >= 0 ? target : m_dict_[target];
+                    queue.push_back(next);
+                }
+            }
+        }
+        // 转移表项为目标状态的行起点乘2，最低位标记该状态或其失败链上有输出
+        m_table_.resize(next_state.size());
+        for (size_t i = 0; i < next_state.size(); ++i) {
+            const int target = next_state[i];
+            m_table_[i] = target * m_classes_ * 2 + (m_output_[target] >= 0 || m_dict_[target] >= 0 ? 1 : 0);
+        }
+
+        // 搜索词可能的开头两字节（单字节的词不限第二字节）
+        std::fill(std::begin(m_pairs_), std::end(m_pairs_), 0);
+        auto variants = [case_insensitive](char c) {
+            QByteArray result(1, c);
+            if (case_insensitive && IsAsciiLetter(c)) {
+                result.append(static_cast<char>(c ^ 0x20));
+            }
+            return result;
+        };
+        for (const QByteArray& needle : needles) {
+            for (char first : variants(needle[0])) {
+                for (int second = 0; second < 256; ++second) {
+                    bool possible = needle.size() == 1;
+                    if (!possible) {
+                        for (char c : variants(needle[1])) {
+                            possible = possible || static_cast<unsigned char>(c) == second;
+                        }
+                    }
+                    if (possible) {
+                        unsigned pair = static_cast<unsigned char>(first) << 8 | second;
+                        m_pairs_[pair >> 6] |= quint64(1) << (pair & 63);
+                    }
+                }
+            }
+        }
+    }
+
+    Match Find(const char* data, qsizetype size, qsizetype from) const override {
+        const int* table = m_table_.data();
+        const quint16* classes = m_class_;
+        const quint64* pairs = m_pairs_;
+        int entry = 0;
+        for (qsizetype i = from; i < size; ++i) {
+            if (entry == 0) {
+                // 在根状态时没有进行中的部分匹配，跳过不可能是任何搜索词开头的位置
+                while (i + 1 < size) {
+                    unsigned pair = static_cast<unsigned char>(data[i]) << 8 | static_cast<unsigned char>(data[i + 1]);
+                    if (pairs[pair >> 6] >> (pair & 63) & 1) {
+                        break;
+                    }
+                    ++i;
+                }
+            }
+            entry = table[(entry >> 1) + classes[static_cast<unsigned char>(data[i])]];
+            if (!(entry & 1)) {
+                continue;
+            }
+            const int state = (entry >> 1) / m_classes_;
+            for (int s = m_output_[state] >= 0 ? state : m_dict_[state]; s >= 0; s = m_dict_[s]) {
+                const int pattern = m_output_[s];
+                const qsizetype length = m_lengths_[pattern];
+                const qsizetype offset = i + 1 - length;
+                if (!WholeWord || IsWordBoundary(data, size, offset, length)) {
+                    return { offset, length, pattern };
+                }
+            }
+        }
+        return {};
+    }
+
+private:
+    quint16 m_class_[256];
+    int m_classes_ = 0;
+    std::vector<int> m_table_;          // 行起点 + 字节类 -> 表项
+    std::vector<int> m_output_;         // 在该状态结束的搜索词，-1为无
+    std::vector<int> m_dict_;
+    std::vector<qsizetype> m_lengths_;
+    quint64 m_pairs_[1024];             // 65536位，按相邻两字节索引
+};
+
+// 逐行解码后匹配：正则，以及需要Unicode大小写折叠的非ASCII搜索词
+class LineMatcher : public TextMatcher {
+public:
+    LineMatcher(const QStringList& patterns, const TextMatcher::Options& options, bool regex)
+        : m_literals_(patterns), m_whole_word_(options.whole_word), m_regex_mode_(regex)
+        , m_case_(options.case_sensitive ? Qt::CaseSensitive : Qt::CaseInsensitive) {
+        if (m_regex_mode_) {
+            // 多个正则以命名分组并列，按命中的分组确定搜索词
+            QString expression = patterns.value(0);
+            if (patterns.size() > 1) {
+                QStringList alternatives;
+                for (int i = 0; i < patterns.size(); ++i) {
+                    m_group_names_.append(QString("t%1").arg(i));
+                    alternatives.append(QString("(?<%1>%2)").arg(m_group_names_.back(), patterns[i]));
+                }
+                expression = alternatives.join('|');
+            }
+            if (m_whole_word_) {
+                expression = QString("\\b(?:%1)\\b").arg(expression);
+            }
+            m_regex_.setPattern(expression);
+            m_regex_.setPatternOptions(options.case_sensitive ? QRegularExpression::NoPatternOption
+                                                              : QRegularExpression::CaseInsensitiveOption);
+            m_valid_ = m_regex_.isValid();
+        }
+    }
+
+    Match Find(const char* data, qsizetype size, qsizetype from) const override {
+        if (!m_valid_) {
+            return {};
+        }
+        const char* p = data + from;
+        const char* end = data + size;
+        while (p <= end) {
+            const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            const char* line_end = newline ? newline : end;
+            const QString line = Utf8Codec::Decode(QByteArray::fromRawData(p, line_end - p));
+
+            qsizetype start = -1;
+            qsizetype length = 0;
+            int pattern = 0;
+            FindInLine(line, &start, &length, &pattern);
+            if (start >= 0) {
+                // UTF-16下标换回字节偏移
+                qsizetype byte_start = QStringView(line).left(start).toUtf8().size();
+                qsizetype byte_length = QStringView(line).mid(start, length).toUtf8().size();
+                return { (p - data) + byte_start, byte_length, pattern };
+            }
+            if (!newline) {
+                break;
+            }
+            p = newline + 1;
+        }
+        return {};
+    }
+
+private:
+    void FindInLine(const QString& line, qsizetype* start, qsizetype* length, int* pattern) const {
+        if (m_regex_mode_) {
+            // 空匹配没有可高亮的内容，跳过
+            QRegularExpressionMatchIterator it = m_regex_.globalMatch(line);
+            while (it.hasNext()) {
+                QRegularExpressionMatch match = it.next();
+                if (match.capturedLength() > 0) {
+                    *start = match.capturedStart();
+                    *length = match.capturedLength();
+                    for (int i = 0; i < m_group_names_.size(); ++i) {
+                        if (match.capturedStart(m_group_names_[i]) >= 0) {
+                            *pattern = i;
+                            break;
+                        }
+                    }
+                    return;
+                }
+            }
+            return;
+        }
+        // 各搜索词取最靠前的命中，位置相同时取较长的
+        for (int i = 0; i < m_literals_.size(); ++i) {
+            const QString& literal = m_literals_[i];
+            for (qsizetype pos = line.indexOf(literal, 0, m_case_); pos >= 0 && (*start < 0 || pos <= *start);
+                 pos = line.indexOf(literal, pos + 1, m_case_)) {
+                qsizetype end = pos + literal.size();
+                if (m_whole_word_ && ((pos > 0 && IsWordChar(line[pos - 1])) || (end < line.size() && IsWordChar(line[end])))) {
+                    continue;
+                }
+                if (*start < 0 || pos < *start || literal.size() > *length) {
+                    *start = pos;
+                    *length = literal.size();
+                    *pattern = i;
+                }
+                break;
+            }
+        }
+    }
+
+    static bool IsWordChar(QChar c) {
+        return c.isLetterOrNumber() || c == u'_';
+    }
+
+    QStringList m_literals_;
+    QStringList m_group_names_;
+    bool m_whole_word_;
+    bool m_regex_mode_;
+    Qt::CaseSensitivity m_case_;
+    QRegularExpression m_regex_;
+};
+
+// 空搜索词：不匹配任何内容
+class EmptyMatcher : public TextMatcher {
+public:
+    EmptyMatcher() { m_valid_ = false; }
+    Match Find(const char*, qsizetype, qsizetype) const override { return {}; }
+};
+
+bool IsAscii(const QByteArray& data) {
+    for (char c : data) {
+        if (static_cast<unsigned char>(c) >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool TextMatcher::IsWordByte(char c) {
+    return IsAsciiLetter(c) || (c >= '0' && c <= '9') || c == '_';
+}
+
+std::unique_ptr<TextMatcher> TextMatcher::Create(const QString& pattern, const Options& options) {
+    std::unique_ptr<TextMatcher> matcher = CreateLiteralOrRegex(pattern, options);
+    matcher->m_patterns_ = QStringList{ pattern };
+    return matcher;
+}
+
+std::unique_ptr<TextMatcher> TextMatcher::Create(const QStringList& patterns, const Options& options) {
+    QStringList unique;
+    for (const QString& pattern : patterns) {
+        if (!pattern.isEmpty() && !unique.contains(pattern)) {
+            unique.append(pattern);
+        }
+    }
+    if (unique.size() <= 1) {
+        return Create(unique.value(0), options);
+    }
+
+    std::unique_ptr<TextMatcher> matcher;
+    QList<QByteArray> needles;
+    bool ascii = true;
+    for (const QString& pattern : unique) {
+        needles.append(pattern.toUtf8());
+        ascii = ascii && IsAscii(needles.back());
+    }
+    if (options.regex || (!options.case_sensitive && !ascii)) {
+        matcher = std::make_unique<LineMatcher>(unique, options, options.regex);
+    } else if (options.whole_word) {
+        matcher = std::make_unique<AhoCorasickMatcher<true>>(needles, !options.case_sensitive);
+    } else {
+        matcher = std::make_unique<AhoCorasickMatcher<false>>(needles, !options.case_sensitive);
+    }
+    matcher->m_patterns_ = unique;
+    return matcher;
+}
+
+std::unique_ptr<TextMatcher> TextMatcher::CreateLiteralOrRegex(const QString& pattern, const Options& options) {
+    if (options.regex) {
+        return std::make_unique<LineMatcher>(QStringList{ pattern }, options, true);
+    }
+
+    const QByteArray needle = pattern.toUtf8();
+    if (needle.isEmpty()) {
+        return std::make_unique<EmptyMatcher>();
+    }
+    if (!options.case_sensitive && !IsAscii(needle)) {
+        return std::make_unique<LineMatcher>(QStringList{ pattern }, options, false);
+    }
+
+    if (options.case_sensitive) {
+        if (options.whole_word) {
+            return std::make_unique<LiteralMatcher<false, true>>(needle);
+        }
+        return std::make_unique<LiteralMatcher<false, false>>(needle);
+    }
+    if (options.whole_word) {
+        return std::make_unique<LiteralMatcher<true, true>>(needle);
+    }
+    return std::make_unique<LiteralMatcher<true, false>>(needle);
+}
+
+QList<TextMatcher::Span> TextMatcher::FindAll(QStringView line) const {
+    QList<Span> spans;
+    const QByteArray utf8 = line.toUtf8();
+    qsizetype utf16_pos = 0;
+    qsizetype byte_pos = 0;
+    for (Match match = Find(utf8); match.offset >= 0; match = Find(utf8, byte_pos)) {
+        // 从上一个位置增量换算UTF-16下标
+        utf16_pos += Utf16Length(utf8.constData() + byte_pos, match.offset - byte_pos);
+        qsizetype utf16_length = Utf16Length(utf8.constData() + match.offset, match.length);
+        spans.append({ utf16_pos, utf16_length, match.pattern });
+        utf16_pos += utf16_length;
+        byte_pos = match.offset + qMax<qsizetype>(1, match.length);
+        if (byte_pos >= utf8.size()) {
+            break;
+        }
+    }
+    return spans;
+}
+
+QList<qsizetype> TextMatcher::MatchingLines(const char* data, qsizetype size, qsizetype max_lines) const {
+    QList<qsizetype> lines;
+    qsizetype line = 0;
+    qsizetype line_start = 0;
+    for (Match match = Find(data, size, 0); match.offset >= 0; match = Find(data, size, line_start)) {
+        // 数出命中所在的行
+        const char* p = data + line_start;
+        const char* hit = data + match.offset;
+        while (const char* newline = static_cast<const char*>(std::memchr(p, '\n', hit - p))) {
+            ++line;
+            p = newline + 1;
+        }
+        lines.append(line);
+        if (lines.size() == max_lines) {
+            break;
+        }
+        // 同一行只记一次，从下一行继续
+        const char* newline = static_cast<const char*>(std::memchr(hit, '\n', size - match.offset));
+        if (!newline) {
+            break;
+        }
+        line_start = newline + 1 - data;
+        ++line;
+    }
+    return lines;
+}
+
+qsizetype TextMatcher::Utf16Length(const char* data, qsizetype byte_count) {
+    // 每个非续字节开始一个字符，4字节序列在UTF-16中占两个单元
+    qsizetype length = 0;
+    for (qsizetype i = 0; i < byte_count; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if ((c & 0xC0) != 0x80) {
+            length += c >= 0xF0 ? 2 : 1;
+        }
+    }
+    return length;
+}
@@ -0,0 +1,69 @@
+#ifndef TEXT_MATCHER_H
+#define TEXT_MATCHER_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QList>
+#include <memory>
+
+// 搜索词匹配器
+// 直接在UTF-8字节上查找，按查询选项在搜索开始时选定实现：
+//   字面量（默认）  SIMD按搜索词首/尾字节同时过滤候选位置，再逐字节校验；不区分大小写时按ASCII折叠
+//   整词            字面量命中后检查两侧不是单词字符（ASCII字母、数字、下划线）
+//   正则            仅在用户要求时使用QRegularExpression，逐行解码后匹配
+//   多词            Aho-Corasick自动机一遍扫描找出所有搜索词，命中带有搜索词序号
+// 不区分大小写且搜索词含非ASCII字符时（如西里尔字母），改为逐行解码后按Unicode折叠比较。
+// 搜索词不含换行，命中不会跨行。
+class TextMatcher {
+public:
+    struct Options {
+        bool case_sensitive = false;
+        bool whole_word = false;
+        bool regex = false;
+    };
+
+    struct Match {
+        qsizetype offset = -1;    // 字节偏移，未命中为-1
+        qsizetype length = 0;     // 命中的字节数
+        int pattern = 0;          // 命中的搜索词在Patterns()中的序号
+    };
+
+    // 行内命中区间（UTF-16下标）
+    struct Span {
+        qsizetype start = 0;
+        qsizetype length = 0;
+        int pattern = 0;
+    };
+
+    virtual ~TextMatcher() = default;
+
+    // 在[data, data + size)中从from开始查找第一个命中
+    virtual Match Find(const char* data, qsizetype size, qsizetype from = 0) const = 0;
+    Match Find(const QByteArray& data, qsizetype from = 0) const { return Find(data.constData(), data.size(), from); }
+    bool IsValid() const { return m_valid_; }
+    const QStringList& Patterns() const { return m_patterns_; }
+
+    // 一行中所有不重叠的命中，用于高亮和标注命中的搜索词
+    QList<Span> FindAll(QStringView line) const;
+    // 多行UTF-8文本中有命中的行（从0开始，升序），最多max_lines行（-1为不限）
+    QList<qsizetype> MatchingLines(const char* data, qsizetype size, qsizetype max_lines = -1) const;
+
+    static std::unique_ptr<TextMatcher> Create(const QString& pattern, const Options& options = Options());
+    // 多个搜索词一起匹配：同一位置结束的命中取最长的搜索词；空词被忽略，重复的词只保留第一个
+    static std::unique_ptr<TextMatcher> Create(const QStringList& patterns, const Options& options = Options());
+    // UTF-8前缀[data, data + byte_count)对应的UTF-16长度
+    static qsizetype Utf16Length(const char* data, qsizetype byte_count);
+    static bool IsWordByte(char c);
+
+private:
+    static std::unique_ptr<TextMatcher> CreateLiteralOrRegex(const QString& pattern, const Options& options);
+
+protected:
+    bool m_valid_ = true;
+    QStringList m_patterns_;
+};
+
+#endif // TEXT_MATCHER_H
@@ -1,11 +1,14 @@
 #include "src/textfilehandler.h"
+#include "zip_archive_reader.h"
+#include "utf8_codec.h"
+#include "file_classifier.h"
 #include <QFileInfo>
 #include <QUrl>
 #include <QDataStream>
 #include <QDebug>
 #include <QProcess>
 #include <QDir>
-#include <QRegularExpression>
+#include <QElapsedTimer>
 #include <QVariantList>
 #include <QVariantMap>
 
@@ -78,21 +81,202 @@ QVariantMap FileListModel::getFile(int index) const {
     return result;
 }
 
+// SearchResultModel 实现
+SearchResultModel::SearchResultModel(QObject* parent) : QAbstractListModel(parent) {
+}
+
+int SearchResultModel::rowCount(const QModelIndex& parent) const {
+    Q_UNUSED(parent)
+    return m_results.size();
+}
+
+QVariant SearchResultModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_results.size()) {
+        return QVariant();
+    }
+    
+    const SearchResult& result = m_results[index.row()];
+    
+    switch (role) {
+        case LineNumberRole:
+            return result.lineNumber;
+        case PreviewRole:
+        case Qt::DisplayRole:
+            return result.preview;
+        case FullLineRole:
+            return result.fullLine;
+        case FileNameRole:
+            return result.fileName;
+        case KeywordRole:
+            return result.keyword;
+        case ArchiveIdRole:
+            return result.archiveId;
+        case TermRole:
+            return result.term;
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> SearchResultModel::roleNames() const {
+    QHash<int, QByteArray> roles;
+    roles[LineNumberRole] = "lineNumber";
+    roles[PreviewRole] = "preview";
+    roles[FullLineRole] = "fullLine";
+    roles[FileNameRole] = "fileName";
+    roles[KeywordRole] = "keyword";
+    roles[ArchiveIdRole] = "archiveId";
+    roles[TermRole] = "term";
+    return roles;
+}
+
+void SearchResultModel::appendResults(const QList<SearchResult>& results) {
+    if (results.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_results.size(), m_results.size() + results.size() - 1);
+    m_results.append(results);
+    endInsertRows();
+    emit countChanged();
+}
+
+void SearchResultModel::clear() {
+    if (m_results.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    m_results.clear();
+    endResetModel();
+    emit countChanged();
+}
+
+QVariantMap SearchResultModel::getResult(int index) const {
+    QVariantMap result;
+    if (index >= 0 && index < m_results.size()) {
+        const SearchResult& row = m_results[index];
+        result["lineNumber"] = row.lineNumber;
+        result["preview"] = row.preview;
+        result["fullLine"] = row.fullLine;
+        result["fileName"] = row.fileName;
+        result["keyword"] = row.keyword;
+        result["archiveId"] = row.archiveId;
+        result["term"] = row.term;
+    }
+    return result;
+}
+
+// TextLineModel 实现
+TextLineModel::TextLineModel(QObject* parent) : QAbstractListModel(parent) {
+    // 可见行加上列表的缓冲区远小于这个数
+    m_spanCache.setMaxCost(2000);
+}
+
+int TextLineModel::rowCount(const QModelIndex& parent) const {
+    Q_UNUSED(parent)
+    return m_lineStarts.size();
+}
+
+QVariant TextLineModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_lineStarts.size()) {
+        return QVariant();
+    }
+
+    switch (role) {
+        case LineNumberRole:
+            return index.row() + 1;
+        case TextRole:
+        case Qt::DisplayRole:
+            return lineAt(index.row()).toString();
+        case SpansRole: {
+            if (!m_matcher) {
+                return QVariantList();
+            }
+            if (const QVariantList* cached = m_spanCache.object(index.row())) {
+                return *cached;
+            }
+            auto spans = new QVariantList;
+            for (const TextMatcher::Span& span : m_matcher->FindAll(lineAt(index.row()))) {
+                spans->append(QVariantMap{ { "start", span.start }, { "length", span.length } });
+            }
+            const QVariantList result = *spans;
+            m_spanCache.insert(index.row(), spans);
+            return result;
+        }
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> TextLineModel::roleNames() const {
+    QHash<int, QByteArray> roles;
+    roles[LineNumberRole] = "lineNumber";
+    roles[TextRole] = "lineText";
+    roles[SpansRole] = "spans";
+    return roles;
+}
+
+void TextLineModel::setContent(const QString& content) {
+    beginResetModel();
+    m_content = content;
+    m_lineStarts.clear();
+    m_spanCache.clear();
+    if (!m_content.isEmpty()) {
+        m_lineStarts.append(0);
+        for (qsizetype pos = m_content.indexOf(u'\n'); pos >= 0; pos = m_content.indexOf(u'\n', pos + 1)) {
+            m_lineStarts.append(pos + 1);
+        }
+    }
+    endResetModel();
+    emit countChanged();
+}
+
+void TextLineModel::setMatcher(std::shared_ptr<const TextMatcher> matcher) {
+    if (!m_matcher && !matcher) {
+        return;
+    }
+    m_matcher = std::move(matcher);
+    m_spanCache.clear();
+    if (!m_lineStarts.isEmpty()) {
+        emit dataChanged(index(0), index(m_lineStarts.size() - 1), { SpansRole });
+    }
+}
+
+void TextLineModel::clear() {
+    m_matcher.reset();
+    setContent(QString());
+}
+
+void TextLineModel::clearHighlight() {
+    setMatcher(nullptr);
+}
+
+QStringView TextLineModel::lineAt(int row) const {
+    const qsizetype start = m_lineStarts[row];
+    qsizetype end = row + 1 < m_lineStarts.size() ? m_lineStarts[row + 1] - 1 : m_content.size();
+    if (end > start && m_content[end - 1] == u'\r') {
+        --end;
+    }
+    return QStringView(m_content).mid(start, end - start);
+}
+
 // SearchWorker 实现
 SearchWorker::SearchWorker(QObject *parent) 
-    : QObject(parent), m_maxResults(100), m_cancelled(false) {
+    : QObject(parent), m_maxResults(100), m_cancelled(false), m_searchId(0) {
 }
 
 SearchWorker::~SearchWorker() {
     m_cancelled = true;
 }
 
-void SearchWorker::setSearchData(const QString &content, const QString &searchText, int maxResults) {
+void SearchWorker::setSearchData(const QString &content, const QString &searchText, int maxResults,
+                                 const TextMatcher::Options &options) {
     QMutexLocker locker(&m_mutex);
     m_content = content;
     m_searchText = searchText;
+    m_options = options;
     m_maxResults = maxResults;
     m_cancelled = false;
+    ++m_searchId;
 }
 
 void SearchWorker::startSearch() {
@@ -107,117 +291,172 @@ void SearchWorker::cancelSearch() {
 
 void SearchWorker::performSearch() {
     qDebug() << "SearchWorker::performSearch 开始执行";
-    qDebug() << "内容长度:" << m_content.length() << "搜索词:" << m_searchText;
     
-    if (m_content.isEmpty() || m_searchText.isEmpty()) {
+    QString content;
+    QString searchText;
+    TextMatcher::Options options;
+    int maxResults;
+    int searchId;
+    {
+        QMutexLocker locker(&m_mutex);
+        content = m_content;
+        searchText = m_searchText;
+        options = m_options;
+        maxResults = m_maxResults;
+        searchId = m_searchId;
+    }
+    // 取消或有新的搜索设置进来时提前结束
+    auto isCancelled = [this, searchId]() { return m_cancelled || m_searchId != searchId; };
+    qDebug() << "内容长度:" << content.length() << "搜索词:" << searchText;
+    
+    if (content.isEmpty() || searchText.isEmpty()) {
         qDebug() << "内容或搜索词为空，结束搜索";
-        emit searchFinished();
+        emit searchFinished(searchId);
         return;
     }
-
-    QList<SearchResult> results;
-    QString highlightedContent;
-    
-    // 分割文本行
-    QStringList lines = m_content.split('\n');
-    int totalLines = lines.size();
-    
-    // 创建搜索正则表达式
-    QRegularExpression searchRegex(QRegularExpression::escape(m_searchText), 
-                                   QRegularExpression::CaseInsensitiveOption);
-    
-    int foundCount = 0;
-    int processedLines = 0;
-    
-    // 分批处理，每批500行
-    const int batchSize = 500;
+    if (!TextMatcher::Create(searchText, options)->IsValid()) {
+        qDebug() << "搜索词无效（正则表达式错误？），结束搜索";
+        emit searchFinished(searchId);
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    
+    // 按换行对齐切块，块内的行不会跨块
+    QList<QStringView> chunks;
+    const QStringView view(content);
+    for (qsizetype pos = 0; pos < view.size();) {
+        qsizetype end = qMin(pos + k_chunkChars, view.size());
+        qsizetype newline = view.indexOf(u'\n', end - 1);
+        end = newline < 0 ? view.size() : newline + 1;
+        chunks.append(view.mid(pos, end - pos));
+        pos = end;
+    }
     
-    for (int i = 0; i < totalLines && !m_cancelled && foundCount < m_maxResults; i++) {
-        const QString &line = lines[i];
-        
-        // 检查是否匹配
-        QRegularExpressionMatch match = searchRegex.match(line);
-        if (match.hasMatch()) {
-            SearchResult result;
-            result.lineNumber = i + 1;
-            result.fullLine = line;
-            result.preview = line.length() > 50 ? line.left(50) + "..." : line;
-            results.append(result);
-            foundCount++;
-            
-            // 创建高亮内容，保留原始搜索词
-            QString highlightedLine = line;
-            int offset = 0;
-            while (true) {
-                match = searchRegex.match(highlightedLine, offset);
-                if (!match.hasMatch()) break;
-                
-                int start = match.capturedStart();
-                int length = match.capturedLength();
-                
-                highlightedLine.replace(
-                    start, length, 
-                    QString("<span style=\"background-color: #DBEAFE; color: #1D4ED8; font-weight: bold;\">%1</span>")
-                        .arg(highlightedLine.mid(start, length))
-                );
-                
-                // 更新偏移量，避免重复高亮 (73 是高亮标签的近似长度)
-                offset = start + length + 73; 
+    // 已完成的连续前缀按块顺序发出结果（行号加上前面各块的行数），
+    // 累计命中数达到上限后，stopBefore之后的块跳过
+    const int chunkCount = chunks.size();
+    QList<ChunkResult> chunkResults(chunkCount);
+    QList<bool> chunkDone(chunkCount, false);
+    QMutex prefixMutex;
+    int prefixEnd = 0;
+    int prefixMatches = 0;
+    int prefixLines = 0;
+    std::atomic<int> nextChunk{0};
+    std::atomic<int> stopBefore{chunkCount};
+    std::atomic<int> doneChunks{0};
+    // 各线程只写自己领取的元素，经data()访问，避免并发调用非const的operator[]
+    ChunkResult* resultData = chunkResults.data();
+    
+    auto worker = [&]() {
+        // 每个线程各建一个匹配器，正则对象不在线程间共享
+        const std::unique_ptr<TextMatcher> matcher = TextMatcher::Create(searchText, options);
+        while (!isCancelled()) {
+            int index = nextChunk.fetch_add(1);
+            if (index >= chunkCount || index >= stopBefore.load()) {
+                break;
             }
+            resultData[index] = scanChunk(chunks.at(index), index == chunkCount - 1, *matcher, maxResults);
+            doneChunks.fetch_add(1);
             
-            // 使用 <p> 标签包装高亮行
-            highlightedContent += QString("<p style=\"margin: 0; padding: 4px 0; line-height: 1.5; border-bottom: 1px solid #F3F4F6;\">%1</p>")
-                                .arg(highlightedLine.isEmpty() ? "&nbsp;" : highlightedLine);
-        } else {
-            // 普通行，进行HTML转义并用 <p> 包装
-            QString escapedLine = line;
-            escapedLine.replace("&", "&amp;")
-                       .replace("<", "&lt;")
-                       .replace(">", "&gt;");
-            
-            highlightedContent += QString("<p style=\"margin: 0; padding: 4px 0; line-height: 1.5; border-bottom: 1px solid #F3F4F6;\">%1</p>")
-                                .arg(escapedLine.isEmpty() ? "&nbsp;" : escapedLine);
-        }
-        
-        processedLines++;
-        
-        // 每处理一批后发送进度并检查取消
-        if (processedLines % batchSize == 0) {
-            int progress = (processedLines * 100) / totalLines;
-            emit searchProgress(progress);
-            
-            if (m_cancelled) {
-                emit searchCancelled();
-                return;
+            QMutexLocker locker(&prefixMutex);
+            chunkDone[index] = true;
+            QList<SearchResult> batch;
+            while (prefixEnd < chunkCount && chunkDone[prefixEnd] && prefixMatches < maxResults) {
+                const ChunkResult& chunk = resultData[prefixEnd];
+                for (int j = 0; j < chunk.results.size() && prefixMatches < maxResults; ++j, ++prefixMatches) {
+                    batch.append(chunk.results[j]);
+                    batch.back().lineNumber += prefixLines;
+                }
+                prefixLines += chunk.lineCount;
+                ++prefixEnd;
+                if (prefixMatches >= maxResults) {
+                    stopBefore = prefixEnd;
+                }
+            }
+            if (!batch.isEmpty() && !isCancelled()) {
+                emit searchResultsBatch(searchId, batch);
             }
-            
-            // 让出CPU时间，避免长时间占用线程
-            QThread::msleep(1);
         }
+    };
+    
+    const int threadCount = qMin(chunkCount, qMax(1, m_pool.maxThreadCount()));
+    for (int i = 0; i < threadCount; ++i) {
+        m_pool.start(worker);
+    }
+    // 等待期间按完成的块数报告进度，取消在领取每个块时检查
+    while (!m_pool.waitForDone(50)) {
+        emit searchProgress(doneChunks.load() * 100 / chunkCount);
     }
     
-    if (m_cancelled) {
-        emit searchCancelled();
+    if (isCancelled()) {
+        emit searchCancelled(searchId);
         return;
     }
     
+    // 结果已逐批发出，统计在maxResults处截断后的命中数
+    int matches = 0;
+    for (int i = 0; i < chunkCount && i < stopBefore.load(); ++i) {
+        matches += chunkResults.at(i).results.size();
+    }
+    matches = qMin(matches, maxResults);
+    
+    const qint64 elapsedMs = qMax<qint64>(1, timer.elapsed());
+    qDebug() << "搜索完成：" << matches << "条命中，耗时" << elapsedMs << "ms，"
+             << QString::number(content.size() * 2 / 1e6 / elapsedMs, 'f', 2) << "GB/s";
+    
     // 发送最终结果
     emit searchProgress(100);
-    emit searchResultReady(results, highlightedContent);
-    emit searchFinished();
+    emit searchFinished(searchId);
+}
+
+SearchWorker::ChunkResult SearchWorker::scanChunk(QStringView chunk, bool isLast, const TextMatcher& matcher, int maxResults) {
+    // 先在整块的UTF-8上定位命中行，只为命中行取出行内容，其余行只计数
+    const QByteArray utf8 = chunk.toUtf8();
+    const QList<qsizetype> matchedLines = matcher.MatchingLines(utf8.constData(), utf8.size(), maxResults);
+    
+    ChunkResult result;
+    qsizetype start = 0;
+    qsizetype nextMatch = 0;
+    while (result.results.size() < maxResults) {
+        qsizetype newline = chunk.indexOf(u'\n', start);
+        if (newline < 0 && start >= chunk.size() && !isLast) {
+            break;   // 非末尾块以换行结束，没有剩余的行
+        }
+        const qsizetype lineEnd = newline < 0 ? chunk.size() : newline;
+        
+        if (nextMatch < matchedLines.size() && matchedLines[nextMatch] == result.lineCount) {
+            ++nextMatch;
+            const QStringView line = chunk.mid(start, lineEnd - start);
+            SearchResult match;
+            match.lineNumber = result.lineCount + 1;
+            match.fullLine = line.toString();
+            match.preview = line.size() > 50 ? line.left(50).toString() + "..." : match.fullLine;
+            result.results.append(match);
+        }
+        ++result.lineCount;
+        
+        if (newline < 0) {
+            break;
+        }
+        start = newline + 1;
+    }
+    return result;
 }
 
 // TextFileHandler 构造函数修改
 TextFileHandler::TextFileHandler(QObject *parent) 
-    : QObject(parent), m_cancelLoading(false), m_tempDir(nullptr) {
+    : QObject(parent), m_cancelLoading(false) {
     
     qDebug() << "TextFileHandler 构造函数开始";
     
     // 初始化文件缓存 (最大50MB)
     m_fileCache.setMaxCost(50 * 1024 * 1024);
     
-    // 初始化文件列表模型
+    // 初始化文件列表模型、搜索结果模型和文本内容行模型
     m_fileListModel = new FileListModel(this);
+    m_searchResultModel = new SearchResultModel(this);
+    m_textLineModel = new TextLineModel(this);
     
     // 初始化搜索线程和工作对象
     initializeSearchThread();
@@ -225,7 +464,6 @@ TextFileHandler::TextFileHandler(QObject *parent)
 
 TextFileHandler::~TextFileHandler() {
     cleanupSearchThread();
-    cleanupTempFiles();
     m_fileCache.clear();
 }
 
@@ -242,23 +480,26 @@ void TextFileHandler::initializeSearchThread() {
     // 连接信号
     connect(m_searchWorker, &SearchWorker::searchProgress, 
             this, &TextFileHandler::searchProgress);
-    connect(m_searchWorker, &SearchWorker::searchResultReady, 
-            this, [this](const QList<SearchResult> &results, const QString &highlightedContent) {
-        qDebug() << "收到搜索结果，结果数量:" << results.size();
-        QVariantList variantResults;
-        for (const SearchResult &result : results) {
-            QVariantMap map;
-            map["lineNumber"] = result.lineNumber;
-            map["preview"] = result.preview;
-            map["fullLine"] = result.fullLine;
-            variantResults.append(map);
+    // 旧搜索晚到的批次直接丢弃
+    connect(m_searchWorker, &SearchWorker::searchResultsBatch,
+            this, [this](int searchId, const QList<SearchResult> &batch) {
+        if (m_searchWorker && searchId == m_searchWorker->currentSearchId()) {
+            m_searchResultModel->appendResults(batch);
+        }
+    });
+    // 被新搜索取代的旧搜索也会结束或取消，只转发当前搜索的
+    connect(m_searchWorker, &SearchWorker::searchFinished,
+            this, [this](int searchId) {
+        if (m_searchWorker && searchId == m_searchWorker->currentSearchId()) {
+            emit searchFinished();
+        }
+    });
+    connect(m_searchWorker, &SearchWorker::searchCancelled,
+            this, [this](int searchId) {
+        if (m_searchWorker && searchId == m_searchWorker->currentSearchId()) {
+            emit searchCancelled();
         }
-        emit searchResultReady(variantResults, highlightedContent);
     });
-    connect(m_searchWorker, &SearchWorker::searchFinished, 
-            this, &TextFileHandler::searchFinished);
-    connect(m_searchWorker, &SearchWorker::searchCancelled, 
-            this, &TextFileHandler::searchCancelled);
     
     // 启动搜索线程
     m_searchThread->start();
@@ -293,7 +534,8 @@ void TextFileHandler::cleanupSearchThread() {
     qDebug() << "搜索线程清理完成";
 }
 
-void TextFileHandler::startAsyncSearch(const QString &content, const QString &searchText, int maxResults) {
+void TextFileHandler::startAsyncSearch(const QString &content, const QString &searchText, int maxResults,
+                                       const QVariantMap &options) {
     qDebug() << "TextFileHandler::startAsyncSearch 被调用";
     qDebug() << "搜索词:" << searchText;
     qDebug() << "内容长度:" << content.length();
@@ -301,7 +543,15 @@ void TextFileHandler::startAsyncSearch(const QString &content, const QString &se
     
     if (m_searchWorker) {
         qDebug() << "设置搜索数据";
-        m_searchWorker->setSearchData(content, searchText, maxResults);
+        TextMatcher::Options matcherOptions;
+        matcherOptions.case_sensitive = options.value("caseSensitive", false).toBool();
+        matcherOptions.whole_word = options.value("wholeWord", false).toBool();
+        matcherOptions.regex = options.value("regex", false).toBool();
+        m_searchResultModel->clear();
+        // 高亮只在可见行取数据时计算，这里换上新的匹配器即可
+        std::shared_ptr<const TextMatcher> matcher = TextMatcher::Create(searchText, matcherOptions);
+        m_textLineModel->setMatcher(!searchText.isEmpty() && matcher->IsValid() ? matcher : nullptr);
+        m_searchWorker->setSearchData(content, searchText, maxResults, matcherOptions);
         qDebug() << "调用 startSearch";
         QMetaObject::invokeMethod(m_searchWorker, "startSearch", Qt::QueuedConnection);//等价的信号-槽连接
                                                                                        //Qt::QueuedConnection 的意义
@@ -375,18 +625,25 @@ void TextFileHandler::loadTextFileAsync(const QString &fileName) {
                 return;
             }
             
-            // 分块读取文件
-            QTextStream in(&file);
-            in.setEncoding(QStringConverter::Utf8);
-
+            // 分块读取文件，在UTF-8字符边界处解码，纯ASCII块走快速路径
             QString content;
+            QByteArray pending;
             qint64 bytesRead = 0;
             const int CHUNK_SIZE = 1024 * 1024; // 1MB 分块大小
 
-            while (!in.atEnd() && !m_cancelLoading) {
-                content += in.read(CHUNK_SIZE);
+            while (!file.atEnd() && !m_cancelLoading) {
+                QByteArray block = file.read(CHUNK_SIZE);
+                if (bytesRead == 0 && block.startsWith("\xEF\xBB\xBF")) {
+                    block.remove(0, 3);   // 与QTextStream一致，跳过BOM
+                }
+                pending += block;
                 bytesRead += CHUNK_SIZE;
 
+                qint64 complete = file.atEnd() ? pending.size()
+                                               : Utf8Codec::CompleteLength(pending.constData(), pending.size());
+                content += Utf8Codec::Decode(pending.constData(), complete);
+                pending.remove(0, complete);
+
                 // 计算并发送进度
                 int progress = qMin(100, static_cast<int>((bytesRead * 100) / fileSize));
                 emit loadProgress(progress);
@@ -398,6 +655,10 @@ void TextFileHandler::loadTextFileAsync(const QString &fileName) {
             if (m_cancelLoading) {
                 emit loadError("文件加载已取消");
             } else {
+                // 行模型只在主线程修改
+                QMetaObject::invokeMethod(this, [this, content]() {
+                    m_textLineModel->setContent(content);
+                }, Qt::QueuedConnection);
                 emit fileLoaded(content);
             }
         } catch (const std::exception& e) {
@@ -419,28 +680,22 @@ void TextFileHandler::loadTextFileAsync(const QString &fileName) {
 void TextFileHandler::processZipFile(const QString& zipPath) {
     emit loadProgress(10);  // 开始处理
 
-    // 创建临时目录
-    cleanupTempFiles();
-    m_tempDir = std::make_unique<QTemporaryDir>();
-    if (!m_tempDir->isValid()) {
-        throw std::runtime_error("无法创建临时目录");
+    // 进程内读取ZIP中央目录
+    ZipArchiveReader reader(zipPath);
+    if (!reader.Open()) {
+        throw std::runtime_error(QString("ZIP文件读取失败：%1").arg(reader.ErrorString()).toStdString());
     }
 
     emit loadProgress(20);
 
-    // 解压ZIP文件
-    if (!extractZipFile(zipPath, m_tempDir->path())) {
-        throw std::runtime_error("ZIP文件解压失败");
-    }
-
-    emit loadProgress(60);  // 解压完成
-
-    // 扫描所有文本文件
-    QList<FileMeta> allTextFiles = scanTextFiles(m_tempDir->path());
+    // 按文件名筛选所有文本条目
+    QList<FileMeta> allTextFiles = scanTextFiles(reader);
     if (allTextFiles.isEmpty()) {
         throw std::runtime_error("ZIP文件中未找到可识别的文本文件");
     }
 
+    emit loadProgress(60);  // 条目筛选完成
+
     // 1. 文件分组
     QMap<QString, QList<FileMeta>> groupedFiles;
     for (const FileMeta& file : allTextFiles) {
@@ -454,7 +709,7 @@ void TextFileHandler::processZipFile(const QString& zipPath) {
         const QList<FileMeta>& group = it.value();
 
         // 2.1 内容合并
-        QString mergedContent = mergeTextFiles(group);
+        QString mergedContent = mergeTextFiles(reader, group);
         qint64 totalSize = mergedContent.toUtf8().size();
 
         // 2.2 存入缓存，使用 keyword 作为唯一的 key
@@ -490,125 +745,56 @@ void TextFileHandler::processZipFile(const QString& zipPath) {
     emit loadProgress(100);  // 全部处理完成
 }
 
-bool TextFileHandler::extractZipFile(const QString& zipPath, const QString& extractDir) {
-    qDebug() << "开始解压ZIP文件:" << zipPath << "到目录:" << extractDir;
-    
-    // 方法1：尝试使用系统的unzip命令（跨平台）
-    QProcess process;
-    
-#ifdef Q_OS_WIN
-    // Windows系统使用PowerShell的Expand-Archive命令
-    QString command = "powershell";
-    QStringList arguments;
-    // 转换路径格式，避免特殊字符问题
-    QString normalizedZipPath = QDir::toNativeSeparators(zipPath);
-    QString normalizedExtractDir = QDir::toNativeSeparators(extractDir);
-    
-    arguments << "-Command" 
-              << QString("try { Expand-Archive -Path \"%1\" -DestinationPath \"%2\" -Force; exit 0 } catch { exit 1 }")
-                 .arg(normalizedZipPath).arg(normalizedExtractDir);
-#else
-    // Unix/Linux/Mac系统使用unzip命令
-    QString command = "unzip";
-    QStringList arguments;
-    arguments << "-o" << zipPath << "-d" << extractDir;
-#endif
-
-    qDebug() << "执行解压命令:" << command << arguments;
-    connect(&process, &QProcess::errorOccurred, [](QProcess::ProcessError err){
-        qDebug() << "QProcess error:" << err;
-    });
-    process.start(command, arguments);
-    process.waitForFinished(30000); // 等待30秒
-    
-    qDebug() << "解压命令退出码:" << process.exitCode();
-    qDebug() << "标准输出:" << process.readAllStandardOutput();
-    qDebug() << "错误输出:" << process.readAllStandardError();
-    
-    if (process.exitCode() == 0) {
-        // 验证是否确实解压了文件
-        QDir extractedDir(extractDir);
-        QStringList entries = extractedDir.entryList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-        qDebug() << "解压后的文件/目录数量:" << entries.size();
-        if (!entries.isEmpty()) {
-            qDebug() << "解压成功，找到文件:" << entries;
-            return true;
-        }
-    }
-    else {
-        qDebug() << "退出码" << process.exitCode();
-    }
-    
-    qDebug() << "系统命令解压失败，尝试创建测试文件";
-    return false; // 添加返回值
-}
-
-
-
-QList<FileMeta> TextFileHandler::scanTextFiles(const QString& dirPath) {
-    qDebug() << "开始扫描文本文件，目录:" << dirPath;
+QList<FileMeta> TextFileHandler::scanTextFiles(const ZipArchiveReader& reader) {
+    qDebug() << "开始扫描ZIP条目，归档:" << reader.ArchivePath();
     
     QList<FileMeta> textFiles;
-    QDir dir(dirPath);
-    
-    if (!dir.exists()) {
-        qDebug() << "目录不存在:" << dirPath;
-        return textFiles;
-    }
-    
-    // 首先列出所有文件和目录（不使用过滤器）
-    QFileInfoList allEntries = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
-    qDebug() << "目录中总共有" << allEntries.size() << "个条目";
-    
-    for (const QFileInfo& info : allEntries) {
-        qDebug() << "  条目:" << info.fileName() << (info.isDir() ? "[目录]" : "[文件]") << "大小:" << info.size();
-    }
     
-    // 扫描所有条目（不使用nameFilters，因为它会影响目录的遍历）
-    for (const QFileInfo& fileInfo : allEntries) {
-        if (fileInfo.isDir()) {
-            qDebug() << "进入子目录:" << fileInfo.fileName();
-            // 递归扫描子目录
-            textFiles.append(scanTextFiles(fileInfo.absoluteFilePath()));
-        } else {
-            QString keyword = getFileKeyword(fileInfo.fileName());
-            if (!keyword.isEmpty()) {
-                FileMeta meta(
-                    fileInfo.absoluteFilePath(),  // path
-                    fileInfo.fileName(),          // name
-                    fileInfo.size(),              // size
-                    keyword,                      // keyword
-                    getFileCategory(keyword)      // category
-                );
-                textFiles.append(meta);
-                qDebug() << "添加文本文件:" << fileInfo.absoluteFilePath() 
-                         << "关键字:" << keyword << "类别:" << meta.category;
-            }
+    for (const ZipEntryInfo& entry : reader.Entries()) {
+        if (entry.is_directory) {
+            continue;
+        }
+        
+        QString keyword = getFileKeyword(entry.FileName());
+        if (!keyword.isEmpty()) {
+            FileMeta meta(
+                entry.name,                                   // path -> 归档内路径
+                entry.FileName(),                             // name
+                static_cast<qint64>(entry.uncompressed_size), // size
+                keyword,                                      // keyword
+                getFileCategory(keyword)                      // category
+            );
+            textFiles.append(meta);
+            qDebug() << "添加文本文件:" << entry.name
+                     << "关键字:" << keyword << "类别:" << meta.category;
         }
     }
     
+    // 与原先按目录名排序遍历的顺序保持一致
+    std::sort(textFiles.begin(), textFiles.end(), [](const FileMeta& a, const FileMeta& b) {
+        return a.path < b.path;
+    });
+    
     qDebug() << "扫描完成，找到" << textFiles.size() << "个文本文件";
     return textFiles;
 }
 
-QString TextFileHandler::mergeTextFiles(const QList<FileMeta>& textFiles) {
+QString TextFileHandler::mergeTextFiles(const ZipArchiveReader& reader, const QList<FileMeta>& textFiles) {
     QString mergedContent;
     
     // 从后向前遍历列表，实现反向合并
     for (int i = textFiles.size() - 1; i >= 0; --i) {
         const FileMeta& fileMeta = textFiles[i];
         
-        // 读取文件内容
-        QFile file(fileMeta.path);
-        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QTextStream in(&file);
-            in.setEncoding(QStringConverter::Utf8);
-            
-            QString content = in.readAll();
-            mergedContent += content;
-            
-            file.close();
+        // 直接从归档解压条目内容
+        const ZipEntryInfo* entry = reader.FindEntry(fileMeta.path);
+        QString error;
+        QByteArray raw = entry ? reader.ReadEntryAll(*entry, &error) : QByteArray();
+        if (entry && error.isEmpty()) {
+            raw.replace("\r\n", "\n");
+            mergedContent += Utf8Codec::Decode(raw);
         } else {
+            qWarning() << "解压条目失败:" << fileMeta.path << error;
             mergedContent += "[ 错误：无法读取文件内容 ]\n";
         }
     }
@@ -617,84 +803,12 @@ QString TextFileHandler::mergeTextFiles(const QList<FileMeta>& textFiles) {
 }
 
 QString TextFileHandler::getFileKeyword(const QString& fileName) {
-    QString lowerFileName = fileName.toLower();
-    
-    // 定义关键字模式
-    struct KeywordPattern {
-        QString keyword;
-        QRegularExpression exactRegex;
-        QRegularExpression numberedRegex;
-    };
-    
-    QList<KeywordPattern> patterns = {
-        {"master", QRegularExpression("^master$"), QRegularExpression("^master\\.\\d+$")},
-        {"chassis", QRegularExpression("^chassis$"), QRegularExpression("^chassis\\..*$")},
-        {"guidance", QRegularExpression("^guidance$"), QRegularExpression("^guidance\\..*$")},
-        {"sc2000a", QRegularExpression("^sc2000a$"), QRegularExpression("^sc2000a\\..*$")},
-        {"vehicle", QRegularExpression("^vehicle$"), QRegularExpression("^vehicle\\..*$")},
-        {"vehicle_navigator", QRegularExpression("^vehicle_navigator$"), QRegularExpression("^vehicle_navigator\\..*$")}
-    };
-    
-    // 检查每个模式
-    for (const auto& pattern : patterns) {
-        if (pattern.exactRegex.match(lowerFileName).hasMatch() ||
-            pattern.numberedRegex.match(lowerFileName).hasMatch()) {
-            return pattern.keyword;
-        }
-    }
-    
-    // 检查扩展名
-    QStringList textExtensions = {
-        "txt", "md", "csv", "json", 
-        "xml", "ini", "cfg", "yml", "yaml",
-        "out", "err", "trace", "debug", "info"
-    };
-    
-    QString extension = QFileInfo(fileName).suffix().toLower();
-    if (!extension.isEmpty() && textExtensions.contains(extension)) {
-        return "extension_" + extension;
-    }
-    
-    // 检查日志关键词
-    QStringList logKeywords = {
-        "trace", "debug", "error", "err", "out", 
-        "audit", "access", "system", "application"
-    };
-    
-    for (const QString& keyword : logKeywords) {
-        if (lowerFileName.contains(keyword)) {
-            return "log_" + keyword;
-        }
-    }
-    
-    return QString(); // 未匹配
+    // 与SqliteTextHandler共用同一份规则表
+    return FileClassifier::Current()->Classify(fileName);
 }
 
 QString TextFileHandler::getFileCategory(const QString& keyword) {
-    if (keyword.startsWith("extension_")) {
-        return "通用文本文件";
-    } else if (keyword.startsWith("log_")) {
-        return "日志文件";
-    } else if (keyword == "master") {
-        return "主控文件";
-    } else if (keyword == "chassis") {
-        return "底盘文件";
-    } else if (keyword == "guidance") {
-        return "引导文件";
-    } else if (keyword == "sc2000a") {
-        return "SC2000A文件";
-    } else if (keyword == "vehicle" || keyword == "vehicle_navigator") {
-        return "车辆文件";
-    }
-    return "其他文件";
-}
-
-void TextFileHandler::cleanupTempFiles() {
-    if (m_tempDir) {
-        qDebug() << "清理临时文件目录:" << m_tempDir->path();
-        m_tempDir.reset();  // 使用智能指针的reset方法
-        qDebug() << "临时文件清理完成";
-    }
+    return FileClassifier::Current()->Category(keyword);
 }
 
 void TextFileHandler::requestFileContent(const QString& filePath) {
@@ -703,6 +817,7 @@ void TextFileHandler::requestFileContent(const QString& filePath) {
     // 检查缓存
     if (auto cachedContent = m_fileCache.object(filePath)) {
         qDebug() << "缓存命中，直接返回内容";
+        m_textLineModel->setContent(*cachedContent);
         emit fileContentReady(*cachedContent, filePath);
         return;
     }
@@ -720,15 +835,18 @@ void TextFileHandler::requestFileContent(const QString& filePath) {
                 return;
             }
             
-            QTextStream in(&file);
-            in.setEncoding(QStringConverter::Utf8);
-            QString content = in.readAll();
+            QByteArray raw = file.readAll();
             file.close();
+            if (raw.startsWith("\xEF\xBB\xBF")) {
+                raw.remove(0, 3);   // 与QTextStream一致，跳过BOM
+            }
+            QString content = Utf8Codec::Decode(raw);
             
             // 在主线程更新缓存和发出信号
             QMetaObject::invokeMethod(this, [this, filePath, content]() {
                 qint64 fileSize = QFileInfo(filePath).size();
                 m_fileCache.insert(filePath, new QString(content), fileSize);
+                m_textLineModel->setContent(content);
                 emit fileContentReady(content, filePath);
             }, Qt::QueuedConnection);
             
@@ -18,6 +18,7 @@
 #include <QFileInfo>
 #include <QCoreApplication>
 #include <QProcess>
+#include "text_matcher.h"
 #include <QRegularExpression>
 #include <QMutex>
 #include <QTimer>
@@ -26,11 +27,18 @@
 #include <QCache>
 #include <QAbstractListModel>
 
+class ZipArchiveReader;
+
 // 搜索结果结构
 struct SearchResult {
     int lineNumber;
     QString preview;
     QString fullLine;
+    // 以下仅数据库搜索填写
+    QString fileName;
+    QString keyword;
+    int archiveId = 0;
+    QString term;      // 命中的搜索词（多词搜索）
 };
 
 // 文件元数据结构
@@ -75,28 +83,127 @@ private:
     QList<FileMeta> m_files;
 };
 
+// 搜索结果列表模型
+// 搜索线程分批发出结果，每批用beginInsertRows追加到末尾，QML列表只为新行创建委托
+class SearchResultModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    
+public:
+    enum Roles {
+        LineNumberRole = Qt::UserRole + 1,
+        PreviewRole,
+        FullLineRole,
+        FileNameRole,
+        KeywordRole,
+        ArchiveIdRole,
+        TermRole
+    };
+    
+    explicit SearchResultModel(QObject* parent = nullptr);
+    
+    // QAbstractListModel 接口
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    
+    // 自定义方法
+    void appendResults(const QList<SearchResult>& results);
+    Q_INVOKABLE void clear();
+    Q_INVOKABLE QVariantMap getResult(int index) const;
+    int count() const { return m_results.size(); }
+    
+signals:
+    void countChanged();
+    
+private:
+    QList<SearchResult> m_results;
+};
+
+// 文本内容行模型
+// 内容只保存一份并记录每行起点，QML列表只为可见行创建委托；
+// 命中区间在委托取数据时才逐行计算（UTF-16下标），高亮由视图在绘制该行时套用，
+// 搜索耗时只与命中数和可见行数有关，不再为整个文件生成HTML
+class TextLineModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        LineNumberRole = Qt::UserRole + 1,
+        TextRole,
+        SpansRole
+    };
+
+    explicit TextLineModel(QObject* parent = nullptr);
+
+    // QAbstractListModel 接口
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // 自定义方法
+    void setContent(const QString& content);
+    // 设置高亮用的匹配器，传nullptr清除高亮；只通知可见委托重新取命中区间
+    void setMatcher(std::shared_ptr<const TextMatcher> matcher);
+    Q_INVOKABLE void clear();
+    Q_INVOKABLE void clearHighlight();
+    int count() const { return m_lineStarts.size(); }
+
+signals:
+    void countChanged();
+
+private:
+    QStringView lineAt(int row) const;
+
+    QString m_content;
+    QList<qsizetype> m_lineStarts;               // 每行起点（UTF-16下标）
+    std::shared_ptr<const TextMatcher> m_matcher;
+    mutable QCache<int, QVariantList> m_spanCache; // 最近取过的行的命中区间
+};
+
 // 多线程搜索工作类
+// 内容按换行对齐切成若干块，由线程池中的线程依次领取并行扫描，结果按块顺序合并；
+// 前面已完成的块累计命中数达到maxResults后，其后的块不再扫描
 class SearchWorker : public QObject {
     Q_OBJECT
 private:
+    // 一个块的扫描结果，行号相对于块首行
+    struct ChunkResult {
+        int lineCount = 0;
+        QList<SearchResult> results;
+    };
+
     QString m_content;
     QString m_searchText;
+    TextMatcher::Options m_options;
     int m_maxResults;
     std::atomic<bool> m_cancelled;
+    std::atomic<int> m_searchId;
     QMutex m_mutex;
+    QThreadPool m_pool;
+
+    static constexpr qsizetype k_chunkChars = 256 * 1024;
+
+    static ChunkResult scanChunk(QStringView chunk, bool isLast, const TextMatcher& matcher, int maxResults);
 
 public:
     explicit SearchWorker(QObject *parent = nullptr);
     ~SearchWorker();
     
-    void setSearchData(const QString &content, const QString &searchText, int maxResults = 100);
+    void setSearchData(const QString &content, const QString &searchText, int maxResults = 100,
+                       const TextMatcher::Options &options = TextMatcher::Options());
     void cancelSearch();
+    // 每次设置搜索数据都会换一个编号，接收方据此丢弃旧搜索晚到的结果
+    int currentSearchId() const { return m_searchId; }
 
 signals:
     void searchProgress(int progress);
-    void searchResultReady(const QList<SearchResult> &results, const QString &highlightedContent);
-    void searchFinished();
-    void searchCancelled();
+    // 搜索过程中按块顺序分批发出结果；高亮由TextLineModel按可见行计算
+    // 结束和取消也带搜索编号，接收方只处理当前搜索的
+    void searchResultsBatch(int searchId, const QList<SearchResult> &batch);
+    void searchFinished(int searchId);
+    void searchCancelled(int searchId);
 
 private slots:
     void performSearch();
@@ -109,14 +216,20 @@ public slots:
 //文件处理流程和对外接口类
 class TextFileHandler : public QObject {
     Q_OBJECT
+    Q_PROPERTY(SearchResultModel* searchResultModel READ searchResultModel CONSTANT)
+    Q_PROPERTY(TextLineModel* textLineModel READ textLineModel CONSTANT)
 
 public:
     explicit TextFileHandler(QObject *parent = nullptr);
     ~TextFileHandler() override;
 
+    SearchResultModel* searchResultModel() const { return m_searchResultModel; }
+    TextLineModel* textLineModel() const { return m_textLineModel; }
+
 public slots:
     Q_INVOKABLE void loadTextFileAsync(const QString &fileName = QString());
-    Q_INVOKABLE void startAsyncSearch(const QString &content, const QString &searchText, int maxResults = 100);
+    Q_INVOKABLE void startAsyncSearch(const QString &content, const QString &searchText, int maxResults = 100,
+                                      const QVariantMap &options = QVariantMap());
     Q_INVOKABLE void cancelSearch();
     Q_INVOKABLE void cancelFileLoading();
     Q_INVOKABLE void requestFileContent(const QString& filePath);
@@ -129,7 +242,7 @@ signals:
     void fileLoaded(const QString &content);
     void loadError(const QString &errorMessage);
     void searchProgress(int progress);
-    void searchResultReady(const QVariantList &results, const QString &highlightedContent);
+    // 结果逐批写入searchResultModel，高亮由textLineModel按可见行计算
     void searchFinished();
     void searchCancelled();
     
@@ -140,13 +253,11 @@ signals:
 private:
     // ZIP文件处理相关方法
     void processZipFile(const QString& zipPath);
-    bool extractZipFile(const QString& zipPath, const QString& extractDir);
-    QList<FileMeta> scanTextFiles(const QString& dirPath);  // 修改返回类型
-    QString mergeTextFiles(const QList<FileMeta>& textFiles);  // 修改参数类型
+    QList<FileMeta> scanTextFiles(const ZipArchiveReader& reader);  // 按中央目录筛选条目
+    QString mergeTextFiles(const ZipArchiveReader& reader, const QList<FileMeta>& textFiles);
     QString getFileKeyword(const QString& fileName);  // 新增：获取文件关键字
     QString getFileCategory(const QString& keyword);  // 新增：获取文件类别
     bool isTextFile(const QString& fileName);
-    void cleanupTempFiles();
     void initializeSearchThread();
     
     void showErrorMessage(const QString &title, const QString &message);
@@ -154,9 +265,6 @@ private:
     // 基本状态
     std::atomic<bool> m_cancelLoading;
     
-    // 临时文件管理 - 使用智能指针
-    std::unique_ptr<QTemporaryDir> m_tempDir;
-    
     // 搜索相关 - 使用智能指针和Qt指针
     std::unique_ptr<QThread> m_searchThread;
     QPointer<SearchWorker> m_searchWorker;
@@ -164,6 +272,8 @@ private:
     // 文件缓存和模型
     QCache<QString, QString> m_fileCache;  // 文件内容缓存
     FileListModel* m_fileListModel;        // 文件列表模型
+    SearchResultModel* m_searchResultModel; // 搜索结果模型
+    TextLineModel* m_textLineModel;         // 文本内容行模型
 };
 
 #endif // TEXTFILEHANDLER_H 
\ No newline at end of file
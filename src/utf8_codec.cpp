@@ -0,0 +1,133 @@
+#include "utf8_codec.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+// UTF8_CODEC_NO_AVX2/UTF8_CODEC_NO_SSE2用于在测试中单独编译较窄的路径
+#if defined(__AVX2__) && !defined(UTF8_CODEC_NO_AVX2)
+#include <immintrin.h>
+#define UTF8_CODEC_AVX2 1
+#endif
+
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && \
+    !defined(UTF8_CODEC_NO_SSE2)
+#include <emmintrin.h>
+#define UTF8_CODEC_SSE2 1
+#endif
+
+namespace {
+
+// 多字节序列首字节对应的后续字节数，非法首字节返回-1
+inline int SequenceExtraBytes(quint8 lead) {
+    if (lead >= 0xC2 && lead <= 0xDF) return 1;
+    if (lead >= 0xE0 && lead <= 0xEF) return 2;
+    if (lead >= 0xF0 && lead <= 0xF4) return 3;
+    return -1;
+}
+
+} // namespace
+
+qint64 Utf8Codec::AsciiPrefixLength(const char* data, qint64 size) {
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    qint64 i = 0;
+
+#ifdef UTF8_CODEC_AVX2
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        quint32 mask = static_cast<quint32>(_mm256_movemask_epi8(chunk));
+        if (mask != 0) {
+            return i + qCountTrailingZeroBits(mask);
+        }
+    }
+#endif
+
+#ifdef UTF8_CODEC_SSE2
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        quint32 mask = static_cast<quint32>(_mm_movemask_epi8(chunk));
+        if (mask != 0) {
+            return i + qCountTrailingZeroBits(mask);
+        }
+    }
+#else
+    for (; i + 8 <= size; i += 8) {
+        quint64 word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if (word & 0x8080808080808080ULL) {
+            break;
+        }
+    }
+#endif
+
+    while (i < size && p[i] < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+bool Utf8Codec::IsValid(const char* data, qint64 size) {
+    const auto* p = reinterpret_cast<const quint8*>(data);
+    const auto* end = p + size;
+
+    while (p < end) {
+        p += AsciiPrefixLength(reinterpret_cast<const char*>(p), end - p);
+        if (p >= end) {
+            break;
+        }
+
+        quint8 c = *p;
+        int extra = SequenceExtraBytes(c);
+        if (extra < 0) {
+            return false;
+        }
+
+        quint8 min_second = 0x80;
+        quint8 max_second = 0xBF;
+        if (c == 0xE0) min_second = 0xA0;
+        if (c == 0xED) max_second = 0x9F;
+        if (c == 0xF0) min_second = 0x90;
+        if (c == 0xF4) max_second = 0x8F;
+
+        if (end - p <= extra || p[1] < min_second || p[1] > max_second) {
+            return false;
+        }
+        for (int i = 2; i <= extra; ++i) {
+            if ((p[i] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        p += extra + 1;
+    }
+    return true;
+}
+
+QByteArray Utf8Codec::Sanitize(const QByteArray& data) {
+    if (IsValid(data)) {
+        return data;
+    }
+    return QString::fromUtf8(data).toUtf8();
+}
+
+QString Utf8Codec::Decode(const char* data, qint64 size) {
+    if (AsciiPrefixLength(data, size) == size) {
+        return QString::fromLatin1(data, size);
+    }
+    return QString::fromUtf8(data, size);
+}
+
+qint64 Utf8Codec::CompleteLength(const char* data, qint64 size) {
+    const auto* p = reinterpret_cast<const quint8*>(data);
+
+    // 从末尾向前最多看3个后续字节，找到首字节后判断序列是否完整
+    for (qint64 i = size - 1; i >= 0 && i >= size - 4; --i) {
+        quint8 c = p[i];
+        if ((c & 0xC0) == 0x80) {
+            continue;
+        }
+        if (c < 0x80) {
+            return size;
+        }
+        int extra = SequenceExtraBytes(c);
+        return (extra >= 0 && size - i <= extra) ? i : size;
+    }
+    return size;
+}
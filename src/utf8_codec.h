@@ -0,0 +1,32 @@
+#ifndef UTF8_CODEC_H
+#define UTF8_CODEC_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+
+// 日志导入/加载用的UTF-8工具
+// ASCII段用SIMD（AVX2/SSE2，无SIMD时按8字节整体判断）批量跳过，只有多字节序列走逐字节校验；
+// 日志几乎全是ASCII，校验和解码的开销基本等于一次内存扫描
+class Utf8Codec {
+public:
+    // data开头连续ASCII字节的长度
+    static qint64 AsciiPrefixLength(const char* data, qint64 size);
+    static bool IsAscii(const QByteArray& data) { return AsciiPrefixLength(data.constData(), data.size()) == data.size(); }
+
+    // 严格校验（拒绝过长编码、代理区和超出U+10FFFF的码点）
+    static bool IsValid(const char* data, qint64 size);
+    static bool IsValid(const QByteArray& data) { return IsValid(data.constData(), data.size()); }
+
+    // 合法数据原样返回；含非法序列时每个非法序列替换为U+FFFD（导入时只做一次）
+    static QByteArray Sanitize(const QByteArray& data);
+
+    // 解码为QString：纯ASCII走Latin-1拓宽，否则按UTF-8解码
+    static QString Decode(const char* data, qint64 size);
+    static QString Decode(const QByteArray& data) { return Decode(data.constData(), data.size()); }
+
+    // 去掉末尾不完整的多字节序列后的长度，用于分块读取时在字符边界处切分
+    static qint64 CompleteLength(const char* data, qint64 size);
+};
+
+#endif // UTF8_CODEC_H
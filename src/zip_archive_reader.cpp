@@ -0,0 +1,453 @@
+#include "zip_archive_reader.h"
+#include "content_hash.h"
+#include <QFile>
+#include <QBuffer>
+#include <QDebug>
+#include <QtEndian>
+#include <zlib.h>
+#include <cstring>
+
+namespace {
+
+// ZIP格式签名
+constexpr quint32 k_local_header_signature = 0x04034b50;
+constexpr quint32 k_central_header_signature = 0x02014b50;
+constexpr quint32 k_eocd_signature = 0x06054b50;
+constexpr quint32 k_zip64_eocd_signature = 0x06064b50;
+constexpr quint32 k_zip64_locator_signature = 0x07064b50;
+
+constexpr int k_local_header_size = 30;
+constexpr int k_central_header_size = 46;
+constexpr int k_eocd_size = 22;
+constexpr int k_zip64_locator_size = 20;
+constexpr int k_zip64_eocd_size = 56;
+constexpr int k_max_comment_size = 0xFFFF;
+
+constexpr quint16 k_method_stored = 0;
+constexpr quint16 k_method_deflate = 8;
+constexpr quint16 k_flag_encrypted = 0x0001;
+constexpr quint16 k_flag_utf8 = 0x0800;
+constexpr quint16 k_zip64_extra_id = 0x0001;
+
+inline quint16 ReadU16(const char* p) {
+    return qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(p));
+}
+
+inline quint32 ReadU32(const char* p) {
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(p));
+}
+
+inline quint64 ReadU64(const char* p) {
+    return qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(p));
+}
+
+void SetError(QString* error, const QString& message) {
+    if (error) {
+        *error = message;
+    }
+}
+
+} // namespace
+
+QString ZipEntryInfo::FileName() const {
+    int slash = name.lastIndexOf('/');
+    return slash >= 0 ? name.mid(slash + 1) : name;
+}
+
+QString ZipEntryInfo::Fingerprint() const {
+    XxHash64 hasher;
+    QByteArray name_bytes = name.toUtf8();
+    hasher.Update(name_bytes);
+    quint64 meta[3] = { crc32, uncompressed_size, compressed_size };
+    hasher.Update(meta, sizeof(meta));
+    return XxHash64::ToHex(hasher.Digest());
+}
+
+ZipArchiveReader::ZipArchiveReader(const QString& zip_path)
+    : m_zip_path_(zip_path), m_in_memory_(false), m_archive_size_(0), m_directory_hash_(0), m_is_open_(false) {
+}
+
+ZipArchiveReader::ZipArchiveReader(const QByteArray& data, const QString& display_name)
+    : m_zip_path_(display_name), m_memory_data_(data), m_in_memory_(true)
+    , m_archive_size_(0), m_directory_hash_(0), m_is_open_(false) {
+}
+
+std::unique_ptr<QIODevice> ZipArchiveReader::OpenDevice(QString* error) const {
+    std::unique_ptr<QIODevice> device;
+    if (m_in_memory_) {
+        auto buffer = std::make_unique<QBuffer>();
+        buffer->setData(m_memory_data_);
+        device = std::move(buffer);
+    } else {
+        device = std::make_unique<QFile>(m_zip_path_);
+    }
+
+    if (!device->open(QIODevice::ReadOnly)) {
+        SetError(error, QString("无法打开ZIP文件：%1").arg(device->errorString()));
+        return nullptr;
+    }
+    return device;
+}
+
+ZipArchiveReader::~ZipArchiveReader() {
+}
+
+bool ZipArchiveReader::Open() {
+    m_is_open_ = false;
+    m_entries_.clear();
+    m_entry_index_.clear();
+    m_error_string_.clear();
+
+    std::unique_ptr<QIODevice> file = OpenDevice(&m_error_string_);
+    if (!file) {
+        return false;
+    }
+    m_archive_size_ = file->size();
+
+    if (!ReadCentralDirectory(*file)) {
+        qWarning() << "读取ZIP中央目录失败:" << m_zip_path_ << m_error_string_;
+        return false;
+    }
+
+    m_is_open_ = true;
+    qDebug() << "ZIP中央目录读取完成:" << m_zip_path_ << "条目数:" << m_entries_.size();
+    return true;
+}
+
+const ZipEntryInfo* ZipArchiveReader::FindEntry(const QString& name) const {
+    auto it = m_entry_index_.constFind(name);
+    if (it == m_entry_index_.constEnd()) {
+        return nullptr;
+    }
+    return &m_entries_[it.value()];
+}
+
+bool ZipArchiveReader::LocateCentralDirectory(QIODevice& file, quint64& cd_offset, quint64& cd_size, quint64& entry_count) {
+    if (m_archive_size_ < k_eocd_size) {
+        m_error_string_ = "文件过小，不是有效的ZIP文件";
+        return false;
+    }
+
+    // EOCD位于文件末尾，其后最多跟随65535字节的注释
+    qint64 tail_size = qMin<qint64>(m_archive_size_, k_eocd_size + k_max_comment_size);
+    qint64 tail_start = m_archive_size_ - tail_size;
+    file.seek(tail_start);
+    QByteArray tail = file.read(tail_size);
+    if (tail.size() != tail_size) {
+        m_error_string_ = "读取ZIP尾部失败";
+        return false;
+    }
+
+    int eocd_pos = -1;
+    for (int i = tail.size() - k_eocd_size; i >= 0; --i) {
+        if (ReadU32(tail.constData() + i) == k_eocd_signature) {
+            eocd_pos = i;
+            break;
+        }
+    }
+    if (eocd_pos < 0) {
+        m_error_string_ = "未找到ZIP中央目录结束记录";
+        return false;
+    }
+
+    const char* eocd = tail.constData() + eocd_pos;
+    entry_count = ReadU16(eocd + 10);
+    cd_size = ReadU32(eocd + 12);
+    cd_offset = ReadU32(eocd + 16);
+
+    bool need_zip64 = entry_count == 0xFFFF || cd_size == 0xFFFFFFFF || cd_offset == 0xFFFFFFFF;
+    qint64 locator_pos = tail_start + eocd_pos - k_zip64_locator_size;
+
+    // zip64定位记录紧邻EOCD之前
+    QByteArray locator;
+    if (eocd_pos >= k_zip64_locator_size) {
+        locator = tail.mid(eocd_pos - k_zip64_locator_size, k_zip64_locator_size);
+    } else if (locator_pos >= 0) {
+        file.seek(locator_pos);
+        locator = file.read(k_zip64_locator_size);
+    }
+
+    if (locator.size() != k_zip64_locator_size || ReadU32(locator.constData()) != k_zip64_locator_signature) {
+        if (need_zip64) {
+            m_error_string_ = "缺少zip64定位记录";
+            return false;
+        }
+        return true;
+    }
+
+    quint64 zip64_eocd_offset = ReadU64(locator.constData() + 8);
+    if (!file.seek(static_cast<qint64>(zip64_eocd_offset))) {
+        m_error_string_ = "zip64结束记录偏移无效";
+        return false;
+    }
+    QByteArray zip64_eocd = file.read(k_zip64_eocd_size);
+    if (zip64_eocd.size() != k_zip64_eocd_size || ReadU32(zip64_eocd.constData()) != k_zip64_eocd_signature) {
+        m_error_string_ = "zip64结束记录损坏";
+        return false;
+    }
+
+    entry_count = ReadU64(zip64_eocd.constData() + 32);
+    cd_size = ReadU64(zip64_eocd.constData() + 40);
+    cd_offset = ReadU64(zip64_eocd.constData() + 48);
+    return true;
+}
+
+bool ZipArchiveReader::ParseZip64ExtraField(const char* extra, int extra_len, ZipEntryInfo& entry,
+                                            bool need_uncompressed, bool need_compressed, bool need_offset) {
+    int pos = 0;
+    while (pos + 4 <= extra_len) {
+        quint16 header_id = ReadU16(extra + pos);
+        quint16 data_size = ReadU16(extra + pos + 2);
+        pos += 4;
+        if (pos + data_size > extra_len) {
+            break;
+        }
+
+        if (header_id == k_zip64_extra_id) {
+            // 只有在中央目录中取值为0xFFFFFFFF的字段才会出现在扩展字段中，且顺序固定
+            const char* data = extra + pos;
+            int offset = 0;
+            if (need_uncompressed) {
+                if (offset + 8 > data_size) return false;
+                entry.uncompressed_size = ReadU64(data + offset);
+                offset += 8;
+            }
+            if (need_compressed) {
+                if (offset + 8 > data_size) return false;
+                entry.compressed_size = ReadU64(data + offset);
+                offset += 8;
+            }
+            if (need_offset) {
+                if (offset + 8 > data_size) return false;
+                entry.local_header_offset = ReadU64(data + offset);
+            }
+            return true;
+        }
+        pos += data_size;
+    }
+    return !(need_uncompressed || need_compressed || need_offset);
+}
+
+bool ZipArchiveReader::ReadCentralDirectory(QIODevice& file) {
+    quint64 cd_offset = 0;
+    quint64 cd_size = 0;
+    quint64 entry_count = 0;
+    if (!LocateCentralDirectory(file, cd_offset, cd_size, entry_count)) {
+        return false;
+    }
+
+    if (cd_offset + cd_size > static_cast<quint64>(m_archive_size_)) {
+        m_error_string_ = "中央目录超出文件范围";
+        return false;
+    }
+
+    // 中央目录只包含元数据，一次性读入
+    file.seek(static_cast<qint64>(cd_offset));
+    QByteArray directory = file.read(static_cast<qint64>(cd_size));
+    if (static_cast<quint64>(directory.size()) != cd_size) {
+        m_error_string_ = "读取中央目录失败";
+        return false;
+    }
+    m_directory_hash_ = XxHash64::Hash(directory, static_cast<quint64>(m_archive_size_));
+
+    m_entries_.reserve(static_cast<int>(qMin<quint64>(entry_count, 1 << 20)));
+    const char* data = directory.constData();
+    qint64 pos = 0;
+    for (quint64 i = 0; i < entry_count; ++i) {
+        if (pos + k_central_header_size > directory.size() || ReadU32(data + pos) != k_central_header_signature) {
+            m_error_string_ = QString("中央目录第%1项损坏").arg(i);
+            return false;
+        }
+
+        const char* header = data + pos;
+        ZipEntryInfo entry;
+        entry.flags = ReadU16(header + 8);
+        entry.compression_method = ReadU16(header + 10);
+        entry.crc32 = ReadU32(header + 16);
+        entry.compressed_size = ReadU32(header + 20);
+        entry.uncompressed_size = ReadU32(header + 24);
+        quint16 name_len = ReadU16(header + 28);
+        quint16 extra_len = ReadU16(header + 30);
+        quint16 comment_len = ReadU16(header + 32);
+        entry.local_header_offset = ReadU32(header + 42);
+
+        qint64 record_size = k_central_header_size + name_len + extra_len + comment_len;
+        if (pos + record_size > directory.size()) {
+            m_error_string_ = QString("中央目录第%1项越界").arg(i);
+            return false;
+        }
+
+        const char* name_ptr = header + k_central_header_size;
+        entry.name = (entry.flags & k_flag_utf8)
+            ? QString::fromUtf8(name_ptr, name_len)
+            : QString::fromLocal8Bit(name_ptr, name_len);
+        entry.name.replace('\\', '/');
+        entry.is_directory = entry.name.endsWith('/');
+
+        bool need_uncompressed = entry.uncompressed_size == 0xFFFFFFFF;
+        bool need_compressed = entry.compressed_size == 0xFFFFFFFF;
+        bool need_offset = entry.local_header_offset == 0xFFFFFFFF;
+        if ((need_uncompressed || need_compressed || need_offset) &&
+            !ParseZip64ExtraField(name_ptr + name_len, extra_len, entry,
+                                  need_uncompressed, need_compressed, need_offset)) {
+            m_error_string_ = QString("条目 %1 的zip64扩展字段损坏").arg(entry.name);
+            return false;
+        }
+
+        m_entry_index_.insert(entry.name, m_entries_.size());
+        m_entries_.append(entry);
+        pos += record_size;
+    }
+
+    return true;
+}
+
+bool ZipArchiveReader::SeekToEntryData(QIODevice& file, const ZipEntryInfo& entry, QString* error) const {
+    if (!file.seek(static_cast<qint64>(entry.local_header_offset))) {
+        SetError(error, QString("条目 %1 偏移无效").arg(entry.name));
+        return false;
+    }
+
+    QByteArray header = file.read(k_local_header_size);
+    if (header.size() != k_local_header_size || ReadU32(header.constData()) != k_local_header_signature) {
+        SetError(error, QString("条目 %1 本地文件头损坏").arg(entry.name));
+        return false;
+    }
+
+    // 本地头中的文件名/扩展字段长度可能与中央目录不同，必须以本地头为准
+    quint16 name_len = ReadU16(header.constData() + 26);
+    quint16 extra_len = ReadU16(header.constData() + 28);
+    qint64 data_offset = static_cast<qint64>(entry.local_header_offset) + k_local_header_size + name_len + extra_len;
+    if (data_offset + static_cast<qint64>(entry.compressed_size) > m_archive_size_ || !file.seek(data_offset)) {
+        SetError(error, QString("条目 %1 数据越界").arg(entry.name));
+        return false;
+    }
+    return true;
+}
+
+bool ZipArchiveReader::ReadStored(QIODevice& file, const ZipEntryInfo& entry, const ChunkHandler& handler,
+                                  quint32& crc, QString* error) const {
+    QByteArray buffer(static_cast<int>(k_read_buffer_size_), Qt::Uninitialized);
+    quint64 remaining = entry.compressed_size;
+    while (remaining > 0) {
+        qint64 to_read = static_cast<qint64>(qMin<quint64>(remaining, k_read_buffer_size_));
+        qint64 n = file.read(buffer.data(), to_read);
+        if (n <= 0) {
+            SetError(error, QString("读取条目 %1 失败").arg(entry.name));
+            return false;
+        }
+        crc = static_cast<quint32>(::crc32(crc, reinterpret_cast<const Bytef*>(buffer.constData()), static_cast<uInt>(n)));
+        if (!handler(buffer.constData(), n)) {
+            SetError(error, "读取已中止");
+            return false;
+        }
+        remaining -= static_cast<quint64>(n);
+    }
+    return true;
+}
+
+bool ZipArchiveReader::ReadDeflated(QIODevice& file, const ZipEntryInfo& entry, const ChunkHandler& handler,
+                                    quint32& crc, QString* error) const {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // 负的windowBits表示原始deflate流（ZIP条目不带zlib头）
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        SetError(error, "初始化解压器失败");
+        return false;
+    }
+
+    QByteArray in_buffer(static_cast<int>(k_read_buffer_size_), Qt::Uninitialized);
+    QByteArray out_buffer(static_cast<int>(k_read_buffer_size_), Qt::Uninitialized);
+    quint64 remaining = entry.compressed_size;
+    int ret = Z_OK;
+    bool ok = true;
+
+    while (ret != Z_STREAM_END) {
+        if (stream.avail_in == 0) {
+            if (remaining == 0) {
+                SetError(error, QString("条目 %1 压缩数据不完整").arg(entry.name));
+                ok = false;
+                break;
+            }
+            qint64 to_read = static_cast<qint64>(qMin<quint64>(remaining, k_read_buffer_size_));
+            qint64 n = file.read(in_buffer.data(), to_read);
+            if (n <= 0) {
+                SetError(error, QString("读取条目 %1 失败").arg(entry.name));
+                ok = false;
+                break;
+            }
+            remaining -= static_cast<quint64>(n);
+            stream.next_in = reinterpret_cast<Bytef*>(in_buffer.data());
+            stream.avail_in = static_cast<uInt>(n);
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*>(out_buffer.data());
+        stream.avail_out = static_cast<uInt>(out_buffer.size());
+        ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            SetError(error, QString("解压条目 %1 失败：%2").arg(entry.name, QString::fromLatin1(stream.msg ? stream.msg : "")));
+            ok = false;
+            break;
+        }
+
+        qint64 produced = out_buffer.size() - static_cast<qint64>(stream.avail_out);
+        if (produced > 0) {
+            crc = static_cast<quint32>(::crc32(crc, reinterpret_cast<const Bytef*>(out_buffer.constData()), static_cast<uInt>(produced)));
+            if (!handler(out_buffer.constData(), produced)) {
+                SetError(error, "读取已中止");
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    inflateEnd(&stream);
+    return ok;
+}
+
+bool ZipArchiveReader::ReadEntry(const ZipEntryInfo& entry, const ChunkHandler& handler, QString* error) const {
+    if (!m_is_open_) {
+        SetError(error, "ZIP文件未打开");
+        return false;
+    }
+    if (entry.is_directory) {
+        return true;
+    }
+    if (entry.flags & k_flag_encrypted) {
+        SetError(error, QString("条目 %1 已加密，不支持").arg(entry.name));
+        return false;
+    }
+    if (entry.compression_method != k_method_stored && entry.compression_method != k_method_deflate) {
+        SetError(error, QString("条目 %1 使用了不支持的压缩方法 %2").arg(entry.name).arg(entry.compression_method));
+        return false;
+    }
+
+    std::unique_ptr<QIODevice> file = OpenDevice(error);
+    if (!file || !SeekToEntryData(*file, entry, error)) {
+        return false;
+    }
+
+    quint32 crc = static_cast<quint32>(::crc32(0L, Z_NULL, 0));
+    bool ok = entry.compression_method == k_method_stored
+        ? ReadStored(*file, entry, handler, crc, error)
+        : ReadDeflated(*file, entry, handler, crc, error);
+    if (!ok) {
+        return false;
+    }
+
+    if (crc != entry.crc32) {
+        SetError(error, QString("条目 %1 CRC校验失败").arg(entry.name));
+        return false;
+    }
+    return true;
+}
+
+QByteArray ZipArchiveReader::ReadEntryAll(const ZipEntryInfo& entry, QString* error) const {
+    QByteArray content;
+    content.reserve(static_cast<qsizetype>(qMin<quint64>(entry.uncompressed_size, 512ull * 1024 * 1024)));
+    bool ok = ReadEntry(entry, [&content](const char* data, qint64 size) {
+        content.append(data, size);
+        return true;
+    }, error);
+    return ok ? content : QByteArray();
+}
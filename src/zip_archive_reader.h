@@ -0,0 +1,93 @@
+#ifndef ZIP_ARCHIVE_READER_H
+#define ZIP_ARCHIVE_READER_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <functional>
+#include <memory>
+
+class QIODevice;
+
+// ZIP条目信息（来自中央目录）
+struct ZipEntryInfo {
+    QString name;                  // 归档内完整路径
+    quint16 compression_method;    // 0: stored, 8: deflate
+    quint16 flags;                 // 通用标志位
+    quint32 crc32;                 // 未压缩数据的CRC32
+    quint64 compressed_size;       // 压缩后大小
+    quint64 uncompressed_size;     // 解压后大小
+    quint64 local_header_offset;   // 本地文件头偏移
+    bool is_directory;             // 是否为目录条目
+
+    ZipEntryInfo()
+        : compression_method(0), flags(0), crc32(0)
+        , compressed_size(0), uncompressed_size(0)
+        , local_header_offset(0), is_directory(false) {}
+
+    // 末级文件名（去掉目录部分）
+    QString FileName() const;
+
+    // 条目指纹：由路径、CRC32与大小计算，无需解压即可判断条目是否变化
+    QString Fingerprint() const;
+};
+
+// 进程内ZIP读取器
+// 直接解析中央目录（支持zip64），按条目流式解压（stored/deflate），
+// 不依赖外部解压工具，也不落地临时文件；嵌套在其他归档中的ZIP可直接从内存读取
+class ZipArchiveReader {
+public:
+    // 数据块回调：返回false表示中止读取
+    using ChunkHandler = std::function<bool(const char* data, qint64 size)>;
+
+    explicit ZipArchiveReader(const QString& zip_path);
+    // 从内存数据读取（嵌套ZIP），display_name仅用于日志和错误信息
+    ZipArchiveReader(const QByteArray& data, const QString& display_name);
+    ~ZipArchiveReader();
+
+    // 打开归档并读取中央目录
+    bool Open();
+    bool IsOpen() const { return m_is_open_; }
+    QString ErrorString() const { return m_error_string_; }
+    QString ArchivePath() const { return m_zip_path_; }
+    qint64 ArchiveSize() const { return m_archive_size_; }
+    // 中央目录原始字节的xxHash64，归档内容变化时必然变化
+    quint64 DirectoryHash() const { return m_directory_hash_; }
+
+    const QList<ZipEntryInfo>& Entries() const { return m_entries_; }
+    const ZipEntryInfo* FindEntry(const QString& name) const;
+
+    // 流式解压单个条目，数据按块回调
+    // 每次调用使用独立的文件句柄，可在多个线程中并发调用
+    bool ReadEntry(const ZipEntryInfo& entry, const ChunkHandler& handler, QString* error = nullptr) const;
+
+    // 读取整个条目到内存（小文件便捷接口）
+    QByteArray ReadEntryAll(const ZipEntryInfo& entry, QString* error = nullptr) const;
+
+private:
+    // 打开一个新的只读设备（文件或内存缓冲），各次读取互不影响
+    std::unique_ptr<QIODevice> OpenDevice(QString* error) const;
+    bool ReadCentralDirectory(QIODevice& file);
+    bool LocateCentralDirectory(QIODevice& file, quint64& cd_offset, quint64& cd_size, quint64& entry_count);
+    bool ParseZip64ExtraField(const char* extra, int extra_len, ZipEntryInfo& entry,
+                              bool need_uncompressed, bool need_compressed, bool need_offset);
+    bool SeekToEntryData(QIODevice& file, const ZipEntryInfo& entry, QString* error) const;
+    bool ReadStored(QIODevice& file, const ZipEntryInfo& entry, const ChunkHandler& handler, quint32& crc, QString* error) const;
+    bool ReadDeflated(QIODevice& file, const ZipEntryInfo& entry, const ChunkHandler& handler, quint32& crc, QString* error) const;
+
+private:
+    QString m_zip_path_;
+    QByteArray m_memory_data_;     // 内存模式下的归档数据（隐式共享，不复制）
+    bool m_in_memory_;
+    QString m_error_string_;
+    qint64 m_archive_size_;
+    quint64 m_directory_hash_;
+    bool m_is_open_;
+    QList<ZipEntryInfo> m_entries_;
+    QHash<QString, int> m_entry_index_;
+
+    static constexpr qint64 k_read_buffer_size_ = 256 * 1024;  // 每次读取/输出的块大小
+};
+
+#endif // ZIP_ARCHIVE_READER_H
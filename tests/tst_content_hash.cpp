@@ -0,0 +1,104 @@
+#include <QTest>
+#include "content_hash.h"
+
+// XxHash64与xxHash参考实现的公开测试向量比较（输入由参考实现的测试用伪随机序列生成），
+// 一次性计算与按不同长度分段Update的结果都必须一致
+class TestContentHash : public QObject {
+    Q_OBJECT
+
+private slots:
+    void ReferenceVectors_data();
+    void ReferenceVectors();
+    void ResetReusesHasher();
+    void ToHexIsZeroPadded();
+};
+
+namespace {
+
+constexpr quint64 k_prime32 = 2654435761ULL;
+
+// 参考实现测试用的输入：byteGen从PRIME32开始，每个字节取最高8位后乘以PRIME64
+QByteArray SanityBuffer(int length) {
+    QByteArray buffer(length, Qt::Uninitialized);
+    quint64 generator = k_prime32;
+    for (int i = 0; i < length; ++i) {
+        buffer[i] = static_cast<char>(generator >> 56);
+        generator *= 11400714785074694797ULL;
+    }
+    return buffer;
+}
+
+} // namespace
+
+void TestContentHash::ReferenceVectors_data() {
+    QTest::addColumn<int>("length");
+    QTest::addColumn<quint64>("seed");
+    QTest::addColumn<quint64>("expected");
+
+    QTest::newRow("empty") << 0 << quint64(0) << quint64(0xEF46DB3751D8E999ULL);
+    QTest::newRow("empty seeded") << 0 << k_prime32 << quint64(0xAC75FDA2929B17EFULL);
+    QTest::newRow("1") << 1 << quint64(0) << quint64(0xE934A84ADB052768ULL);
+    QTest::newRow("1 seeded") << 1 << k_prime32 << quint64(0x5014607643A9B4C3ULL);
+    QTest::newRow("14") << 14 << quint64(0) << quint64(0x8282DCC4994E35C8ULL);
+    QTest::newRow("14 seeded") << 14 << k_prime32 << quint64(0xC3BD6BF63DEB6DF0ULL);
+    // 32字节是四路累加的条带长度，31/33分别落在其两侧
+    QTest::newRow("31") << 31 << quint64(0) << quint64(0x299B39A290E6D783ULL);
+    QTest::newRow("31 seeded") << 31 << k_prime32 << quint64(0xDA673D5FEB5C1D79ULL);
+    QTest::newRow("32") << 32 << quint64(0) << quint64(0x18B216492BB44B70ULL);
+    QTest::newRow("32 seeded") << 32 << k_prime32 << quint64(0xB3F33BDF93ADE409ULL);
+    QTest::newRow("33") << 33 << quint64(0) << quint64(0x55C8DC3E578F5B59ULL);
+    QTest::newRow("33 seeded") << 33 << k_prime32 << quint64(0xE92C292F64BC3071ULL);
+    QTest::newRow("64") << 64 << quint64(0) << quint64(0xEF558F8ACAC2B5CDULL);
+    QTest::newRow("100 seeded") << 100 << quint64(0x0123456789ABCDEFULL) << quint64(0x70F40596D4A2F05BULL);
+    QTest::newRow("222") << 222 << quint64(0) << quint64(0xB641AE8CB691C174ULL);
+    QTest::newRow("222 seeded") << 222 << k_prime32 << quint64(0x20CB8AB7AE10C14AULL);
+}
+
+void TestContentHash::ReferenceVectors() {
+    QFETCH(int, length);
+    QFETCH(quint64, seed);
+    QFETCH(quint64, expected);
+
+    const QByteArray data = SanityBuffer(length);
+    QCOMPARE(XxHash64::Hash(data, seed), expected);
+
+    // 分段长度覆盖逐字节、不足/恰好/超过一个32字节条带，以及缓冲区跨段拼接
+    for (int step : { 1, 7, 31, 32, 33 }) {
+        XxHash64 hasher(seed);
+        for (int offset = 0; offset < data.size(); offset += step) {
+            hasher.Update(data.constData() + offset, qMin(step, static_cast<int>(data.size()) - offset));
+        }
+        QVERIFY2(hasher.Digest() == expected, qPrintable(QString("step=%1").arg(step)));
+        // Digest不改变状态，重复调用结果相同
+        QCOMPARE(hasher.Digest(), expected);
+    }
+
+    // 整段一次Update，以及空段夹在中间
+    XxHash64 hasher(seed);
+    hasher.Update(data.constData(), 0);
+    hasher.Update(data);
+    hasher.Update(data.constData(), 0);
+    QCOMPARE(hasher.Digest(), expected);
+}
+
+void TestContentHash::ResetReusesHasher() {
+    const QByteArray data = SanityBuffer(100);
+    XxHash64 hasher;
+    hasher.Update(SanityBuffer(222));
+    hasher.Reset(0x0123456789ABCDEFULL);
+    hasher.Update(data.left(40));
+    hasher.Update(data.mid(40));
+    QCOMPARE(hasher.Digest(), quint64(0x70F40596D4A2F05BULL));
+
+    QCOMPARE(XxHash64::Hash(QByteArray("abc")), quint64(0x44BC2CF5AD770999ULL));
+}
+
+void TestContentHash::ToHexIsZeroPadded() {
+    // 固定16位小写十六进制，前导零保留
+    QCOMPARE(XxHash64::ToHex(0x44BC2CF5AD770999ULL), QStringLiteral("44bc2cf5ad770999"));
+    QCOMPARE(XxHash64::ToHex(1), QStringLiteral("0000000000000001"));
+    QCOMPARE(XxHash64::ToHex(0), QStringLiteral("0000000000000000"));
+}
+
+QTEST_APPLESS_MAIN(TestContentHash)
+#include "tst_content_hash.moc"
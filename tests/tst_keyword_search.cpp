@@ -0,0 +1,111 @@
+#include <QTest>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include "sqlite_text_handler.h"
+
+// 搜索结果的顺序与行号以关键字合并文本为准：轮转日志按文件名倒序合并（vehicle.2、vehicle.1、vehicle），
+// 与文件插入顺序（文件编号）无关，截断到max_results时保留的是合并文本中最靠前的命中行
+class TestKeywordSearch : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void SearchFollowsMergedOrder_data();
+    void SearchFollowsMergedOrder();
+
+private:
+    QTemporaryDir m_dir_;
+    SqliteDbManager m_manager_;
+    int m_archive_id_ = 0;
+};
+
+namespace {
+
+DbFileRecord MakeFile(const QString& file_name, const QString& keyword, int lines) {
+    DbFileRecord record;
+    record.file_name = file_name;
+    record.file_path = "logs/" + file_name;
+    record.keyword = keyword;
+    record.category = keyword;
+    record.zip_source = "test.zip";
+    record.import_time = QDateTime::currentDateTime();
+    // 每隔几行一条超时记录，行内带文件名和行号，便于核对
+    for (int line = 0; line < lines; ++line) {
+        record.content += line % 3 == 1 ? QString("%1:%2 WARN request timeout\n").arg(file_name).arg(line)
+                                        : QString("%1:%2 INFO ok\n").arg(file_name).arg(line);
+    }
+    record.file_size = record.content.toUtf8().size();
+    record.line_count = lines;
+    return record;
+}
+
+} // namespace
+
+void TestKeywordSearch::initTestCase() {
+    QLoggingCategory::setFilterRules("default.debug=false");
+    QVERIFY(m_dir_.isValid());
+    QVERIFY(m_manager_.InitializeDatabase(m_dir_.filePath("test.db")));
+    m_archive_id_ = m_manager_.CreateArchive("test.zip");
+    QVERIFY(m_archive_id_ > 0);
+    // 插入顺序与合并顺序不同：合并顺序为vehicle.2、vehicle.1、vehicle，文件编号为3、1、2
+    QVERIFY(m_manager_.InsertFiles(m_archive_id_, { MakeFile("vehicle.1", "vehicle", 10),
+                                                    MakeFile("vehicle", "vehicle", 8),
+                                                    MakeFile("vehicle.2", "vehicle", 12),
+                                                    MakeFile("motor.log", "motor", 6) }));
+}
+
+void TestKeywordSearch::SearchFollowsMergedOrder_data() {
+    QTest::addColumn<bool>("all_keywords");
+    QTest::addColumn<int>("max_results");
+    QTest::addColumn<bool>("regex");
+
+    // 普通搜索词优先走行级全文索引，正则搜索逐块扫描，两条路径的顺序应相同
+    QTest::newRow("keyword") << false << 100 << false;
+    QTest::newRow("keyword truncated") << false << 5 << false;
+    QTest::newRow("all keywords") << true << 100 << false;
+    QTest::newRow("all keywords truncated") << true << 7 << false;
+    QTest::newRow("keyword regex") << false << 100 << true;
+    QTest::newRow("keyword regex truncated") << false << 5 << true;
+    QTest::newRow("all keywords regex") << true << 100 << true;
+    QTest::newRow("all keywords regex truncated") << true << 7 << true;
+}
+
+void TestKeywordSearch::SearchFollowsMergedOrder() {
+    QFETCH(bool, all_keywords);
+    QFETCH(int, max_results);
+    QFETCH(bool, regex);
+
+    // 期望结果：按关键字顺序逐个合并文本，依次取出含搜索词的行
+    const QStringList keywords = all_keywords ? QStringList{ "motor", "vehicle" } : QStringList{ "vehicle" };
+    QList<QPair<QString, int>> expected;   // (关键字, 行号)
+    QHash<QString, QStringList> merged_lines;
+    for (const QString& keyword : keywords) {
+        merged_lines[keyword] = m_manager_.GetMergedContentByKeyword(keyword, { m_archive_id_ }).split('\n');
+        const QStringList& lines = merged_lines[keyword];
+        for (int i = 0; i < lines.size(); ++i) {
+            if (lines[i].contains("timeout")) {
+                expected.append({ keyword, i + 1 });
+            }
+        }
+    }
+    QVERIFY(merged_lines["vehicle"].first().startsWith("vehicle.2:0 "));
+    expected = expected.mid(0, max_results);
+
+    TextMatcher::Options options;
+    options.regex = regex;
+    const QStringList terms = { regex ? QStringLiteral("time+out") : QStringLiteral("timeout") };
+    const QList<DbSearchResult> results =
+        all_keywords ? m_manager_.SearchInFiles(terms, max_results, { m_archive_id_ }, options)
+                     : m_manager_.SearchInKeyword("vehicle", terms, max_results, { m_archive_id_ }, options);
+    QCOMPARE(results.size(), expected.size());
+    for (qsizetype i = 0; i < results.size(); ++i) {
+        const DbSearchResult& result = results[i];
+        QCOMPARE(result.keyword, expected[i].first);
+        QCOMPARE(result.line_number, expected[i].second);
+        QCOMPARE(result.line_content, merged_lines[result.keyword][result.line_number - 1]);
+        QVERIFY(result.line_content.startsWith(result.file_name + ':'));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestKeywordSearch)
+#include "tst_keyword_search.moc"
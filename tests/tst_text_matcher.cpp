@@ -0,0 +1,305 @@
+#include <QTest>
+#include <QRandomGenerator>
+#include "text_matcher.h"
+
+#include <algorithm>
+#include <iterator>
+
+// TextMatcher与逐位置比较的参照实现对照：随机文本和搜索词覆盖SIMD块尾、整词重试、
+// 多词自动机的两字节预过滤（含单字节词和大小写变体），另测UTF-16下标换算
+class TestTextMatcher : public QObject {
+    Q_OBJECT
+
+private slots:
+    void LiteralMatchesNaive();
+    void LiteralHitAtBufferTail();
+    void WholeWordRetriesAfterRejectedHit();
+    void MultiPatternMatchesNaive();
+    void MultiPatternPairPrefilter();
+    void MatchingLinesMatchesNaive();
+    void Utf16LengthMatchesQString();
+    void FindAllReportsUtf16Spans();
+};
+
+namespace {
+
+// 文本只用少量字节，随机生成的搜索词才会频繁命中；含非ASCII字节和换行
+const QByteArray k_text_alphabet = QByteArrayLiteral("abAB_1 -\n\xC3\xA9");
+const QByteArray k_needle_alphabet = QByteArrayLiteral("abAB_1-");
+// 块边界附近的长度（SSE2每次比较16个起点），其余长度随机
+const qsizetype k_edge_lengths[] = { 0, 1, 2, 15, 16, 17, 18, 31, 32, 33, 47, 48, 49, 63, 64, 65, 100, 257 };
+
+char FoldAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+bool IsWordChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+QByteArray RandomBytes(QRandomGenerator& rng, const QByteArray& alphabet, qsizetype length) {
+    QByteArray result(length, Qt::Uninitialized);
+    for (char& c : result) {
+        c = alphabet[rng.bounded(static_cast<int>(alphabet.size()))];
+    }
+    return result;
+}
+
+qsizetype RandomTextLength(QRandomGenerator& rng) {
+    if (rng.bounded(2) == 0) {
+        return k_edge_lengths[rng.bounded(static_cast<int>(std::size(k_edge_lengths)))];
+    }
+    return rng.bounded(120);
+}
+
+// 参照实现：按命中的结束位置从前往后找，同一结束位置先试较长的搜索词、再试序号小的，
+// 与TextMatcher::Create(QStringList)的约定一致；单个搜索词时即第一个命中
+TextMatcher::Match NaiveFind(const QByteArray& text, const QList<QByteArray>& needles,
+                             const TextMatcher::Options& options, qsizetype from) {
+    QList<int> order;
+    for (int i = 0; i < needles.size(); ++i) {
+        order.append(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&needles](int a, int b) {
+        return needles[a].size() > needles[b].size();
+    });
+    for (qsizetype end = from + 1; end <= text.size(); ++end) {
+        for (int i : order) {
+            const QByteArray& needle = needles[i];
+            const qsizetype start = end - needle.size();
+            if (start < from) {
+                continue;
+            }
+            bool equal = true;
+            for (qsizetype k = 0; k < needle.size() && equal; ++k) {
+                equal = options.case_sensitive ? text[start + k] == needle[k]
+                                               : FoldAscii(text[start + k]) == FoldAscii(needle[k]);
+            }
+            if (!equal) {
+                continue;
+            }
+            if (options.whole_word &&
+                ((start > 0 && IsWordChar(text[start - 1])) || (end < text.size() && IsWordChar(text[end])))) {
+                continue;
+            }
+            return { start, needle.size(), i };
+        }
+    }
+    return {};
+}
+
+QByteArray Describe(const QByteArray& text, const QList<QByteArray>& needles, const TextMatcher::Options& options,
+                    qsizetype from, const TextMatcher::Match& actual, const TextMatcher::Match& expected) {
+    QByteArray needle_list;
+    for (const QByteArray& needle : needles) {
+        needle_list += '"' + needle + "\" ";
+    }
+    return QByteArray("text(hex)=") + text.toHex() + " needles=" + needle_list +
+           "case_sensitive=" + QByteArray::number(options.case_sensitive) +
+           " whole_word=" + QByteArray::number(options.whole_word) + " from=" + QByteArray::number(from) +
+           " actual=" + QByteArray::number(actual.offset) + "/" + QByteArray::number(actual.length) + "/" +
+           QByteArray::number(actual.pattern) +
+           " expected=" + QByteArray::number(expected.offset) + "/" + QByteArray::number(expected.length) + "/" +
+           QByteArray::number(expected.pattern);
+}
+
+// 从from开始逐个取命中直到末尾，每一步都与参照实现比较；不一致时返回描述
+QByteArray CompareAllHits(const TextMatcher& matcher, const QByteArray& text, const QList<QByteArray>& needles,
+                          const TextMatcher::Options& options, qsizetype from) {
+    for (;;) {
+        const TextMatcher::Match actual = matcher.Find(text, from);
+        const TextMatcher::Match expected = NaiveFind(text, needles, options, from);
+        if (actual.offset != expected.offset ||
+            (expected.offset >= 0 && (actual.length != expected.length || actual.pattern != expected.pattern))) {
+            return Describe(text, needles, options, from, actual, expected);
+        }
+        if (expected.offset < 0) {
+            return QByteArray();
+        }
+        from = expected.offset + 1;
+    }
+}
+
+TextMatcher::Options MakeOptions(bool case_sensitive, bool whole_word) {
+    TextMatcher::Options options;
+    options.case_sensitive = case_sensitive;
+    options.whole_word = whole_word;
+    return options;
+}
+
+QStringList ToPatterns(const QList<QByteArray>& needles) {
+    QStringList patterns;
+    for (const QByteArray& needle : needles) {
+        patterns.append(QString::fromLatin1(needle));
+    }
+    return patterns;
+}
+
+} // namespace
+
+void TestTextMatcher::LiteralMatchesNaive() {
+    QRandomGenerator rng(20240611);
+    for (int round = 0; round < 4000; ++round) {
+        const TextMatcher::Options options = MakeOptions(rng.bounded(2), rng.bounded(2));
+        const QByteArray needle = RandomBytes(rng, k_needle_alphabet, 1 + rng.bounded(5));
+        const QByteArray text = RandomBytes(rng, k_text_alphabet, RandomTextLength(rng));
+        const qsizetype from = text.isEmpty() ? 0 : rng.bounded(static_cast<int>(text.size()));
+        auto matcher = TextMatcher::Create(QString::fromLatin1(needle), options);
+        const QByteArray error = CompareAllHits(*matcher, text, { needle }, options, from);
+        if (!error.isEmpty()) {
+            QFAIL(error.constData());
+        }
+    }
+}
+
+void TestTextMatcher::LiteralHitAtBufferTail() {
+    // 唯一的命中紧贴缓冲区末尾，落在SIMD块之后的逐字节尾部或块内最后一个起点
+    for (qsizetype prefix = 0; prefix <= 80; ++prefix) {
+        for (qsizetype n = 1; n <= 20; ++n) {
+            QByteArray needle(n, 'q');
+            needle[0] = 'Q';
+            const QByteArray text = QByteArray(prefix, '.') + needle;
+            for (bool case_sensitive : { true, false }) {
+                auto matcher = TextMatcher::Create(QString::fromLatin1(needle), MakeOptions(case_sensitive, false));
+                const TextMatcher::Match match = matcher->Find(text);
+                QCOMPARE(match.offset, prefix);
+                QCOMPARE(match.length, n);
+                // 缺最后一个字节时不得越界命中
+                QCOMPARE(matcher->Find(text.constData(), text.size() - 1).offset, qsizetype(-1));
+            }
+        }
+    }
+}
+
+void TestTextMatcher::WholeWordRetriesAfterRejectedHit() {
+    const TextMatcher::Options options = MakeOptions(false, true);
+    auto matcher = TextMatcher::Create(QStringLiteral("ab"), options);
+    // 前面几处命中两侧是单词字符，须跳过后继续找
+    const QByteArray text = QByteArray(40, 'x') + "ab_ab 1ab AB";
+    const TextMatcher::Match match = matcher->Find(text);
+    QCOMPARE(match.offset, text.size() - 2);
+
+    auto multi = TextMatcher::Create(QStringList{ QStringLiteral("ab"), QStringLiteral("-ab") }, options);
+    // 同一位置结束的较长词不满足整词时改用较短的词
+    const QByteArray multi_text = "x-ab";
+    const TextMatcher::Match multi_match = multi->Find(multi_text);
+    QCOMPARE(multi_match.offset, qsizetype(2));
+    QCOMPARE(multi_match.pattern, 0);
+}
+
+void TestTextMatcher::MultiPatternMatchesNaive() {
+    QRandomGenerator rng(20240612);
+    for (int round = 0; round < 4000; ++round) {
+        const TextMatcher::Options options = MakeOptions(rng.bounded(2), rng.bounded(2));
+        QList<QByteArray> needles;
+        const int count = 2 + rng.bounded(4);
+        while (needles.size() < count) {
+            const QByteArray needle = RandomBytes(rng, k_needle_alphabet, 1 + rng.bounded(4));
+            if (!needles.contains(needle)) {
+                needles.append(needle);
+            }
+        }
+        const QByteArray text = RandomBytes(rng, k_text_alphabet, RandomTextLength(rng));
+        const qsizetype from = text.isEmpty() ? 0 : rng.bounded(static_cast<int>(text.size()));
+        auto matcher = TextMatcher::Create(ToPatterns(needles), options);
+        const QByteArray error = CompareAllHits(*matcher, text, needles, options, from);
+        if (!error.isEmpty()) {
+            QFAIL(error.constData());
+        }
+    }
+}
+
+void TestTextMatcher::MultiPatternPairPrefilter() {
+    // 填充字节不可能是任何词的开头，自动机在根状态按两字节跳过；命中放在各个位置，包括最后一个字节
+    const QList<QByteArray> needles = { "Kq", "z", "mno" };
+    for (bool case_sensitive : { true, false }) {
+        const TextMatcher::Options options = MakeOptions(case_sensitive, false);
+        auto matcher = TextMatcher::Create(ToPatterns(needles), options);
+        for (qsizetype prefix = 0; prefix <= 40; ++prefix) {
+            for (const QByteArray& tail : { QByteArray("z"), QByteArray("Z"), QByteArray("kQ"), QByteArray("Kq"),
+                                            QByteArray("mn"), QByteArray("MNO"), QByteArray("k"), QByteArray("zz") }) {
+                const QByteArray text = QByteArray(prefix, '.') + tail;
+                const QByteArray error = CompareAllHits(*matcher, text, needles, options, 0);
+                if (!error.isEmpty()) {
+                    QFAIL(error.constData());
+                }
+            }
+        }
+    }
+
+    // 单字节词之后紧跟任意字节都要能命中
+    auto single = TextMatcher::Create(QStringList{ QStringLiteral("x"), QStringLiteral("yy") }, MakeOptions(true, false));
+    for (int second = 0; second < 256; ++second) {
+        const QByteArray text = QByteArray("..x") + static_cast<char>(second);
+        QCOMPARE(single->Find(text).offset, qsizetype(2));
+    }
+}
+
+void TestTextMatcher::MatchingLinesMatchesNaive() {
+    QRandomGenerator rng(20240613);
+    for (int round = 0; round < 1000; ++round) {
+        const TextMatcher::Options options = MakeOptions(rng.bounded(2), rng.bounded(2));
+        QList<QByteArray> needles;
+        const int count = 1 + rng.bounded(3);
+        while (needles.size() < count) {
+            const QByteArray needle = RandomBytes(rng, k_needle_alphabet, 1 + rng.bounded(3));
+            if (!needles.contains(needle)) {
+                needles.append(needle);
+            }
+        }
+        const QByteArray text = RandomBytes(rng, k_text_alphabet, rng.bounded(300));
+        auto matcher = TextMatcher::Create(ToPatterns(needles), options);
+
+        QList<qsizetype> expected;
+        const QList<QByteArray> lines = text.split('\n');
+        for (qsizetype i = 0; i < lines.size(); ++i) {
+            if (NaiveFind(lines[i], needles, options, 0).offset >= 0) {
+                expected.append(i);
+            }
+        }
+        QCOMPARE(matcher->MatchingLines(text.constData(), text.size()), expected);
+        QCOMPARE(matcher->MatchingLines(text.constData(), text.size(), 2), expected.mid(0, 2));
+    }
+}
+
+void TestTextMatcher::Utf16LengthMatchesQString() {
+    // 1到4字节的UTF-8序列，4字节序列在UTF-16中是代理对
+    const QString pieces[] = { QStringLiteral("a"), QString(QChar(0x00E9)), QString(QChar(0x4E2D)),
+                               QString::fromUcs4(U"\U0001F600", 1) };
+    QRandomGenerator rng(20240614);
+    for (int round = 0; round < 500; ++round) {
+        QString text;
+        QList<qsizetype> boundaries = { 0 };
+        const int count = rng.bounded(40);
+        for (int i = 0; i < count; ++i) {
+            text += pieces[rng.bounded(4)];
+            boundaries.append(text.toUtf8().size());
+        }
+        const QByteArray utf8 = text.toUtf8();
+        QCOMPARE(TextMatcher::Utf16Length(utf8.constData(), utf8.size()), text.size());
+        for (qsizetype boundary : boundaries) {
+            const QByteArray prefix = utf8.left(boundary);
+            QCOMPARE(TextMatcher::Utf16Length(prefix.constData(), prefix.size()), QString::fromUtf8(prefix).size());
+        }
+    }
+}
+
+void TestTextMatcher::FindAllReportsUtf16Spans() {
+    const QString line = QString::fromUtf8("\xE4\xB8\xAD" "ab\xF0\x9F\x98\x80" "AB" "\xC3\xA9" "x ab");
+    auto matcher = TextMatcher::Create(QStringLiteral("ab"));
+    const QList<TextMatcher::Span> spans = matcher->FindAll(line);
+    // 与QString::indexOf给出的UTF-16下标一致
+    QList<qsizetype> expected;
+    for (qsizetype pos = line.indexOf(QStringLiteral("ab"), 0, Qt::CaseInsensitive); pos >= 0;
+         pos = line.indexOf(QStringLiteral("ab"), pos + 2, Qt::CaseInsensitive)) {
+        expected.append(pos);
+    }
+    QCOMPARE(spans.size(), expected.size());
+    for (qsizetype i = 0; i < spans.size(); ++i) {
+        QCOMPARE(spans[i].start, expected[i]);
+        QCOMPARE(spans[i].length, qsizetype(2));
+    }
+}
+
+QTEST_APPLESS_MAIN(TestTextMatcher)
+#include "tst_text_matcher.moc"
@@ -0,0 +1,276 @@
+#include <QTest>
+#include <QRandomGenerator>
+#include "utf8_codec.h"
+
+#include <iterator>
+
+// Utf8Codec测试，同一份源文件随utf8_codec.cpp的三种编译方式各构建一次（见tests/CMakeLists.txt）：
+// AVX2、默认（x86-64上为SSE2）和标量，ASCII快速路径的块边界与尾部都与逐字节参照比较
+class TestUtf8Codec : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void AsciiPrefixLengthMatchesNaive();
+    void IsValidEdgeCases_data();
+    void IsValidEdgeCases();
+    void IsValidMatchesReference();
+    void SanitizeAndDecode();
+    void CompleteLength_data();
+    void CompleteLength();
+    void CompleteLengthCutsAtCharBoundary();
+};
+
+namespace {
+
+qint64 NaiveAsciiPrefix(const char* data, qint64 size) {
+    qint64 i = 0;
+    while (i < size && static_cast<unsigned char>(data[i]) < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+// 参照校验：逐个序列解出码点，再按Unicode规则判断
+bool ReferenceIsValid(const QByteArray& data) {
+    const auto* p = reinterpret_cast<const unsigned char*>(data.constData());
+    const qsizetype size = data.size();
+    for (qsizetype i = 0; i < size;) {
+        const unsigned char lead = p[i];
+        int extra;
+        char32_t code_point;
+        char32_t min_code_point;
+        if (lead < 0x80) {
+            ++i;
+            continue;
+        } else if ((lead & 0xE0) == 0xC0) {
+            extra = 1;
+            code_point = lead & 0x1F;
+            min_code_point = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            extra = 2;
+            code_point = lead & 0x0F;
+            min_code_point = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            extra = 3;
+            code_point = lead & 0x07;
+            min_code_point = 0x10000;
+        } else {
+            return false;
+        }
+        if (i + extra >= size) {
+            return false;
+        }
+        for (int k = 1; k <= extra; ++k) {
+            if ((p[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+            code_point = (code_point << 6) | (p[i + k] & 0x3F);
+        }
+        if (code_point < min_code_point || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+            return false;
+        }
+        i += extra + 1;
+    }
+    return true;
+}
+
+// 随机UTF-8文本：1到4字节的字符混合
+QByteArray RandomUtf8(QRandomGenerator& rng, int chars, QList<qsizetype>* boundaries = nullptr) {
+    static const char32_t k_code_points[] = { U'a', U'\n', 0x7F, 0x80, 0xE9, 0x7FF, 0x800, 0x4E2D, 0xD7FF,
+                                              0xE000, 0xFFFD, 0xFFFF, 0x10000, 0x1F600, 0x10FFFF };
+    QByteArray result;
+    if (boundaries) {
+        boundaries->append(0);
+    }
+    for (int i = 0; i < chars; ++i) {
+        const char32_t code_point = k_code_points[rng.bounded(static_cast<int>(std::size(k_code_points)))];
+        result += QString::fromUcs4(&code_point, 1).toUtf8();
+        if (boundaries) {
+            boundaries->append(result.size());
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+void TestUtf8Codec::initTestCase() {
+#ifdef UTF8_CODEC_TEST_REQUIRES_AVX2
+#if defined(__GNUC__)
+    // utf8_codec.cpp以-mavx2编译，测试本身不用AVX2指令，不支持时在调用前跳过
+    if (!__builtin_cpu_supports("avx2")) {
+        QSKIP("CPU不支持AVX2");
+    }
+#endif
+#endif
+}
+
+void TestUtf8Codec::AsciiPrefixLengthMatchesNaive() {
+    // 不同对齐、长度和第一个非ASCII字节的位置，覆盖32/16/8字节块及其后的逐字节尾部
+    QByteArray data(256, 'a');
+    for (int i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(0x20 + i % 0x60);    // 含0x7F
+    }
+    for (qint64 offset = 0; offset < 33; ++offset) {
+        for (qint64 size = 0; size <= 130; ++size) {
+            for (qint64 position = -1; position < size; ++position) {
+                for (char high : { '\x80', '\xFF' }) {
+                    const char saved = position >= 0 ? data[offset + position] : 0;
+                    if (position >= 0) {
+                        data[offset + position] = high;
+                    }
+                    const char* p = data.constData() + offset;
+                    const qint64 expected = NaiveAsciiPrefix(p, size);
+                    const qint64 actual = Utf8Codec::AsciiPrefixLength(p, size);
+                    if (position >= 0) {
+                        data[offset + position] = saved;
+                    }
+                    if (actual != expected) {
+                        QFAIL(qPrintable(QString("offset=%1 size=%2 position=%3: %4 != %5")
+                                             .arg(offset).arg(size).arg(position).arg(actual).arg(expected)));
+                    }
+                }
+            }
+        }
+    }
+    QVERIFY(Utf8Codec::IsAscii(QByteArray(100, 'x')));
+    QVERIFY(!Utf8Codec::IsAscii(QByteArray(100, 'x') + "\xC3\xA9"));
+}
+
+void TestUtf8Codec::IsValidEdgeCases_data() {
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<bool>("valid");
+
+    QTest::newRow("empty") << QByteArray() << true;
+    QTest::newRow("ascii") << QByteArray("plain log line\n") << true;
+    QTest::newRow("U+0080") << QByteArray("\xC2\x80") << true;
+    QTest::newRow("U+07FF") << QByteArray("\xDF\xBF") << true;
+    QTest::newRow("U+0800") << QByteArray("\xE0\xA0\x80") << true;
+    QTest::newRow("U+D7FF") << QByteArray("\xED\x9F\xBF") << true;
+    QTest::newRow("U+E000") << QByteArray("\xEE\x80\x80") << true;
+    QTest::newRow("U+FFFF") << QByteArray("\xEF\xBF\xBF") << true;
+    QTest::newRow("U+10000") << QByteArray("\xF0\x90\x80\x80") << true;
+    QTest::newRow("U+10FFFF") << QByteArray("\xF4\x8F\xBF\xBF") << true;
+
+    // 过长编码
+    QTest::newRow("overlong C0") << QByteArray("\xC0\x80") << false;
+    QTest::newRow("overlong C1") << QByteArray("\xC1\xBF") << false;
+    QTest::newRow("overlong E0 80") << QByteArray("\xE0\x80\x80") << false;
+    QTest::newRow("overlong E0 9F") << QByteArray("\xE0\x9F\xBF") << false;
+    QTest::newRow("overlong F0 80") << QByteArray("\xF0\x80\x80\x80") << false;
+    QTest::newRow("overlong F0 8F") << QByteArray("\xF0\x8F\xBF\xBF") << false;
+    // 代理区
+    QTest::newRow("surrogate D800") << QByteArray("\xED\xA0\x80") << false;
+    QTest::newRow("surrogate DFFF") << QByteArray("\xED\xBF\xBF") << false;
+    // 超出U+10FFFF
+    QTest::newRow("U+110000") << QByteArray("\xF4\x90\x80\x80") << false;
+    QTest::newRow("lead F5") << QByteArray("\xF5\x80\x80\x80") << false;
+    QTest::newRow("lead FF") << QByteArray("\xFF") << false;
+    // 缺少或多出后续字节
+    QTest::newRow("lone continuation") << QByteArray("\x80") << false;
+    QTest::newRow("truncated 2") << QByteArray("\xC3") << false;
+    QTest::newRow("truncated 3") << QByteArray("\xE4\xB8") << false;
+    QTest::newRow("truncated 4") << QByteArray("\xF0\x9F\x98") << false;
+    QTest::newRow("bad continuation 3") << QByteArray("\xE4\x41\xAD") << false;
+    QTest::newRow("bad continuation 4") << QByteArray("\xF0\x9F\x41\x80") << false;
+    QTest::newRow("two leads") << QByteArray("\xC3\xC3") << false;
+}
+
+void TestUtf8Codec::IsValidEdgeCases() {
+    QFETCH(QByteArray, data);
+    QFETCH(bool, valid);
+
+    QCOMPARE(Utf8Codec::IsValid(data), valid);
+    QCOMPARE(ReferenceIsValid(data), valid);
+    // 前面放一段超过一个SIMD块的ASCII，使序列出现在快速路径之后；截断的序列仍在末尾
+    const QByteArray prefix(37, 'a');
+    QCOMPARE(Utf8Codec::IsValid(prefix + data), valid);
+    if (valid) {
+        QCOMPARE(Utf8Codec::IsValid(prefix + data + QByteArray(40, 'b')), true);
+    }
+}
+
+void TestUtf8Codec::IsValidMatchesReference() {
+    // 随机字节偏向各类边界字节，与参照校验逐一比较
+    static const unsigned char k_bytes[] = { 'a', ' ', 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xC1,
+                                             0xC2, 0xDF, 0xE0, 0xED, 0xEF, 0xF0, 0xF4, 0xF5, 0xFF };
+    QRandomGenerator rng(20240615);
+    for (int round = 0; round < 50000; ++round) {
+        QByteArray data = RandomUtf8(rng, rng.bounded(6));
+        const int noise = rng.bounded(4);
+        for (int i = 0; i < noise; ++i) {
+            const unsigned char byte = k_bytes[rng.bounded(static_cast<int>(std::size(k_bytes)))];
+            data.insert(rng.bounded(static_cast<int>(data.size()) + 1), static_cast<char>(byte));
+        }
+        if (rng.bounded(2)) {
+            data.prepend(QByteArray(rng.bounded(70), 'x'));
+        }
+        if (Utf8Codec::IsValid(data) != ReferenceIsValid(data)) {
+            QFAIL(qPrintable("data(hex)=" + QString::fromLatin1(data.toHex())));
+        }
+    }
+}
+
+void TestUtf8Codec::SanitizeAndDecode() {
+    QRandomGenerator rng(20240616);
+    for (int round = 0; round < 2000; ++round) {
+        const QByteArray valid = QByteArray(rng.bounded(40), 'x') + RandomUtf8(rng, rng.bounded(20));
+        QCOMPARE(Utf8Codec::Sanitize(valid), valid);
+        QCOMPARE(Utf8Codec::Decode(valid), QString::fromUtf8(valid));
+
+        QByteArray invalid = valid;
+        invalid.insert(rng.bounded(static_cast<int>(invalid.size()) + 1), '\xFF');
+        const QByteArray sanitized = Utf8Codec::Sanitize(invalid);
+        QVERIFY(Utf8Codec::IsValid(sanitized));
+        QCOMPARE(sanitized, QString::fromUtf8(invalid).toUtf8());
+    }
+    // 纯ASCII走Latin-1拓宽
+    QCOMPARE(Utf8Codec::Decode(QByteArray("ascii only")), QStringLiteral("ascii only"));
+}
+
+void TestUtf8Codec::CompleteLength_data() {
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<qint64>("expected");
+
+    QTest::newRow("empty") << QByteArray() << qint64(0);
+    QTest::newRow("ascii") << QByteArray("abc") << qint64(3);
+    QTest::newRow("complete 2") << QByteArray("ab\xC3\xA9") << qint64(4);
+    QTest::newRow("truncated 2") << QByteArray("ab\xC3") << qint64(2);
+    QTest::newRow("complete 3") << QByteArray("\xE4\xB8\xAD") << qint64(3);
+    QTest::newRow("truncated 3 of 1") << QByteArray("a\xE4") << qint64(1);
+    QTest::newRow("truncated 3 of 2") << QByteArray("a\xE4\xB8") << qint64(1);
+    QTest::newRow("complete 4") << QByteArray("\xF0\x9F\x98\x80") << qint64(4);
+    QTest::newRow("truncated 4 of 3") << QByteArray("\xF0\x9F\x98") << qint64(0);
+    QTest::newRow("truncated 4 of 1") << QByteArray("xy\xF0") << qint64(2);
+    // 非法数据不截断，交给校验处理
+    QTest::newRow("invalid lead") << QByteArray("a\xFF") << qint64(2);
+    QTest::newRow("continuations only") << QByteArray("\x80\x80\x80\x80") << qint64(4);
+    QTest::newRow("extra continuation") << QByteArray("\xC3\xA9\xA9") << qint64(3);
+}
+
+void TestUtf8Codec::CompleteLength() {
+    QFETCH(QByteArray, data);
+    QFETCH(qint64, expected);
+
+    QCOMPARE(Utf8Codec::CompleteLength(data.constData(), data.size()), expected);
+}
+
+void TestUtf8Codec::CompleteLengthCutsAtCharBoundary() {
+    // 合法文本在任意位置切开，结果都是不超过切点的最后一个字符边界
+    QRandomGenerator rng(20240617);
+    for (int round = 0; round < 500; ++round) {
+        QList<qsizetype> boundaries;
+        const QByteArray data = RandomUtf8(rng, rng.bounded(30), &boundaries);
+        qsizetype boundary = 0;
+        for (qsizetype cut = 0; cut <= data.size(); ++cut) {
+            if (boundaries.contains(cut)) {
+                boundary = cut;
+            }
+            QCOMPARE(Utf8Codec::CompleteLength(data.constData(), cut), qint64(boundary));
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestUtf8Codec)
+#include "tst_utf8_codec.moc"